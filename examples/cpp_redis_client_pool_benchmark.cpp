@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/cpp_redis>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! Measure how throughput scales with the number of connections of a client_pool against a local redis-server
+//! A few slow commands (DEBUG SLEEP) can be mixed in to show how least_inflight routing avoids head-of-line blocking
+//!
+//! usage: cpp_redis_client_pool_benchmark [max_connections] [nb_ops] [pipeline_depth] [slow_every]
+//!
+
+static void
+run_benchmark(std::size_t nb_connections, cpp_redis::client_pool::routing_policy policy, std::size_t nb_ops, std::size_t pipeline_depth, std::size_t slow_every) {
+  cpp_redis::client_pool pool(nb_connections, policy);
+  pool.connect("127.0.0.1", 6379);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t sent = 0; sent < nb_ops;) {
+    for (std::size_t i = 0; i < pipeline_depth && sent < nb_ops; ++i, ++sent) {
+      if (slow_every && sent % slow_every == 0) {
+        pool.send({"DEBUG", "SLEEP", "0.001"}, nullptr);
+      }
+      else {
+        pool.send({"GET", "cpp_redis_client_pool_benchmark"}, nullptr);
+      }
+    }
+
+    pool.sync_commit();
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << nb_connections << " connection(s), "
+            << (policy == cpp_redis::client_pool::routing_policy::round_robin ? "round_robin   " : "least_inflight") << ": "
+            << (elapsed ? nb_ops * 1000000 / elapsed : 0) << " ops/s" << std::endl;
+
+  pool.disconnect(true);
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t max_connections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+  std::size_t nb_ops          = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500000;
+  std::size_t pipeline_depth  = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+  std::size_t slow_every      = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+
+  //! use one io worker per connection so that connections are actually processed in parallel
+  cpp_redis::network::set_default_nb_workers(max_connections);
+
+  for (std::size_t nb_connections = 1; nb_connections <= max_connections; nb_connections *= 2) {
+    run_benchmark(nb_connections, cpp_redis::client_pool::routing_policy::round_robin, nb_ops, pipeline_depth, slow_every);
+    run_benchmark(nb_connections, cpp_redis::client_pool::routing_policy::least_inflight, nb_ops, pipeline_depth, slow_every);
+  }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
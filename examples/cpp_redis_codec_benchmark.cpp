@@ -0,0 +1,151 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/cpp_redis>
+#include <cpp_redis/misc/lz4_codec.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! Measure the compression ratio and throughput of the LZ4 codec on JSON payloads of several sizes
+//! then, if a redis server is running on 127.0.0.1:6379, the SET / GET throughput of these payloads with and without compression
+//!
+//! usage: cpp_redis_codec_benchmark [nb_iterations]
+//!
+
+static std::string
+make_json(std::size_t size) {
+  std::string json = "[";
+
+  for (std::size_t i = 0; json.size() < size; ++i) {
+    json += "{\"id\":" + std::to_string(i) + ",\"name\":\"user" + std::to_string(i * 7919 % 10007) + "\",\"email\":\"user" + std::to_string(i) + "@example.com\",\"score\":" + std::to_string(i * 31 % 1000) + ",\"active\":" + (i % 3 ? "true" : "false") + "},";
+  }
+
+  json.back() = ']';
+
+  return json;
+}
+
+static double
+megabytes_per_second(std::size_t bytes, std::chrono::steady_clock::duration elapsed) {
+  return static_cast<double>(bytes) / 1e6 / std::chrono::duration<double>(elapsed).count();
+}
+
+static void
+run_codec_benchmark(const std::string& value, std::size_t nb_iterations) {
+  cpp_redis::lz4_codec codec;
+  std::string compressed;
+  std::string decompressed;
+
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < nb_iterations; ++i) {
+    codec.compress(value, compressed);
+  }
+  auto compression_time = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < nb_iterations; ++i) {
+    codec.decompress(compressed.data(), compressed.size(), decompressed);
+  }
+  auto decompression_time = std::chrono::steady_clock::now() - start;
+
+  std::cout << value.size() / 1000 << " KB: ratio " << static_cast<double>(value.size()) / static_cast<double>(compressed.size())
+            << ", compression " << megabytes_per_second(value.size() * nb_iterations, compression_time)
+            << " MB/s, decompression " << megabytes_per_second(value.size() * nb_iterations, decompression_time) << " MB/s" << std::endl;
+}
+
+static void
+run_client_benchmark(const std::string& value, std::size_t nb_iterations, bool compress) {
+  cpp_redis::client client;
+
+  if (compress) {
+    client.set_codec(std::make_shared<cpp_redis::lz4_codec>());
+  }
+
+  client.connect();
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < nb_iterations; ++i) {
+    client.set("cpp_redis_codec_benchmark:" + std::to_string(i % 100), value);
+  }
+  client.sync_commit();
+
+  auto set_time = std::chrono::steady_clock::now() - start;
+  start         = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < nb_iterations; ++i) {
+    client.get("cpp_redis_codec_benchmark:" + std::to_string(i % 100), nullptr);
+  }
+  client.sync_commit();
+
+  auto get_time = std::chrono::steady_clock::now() - start;
+
+  std::cout << value.size() / 1000 << " KB " << (compress ? "lz4 " : "raw ")
+            << ": SET " << megabytes_per_second(value.size() * nb_iterations, set_time)
+            << " MB/s, GET " << megabytes_per_second(value.size() * nb_iterations, get_time) << " MB/s" << std::endl;
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  std::size_t sizes[]       = {50000, 200000, 500000};
+
+  for (std::size_t size : sizes) {
+    run_codec_benchmark(make_json(size), nb_iterations);
+  }
+
+  try {
+    for (std::size_t size : sizes) {
+      run_client_benchmark(make_json(size), nb_iterations, false);
+      run_client_benchmark(make_json(size), nb_iterations, true);
+    }
+  }
+  catch (const cpp_redis::redis_error& e) {
+    std::cout << "client benchmark skipped: " << e.what() << std::endl;
+  }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/cpp_redis>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! Measure the latency of interactive GETs while a background thread saturates the link with large SET pipelines
+//! Run once with all the commands on the same connection, and once with a priority_client giving each class its own connection
+//!
+//! usage: cpp_redis_priority_client_benchmark [nb_gets] [bulk_value_size] [bulk_pipeline_depth]
+//!
+
+static void
+print_latencies(const std::string& name, std::vector<long long>& latencies) {
+  std::sort(latencies.begin(), latencies.end());
+
+  std::cout << name << ": p50 " << latencies[latencies.size() / 2]
+            << " us, p99 " << latencies[latencies.size() * 99 / 100]
+            << " us, max " << latencies.back() << " us" << std::endl;
+}
+
+static void
+run_benchmark(bool use_lanes, std::size_t nb_gets, std::size_t value_size, std::size_t pipeline_depth) {
+  cpp_redis::priority_client client;
+  client.connect("127.0.0.1", 6379);
+
+  auto interactive = use_lanes ? cpp_redis::priority_client::priority::interactive : cpp_redis::priority_client::priority::normal;
+  auto bulk        = use_lanes ? cpp_redis::priority_client::priority::bulk : cpp_redis::priority_client::priority::normal;
+
+  std::atomic_bool stop(false);
+  std::string value(value_size, 'x');
+
+  std::thread bulk_loader([&] {
+    std::size_t key = 0;
+
+    while (!stop) {
+      for (std::size_t i = 0; i < pipeline_depth; ++i) {
+        client.get_client(bulk).set("cpp_redis_bulk:" + std::to_string(key++ % 10000), value);
+      }
+
+      client.get_client(bulk).sync_commit();
+    }
+  });
+
+  //! let the bulk traffic ramp up
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  std::vector<long long> latencies;
+
+  for (std::size_t i = 0; i < nb_gets; ++i) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto get = client.send({"GET", "cpp_redis_interactive"}, interactive);
+    client.get_client(interactive).commit();
+    get.wait();
+
+    latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  stop = true;
+  bulk_loader.join();
+
+  print_latencies(use_lanes ? "priority lanes " : "single pipeline", latencies);
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_gets        = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  std::size_t value_size     = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16384;
+  std::size_t pipeline_depth = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+
+  run_benchmark(false, nb_gets, value_size, pipeline_depth);
+  run_benchmark(true, nb_gets, value_size, pipeline_depth);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
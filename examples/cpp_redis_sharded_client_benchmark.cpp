@@ -0,0 +1,172 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/cpp_redis>
+#include <cpp_redis/misc/hash_ring.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! Measure the key distribution, the lookup cost and the fraction of keys remapped when a node joins a consistent hash ring
+//! If redis-server ports are given, also measure the pipelined SET throughput of a sharded_client over these local nodes
+//!
+//! usage: cpp_redis_sharded_client_benchmark [nb_nodes] [nb_virtual_nodes] [nb_keys] [port...]
+//!
+
+static std::string
+node_name(std::size_t i) {
+  return "10.0.0." + std::to_string(i) + ":6379";
+}
+
+static void
+ring_benchmark(std::size_t nb_nodes, std::size_t nb_virtual_nodes, std::size_t nb_keys) {
+  cpp_redis::hash_ring ring(nb_virtual_nodes);
+
+  for (std::size_t i = 0; i < nb_nodes; ++i) {
+    ring.add_node(node_name(i));
+  }
+
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i < nb_keys; ++i) {
+    keys.push_back("user:" + std::to_string(i));
+  }
+
+  //! distribution
+  std::map<std::string, std::size_t> counts;
+  std::vector<std::size_t> owners;
+
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& key : keys) {
+    owners.push_back(ring.get_node_index(key));
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+  for (auto owner : owners) {
+    ++counts[ring.get_nodes()[owner]];
+  }
+
+  double mean     = static_cast<double>(nb_keys) / nb_nodes;
+  double variance = 0;
+  std::size_t min = nb_keys;
+  std::size_t max = 0;
+
+  for (const auto& count : counts) {
+    variance += (count.second - mean) * (count.second - mean);
+    min = std::min(min, count.second);
+    max = std::max(max, count.second);
+  }
+
+  std::cout << nb_nodes << " nodes, " << nb_virtual_nodes << " virtual nodes each, " << nb_keys << " keys" << std::endl;
+  std::cout << "  keys per node: min " << min << ", max " << max << ", stddev " << 100 * std::sqrt(variance / nb_nodes) / mean << "% of the mean" << std::endl;
+  std::cout << "  lookup: " << (nb_keys ? elapsed / static_cast<long long>(nb_keys) : 0) << " ns/op" << std::endl;
+
+  //! remapping on node addition
+  std::vector<std::string> before;
+  for (auto owner : owners) {
+    before.push_back(ring.get_nodes()[owner]);
+  }
+
+  ring.add_node(node_name(nb_nodes));
+
+  std::size_t moved = 0;
+  for (std::size_t i = 0; i < nb_keys; ++i) {
+    if (ring.get_node(keys[i]) != before[i]) {
+      ++moved;
+    }
+  }
+
+  std::cout << "  adding a node remaps " << 100.0 * moved / nb_keys << "% of the keys (ideal " << 100.0 / (nb_nodes + 1) << "%)" << std::endl;
+}
+
+static void
+client_benchmark(const std::vector<std::size_t>& ports, std::size_t nb_keys) {
+  cpp_redis::sharded_client client;
+
+  for (auto port : ports) {
+    client.add_node("127.0.0.1", port);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < nb_keys; ++i) {
+    client.send({"SET", "user:" + std::to_string(i), "value"}, nullptr);
+
+    if (i % 1000 == 999) {
+      client.sync_commit();
+    }
+  }
+
+  client.sync_commit();
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  std::cout << ports.size() << " local node(s): " << (elapsed ? nb_keys * 1000000 / elapsed : 0) << " SET/s" << std::endl;
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_nodes         = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+  std::size_t nb_virtual_nodes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 160;
+  std::size_t nb_keys          = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000000;
+
+  std::vector<std::size_t> ports;
+  for (int i = 4; i < argc; ++i) {
+    ports.push_back(std::strtoul(argv[i], nullptr, 10));
+  }
+
+  for (std::size_t virtual_nodes = 10; virtual_nodes < nb_virtual_nodes; virtual_nodes *= 4) {
+    ring_benchmark(nb_nodes, virtual_nodes, nb_keys);
+  }
+  ring_benchmark(nb_nodes, nb_virtual_nodes, nb_keys);
+
+  if (!ports.empty()) {
+    cpp_redis::network::set_default_nb_workers(ports.size());
+    client_benchmark(ports, nb_keys);
+  }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
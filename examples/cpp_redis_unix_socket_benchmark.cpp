@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/cpp_redis>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! Compare loopback TCP with a unix domain socket against a co-located redis-server
+//! Run redis-server with both "port 6379" and "unixsocket /tmp/redis.sock" enabled
+//!
+//! usage: cpp_redis_unix_socket_benchmark [unix_socket_path] [nb_ops] [pipeline_depth]
+//!
+
+static void
+run_benchmark(const std::string& label, const std::string& host, std::size_t port, std::size_t nb_ops, std::size_t pipeline_depth) {
+  cpp_redis::client client;
+  client.connect(host, port);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (std::size_t sent = 0; sent < nb_ops;) {
+    for (std::size_t i = 0; i < pipeline_depth && sent < nb_ops; ++i, ++sent) {
+      client.send({"PING"}, nullptr);
+    }
+
+    client.sync_commit();
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << label << ": " << nb_ops << " ops, pipeline depth " << pipeline_depth << ", "
+            << (elapsed ? nb_ops * 1000000 / elapsed : 0) << " ops/s, "
+            << static_cast<double>(elapsed) / nb_ops << " us/op" << std::endl;
+
+  client.disconnect(true);
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::string unix_socket_path = argc > 1 ? argv[1] : "/tmp/redis.sock";
+  std::size_t nb_ops           = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500000;
+  std::size_t pipeline_depth   = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+
+  //! request/response round trips: dominated by transport latency
+  run_benchmark("tcp  (127.0.0.1:6379)", "127.0.0.1", 6379, nb_ops / 100, 1);
+  run_benchmark("unix (" + unix_socket_path + ")", "unix://" + unix_socket_path, 0, nb_ops / 100, 1);
+
+  //! pipelined traffic: dominated by transport throughput
+  run_benchmark("tcp  (127.0.0.1:6379)", "127.0.0.1", 6379, nb_ops, pipeline_depth);
+  run_benchmark("unix (" + unix_socket_path + ")", "unix://" + unix_socket_path, 0, nb_ops, pipeline_depth);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
@@ -23,18 +23,31 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
+#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <cpp_redis/core/sentinel.hpp>
 #include <cpp_redis/helpers/variadic_template.hpp>
+#include <cpp_redis/misc/codec_iface.hpp>
+#include <cpp_redis/misc/command_traits.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/key_filter.hpp>
 #include <cpp_redis/misc/logger.hpp>
+#include <cpp_redis/misc/near_cache.hpp>
+#include <cpp_redis/misc/replica_routing.hpp>
+#include <cpp_redis/misc/value_traits.hpp>
+#include <cpp_redis/network/connection_options.hpp>
 #include <cpp_redis/network/redis_connection.hpp>
 #include <cpp_redis/network/tcp_client_iface.hpp>
 
@@ -58,6 +71,18 @@ public:
     slave
   };
 
+  //!
+  //! where read-only commands (see is_read_only_command()) are sent
+  //!  * primary_only: everything goes to the master
+  //!  * prefer_replica: reads go to the connected replica with the best score (latency moving average weighted by the commands in flight), the master is only used when none is available
+  //!  * nearest: same as prefer_replica, but the master competes with the replicas
+  //!
+  enum class read_policy {
+    primary_only,
+    prefer_replica,
+    nearest
+  };
+
   //!
   //! high availability (re)connection states
   //!  * dropped: connection has dropped
@@ -108,12 +133,13 @@ public:
   //!
   //! Connect to redis server
   //!
-  //! \param host host to be connected to
-  //! \param port port to be connected to
+  //! \param host host to be connected to, or unix:///path/to/redis.sock for a unix domain socket
+  //! \param port port to be connected to (ignored for unix domain sockets)
   //! \param connect_callback connect handler to be called on connect events (may be null)
   //! \param timeout_msecs maximum time to connect
   //! \param max_reconnects maximum attempts of reconnection if connection dropped
   //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on connection and kept for reconnections
   //!
   void connect(
     const std::string& host                    = "127.0.0.1",
@@ -121,7 +147,8 @@ public:
     const connect_callback_t& connect_callback = nullptr,
     std::uint32_t timeout_msecs                = 0,
     std::int32_t max_reconnects                = 0,
-    std::uint32_t reconnect_interval_msecs     = 0);
+    std::uint32_t reconnect_interval_msecs     = 0,
+    const network::connection_options& options = network::connection_options());
 
   //!
   //! Connect to redis server
@@ -131,13 +158,15 @@ public:
   //! \param timeout_msecs maximum time to connect
   //! \param max_reconnects maximum attempts of reconnection if connection dropped
   //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on connection and kept for reconnections
   //!
   void connect(
     const std::string& name,
     const connect_callback_t& connect_callback = nullptr,
     std::uint32_t timeout_msecs                = 0,
     std::int32_t max_reconnects                = 0,
-    std::uint32_t reconnect_interval_msecs     = 0);
+    std::uint32_t reconnect_interval_msecs     = 0,
+    const network::connection_options& options = network::connection_options());
 
   //!
   //! \return whether we are connected to the redis server
@@ -161,6 +190,183 @@ public:
   //!
   void cancel_reconnect(void);
 
+  //!
+  //! set where read-only commands are sent
+  //! with any other policy than primary_only, replicas are discovered on connect (SENTINEL SLAVES when connected through a sentinel, ROLE otherwise) and again after each reconnection
+  //! commands routed to a replica are not ordered with the commands sent to the master: a read may not see a write sent just before it
+  //! should be called before connect()
+  //!
+  //! \param policy read routing policy
+  //!
+  void set_read_policy(read_policy policy);
+
+  //!
+  //! look for the replicas of the master, connect to the new ones, drop the ones that went away and measure their round trip time
+  //! called automatically by connect() unless the read policy is primary_only
+  //! replicas that can not be reached are skipped
+  //!
+  void discover_replicas(void);
+
+  //!
+  //! \return host:port of the replicas currently used for reads
+  //!
+  std::vector<std::string> get_replicas(void);
+
+  //!
+  //! set the share of reads sent to a node that is not the best ranked one
+  //! a node that was slow at some point stops receiving reads, and therefore never gets the chance to show it recovered: probes keep its latency up to date
+  //! only used by the prefer_replica and nearest read policies
+  //!
+  //! \param rate share of reads used as probes, in [0, 1] (defaults to 0.05)
+  //!
+  void set_probe_rate(double rate);
+
+  //!
+  //! set how fast the measured latency follows the latest replies
+  //!
+  //! \param weight weight of each new sample in the moving average, in ]0, 1] (defaults to 0.2)
+  //!
+  void set_latency_ewma_weight(double weight);
+
+  //!
+  //! \return exponentially weighted moving average of the time between send() and the reception of the reply, over the replies received by this client
+  //!
+  std::chrono::microseconds get_latency(void) const;
+
+  //!
+  //! enable hedged reads: when a read-only command did not get its reply within the hedge delay, the same command is sent to another node (a replica, or the master if the command went to a replica) and the first reply wins
+  //! the hedge delay is the given percentile of the latency of the last replies received from the node the command went to, and is only known after a few dozens replies
+  //! the loser reply is discarded, the commands it was pipelined with are not affected
+  //! hedges are only sent when another node is available: combine with the prefer_replica or nearest read policies
+  //! a hedge sent to the master also flushes the commands buffered on it
+  //! should be called before connect()
+  //!
+  //! \param percentile latency percentile used as hedge delay, in ]0, 100[, 0 to disable hedging
+  //! \param min_delay lower bound of the hedge delay, so that a fast node does not trigger hedges on every jitter
+  //!
+  void set_hedging(double percentile, std::chrono::microseconds min_delay = std::chrono::microseconds(1000));
+
+  //!
+  //! \return current hedge delay of this client, 0 if hedging is disabled or if not enough replies were received yet
+  //!
+  std::chrono::microseconds get_hedge_delay(void) const;
+
+  //!
+  //! send blocking commands (BLPOP, BRPOP, BRPOPLPUSH, BZPOPMIN, BZPOPMAX, XREAD and XREADGROUP with BLOCK) through a lane of dedicated connections, so that they do not block the commands pipelined behind them
+  //! lane connections are opened on demand, a blocking command goes to an idle one, or to a new one until max_connections are open, or else to the least loaded one
+  //! commands sent between MULTI and EXEC / DISCARD stay on the master connection, and so does WAIT, which applies to the writes of its own connection
+  //! blocking commands are not ordered with the commands sent to the master connection: a BLPOP may run before an RPUSH sent just before it
+  //! should be called before connect()
+  //!
+  //! \param max_connections maximum number of lane connections, 0 to disable the lane (default)
+  //!
+  void set_blocking_connections(std::size_t max_connections);
+
+  //!
+  //! \return number of commands sent (committed or not) that did not receive their reply yet
+  //!
+  std::size_t get_pending_commands_count(void);
+
+  //!
+  //! set the executor running reply callbacks
+  //! by default, callbacks run inline on the network thread that read the replies, so a slow callback delays the processing of all the following replies
+  //! whatever the executor, the callbacks of this client run one at a time and in the order the commands were sent
+  //! the error callbacks of the commands failed by a disconnection also run on it: a callback blocking on another client sharing the same executor threads can therefore deadlock if these threads are all busy
+  //! should be called before connect()
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
+  //!
+  //! set the in-process cache placed in front of the connection for GET, HGET and MGET: a hit never reaches the connection and its callback runs right away, in the calling thread
+  //! writes sent through this client invalidate the keys they touch (SELECT, SWAPDB, FLUSHDB and FLUSHALL clear the cache), writes of other clients are only seen once the cached replies expire
+  //! reads sent between MULTI and EXEC / DISCARD bypass the cache
+  //! should be called before sending commands
+  //!
+  //! \param cache cache to be used, possibly shared by clients of the same database, nullptr to disable caching (default)
+  //!
+  void set_near_cache(const std::shared_ptr<near_cache>& cache);
+
+  //!
+  //! \return cache set by set_near_cache(), nullptr if caching is disabled
+  //!
+  const std::shared_ptr<near_cache>& get_near_cache(void) const;
+
+  //!
+  //! set the negative lookup filter placed in front of the connection (and of the near cache): a GET or HGET of a key the filter reports as missing never reaches the connection, its callback runs right away, in the calling thread, with a null reply
+  //! writes sent through this client add the keys they may create, keys created by other clients must be added through subscriber::subscribe_key_events(): a key created by another client is reported as missing until its event is received
+  //! SELECT and SWAPDB mark the filter as not ready (it describes another database), reads sent between MULTI and EXEC / DISCARD bypass the filter
+  //! should be called before sending commands
+  //!
+  //! \param filter filter to be used, possibly shared by clients of the same database, nullptr to disable filtering (default)
+  //!
+  void set_key_filter(const std::shared_ptr<key_filter>& filter);
+
+  //!
+  //! \return filter set by set_key_filter(), nullptr if filtering is disabled
+  //!
+  const std::shared_ptr<key_filter>& get_key_filter(void) const;
+
+  //!
+  //! populate the key filter with the keys of the database (SCAN), and mark it as ready
+  //! keyspace events should already be subscribed: they add the keys created during the scan
+  //! blocks until the scan completes: must not be called from a reply callback
+  //!
+  //! \param scan_count COUNT hint of each SCAN
+  //!
+  void bootstrap_key_filter(std::size_t scan_count = 1000);
+
+  //!
+  //! set the codec compressing large values: the values written by SET, SETNX, SETEX, PSETEX, GETSET, MSET, MSETNX, HSET, HSETNX and HMSET are compressed when at least min_size bytes long and smaller once compressed, and stored tagged with the magic of the codec
+  //! the replies of GET, GETSET, GETDEL, GETEX, SET, HGET, MGET, HMGET and HGETALL are decompressed before reaching their callbacks and futures (a corrupted value is replaced by an error reply), other commands see the compressed values (APPEND, STRLEN, GETRANGE, ... should not be used on them)
+  //! values starting with the magic are always compressed, so that they are never mistaken for compressed ones
+  //! all the clients of a database should use the same codec, the near cache keeps compressed values
+  //! should be called before sending commands
+  //!
+  //! \param codec codec to be used, nullptr to disable compression (default)
+  //! \param min_size size from which values are compressed
+  //!
+  void set_codec(const std::shared_ptr<codec_iface>& codec, std::size_t min_size = 1024);
+
+  //!
+  //! \return codec set by set_codec(), nullptr if compression is disabled
+  //!
+  const std::shared_ptr<codec_iface>& get_codec(void) const;
+
+  //!
+  //! coalesce identical concurrent reads (single flight): while a read-only command is waiting for its reply, the same command with the same arguments is not sent again but attached to the pending one, and all of them get the same reply
+  //! applies to the callback and future APIs, commands sent between MULTI and EXEC / DISCARD are never coalesced
+  //! a write sent through this client detaches the reads in flight, so that the reads sent after it get a fresh reply; writes of other clients may be missed by the reads attached before them
+  //! should be called before sending commands
+  //!
+  //! \param enabled whether identical reads are coalesced (disabled by default)
+  //!
+  void set_read_coalescing(bool enabled);
+
+  //!
+  //! batch single-key GETs into MGETs: GETs are buffered until max_keys of them are waiting, or until window elapsed after commit(), and are then sent as a single MGET whose reply is split back to the GET callbacks and futures
+  //! sync_commit() sends the waiting GETs right away, and so does any other command, which is therefore never reordered before a GET sent earlier
+  //! a GET on a key holding another type than a string replies nil instead of a WRONGTYPE error, errors of the MGET (network failure, redirections) are forwarded to every GET
+  //! should be called before sending commands
+  //!
+  //! \param max_keys maximum number of keys per MGET, 0 to disable batching (default)
+  //! \param window maximum time a GET waits for other GETs once committed
+  //! \param group_by_slot only batch keys of the same cluster hash slot together (for cluster nodes)
+  //!
+  void set_get_batching(std::size_t max_keys, std::chrono::microseconds window = std::chrono::microseconds(100), bool group_by_slot = false);
+
+  //!
+  //! combine writes to the same key: HSET, SADD, ZADD (without options) and RPUSH are buffered until max_elements fields / members / values are waiting for their key, or until window elapsed after commit(), and the writes of a key are then sent as a single command whose reply is split back to their callbacks and futures
+  //! writes of a key are sent in the order they were issued, and any other command (reads included) sends all the waiting writes first; writes to different keys may be reordered between them
+  //! RPUSH replies are split exactly, the number of added elements of HSET, SADD and ZADD is attributed to the earliest writes of the key (exact when all or none of the elements are added), errors are forwarded to every write
+  //! should be called before sending commands
+  //!
+  //! \param max_elements maximum number of elements per combined command, 0 to disable combining (default)
+  //! \param window maximum time a write waits for other writes once committed
+  //!
+  void set_write_combining(std::size_t max_elements, std::chrono::microseconds window = std::chrono::microseconds(100));
+
 public:
   //!
   //! reply callback called whenever a reply is received
@@ -188,6 +394,25 @@ public:
   //!
   std::future<reply> send(const std::vector<std::string>& redis_cmd);
 
+  //!
+  //! send a write without waiting for its reply (fire and forget): the command is wrapped in CLIENT REPLY SKIP so that the server does not reply, and it gets neither a callback nor a future
+  //! acknowledged commands sent before and after it keep their order and their replies, but the success of the write is never known and it is not resent after a reconnection
+  //! requires redis 3.2 or later, reads and transactions (MULTI, EXEC, DISCARD and the commands in between) can not be sent unacknowledged
+  //! like send(), the command is only buffered: please call commit() / sync_commit() to flush the buffer
+  //!
+  //! \param redis_cmd write to be sent
+  //! \return current instance
+  //!
+  client& send_unacknowledged(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! same as send_unacknowledged(), for several writes wrapped in a single CLIENT REPLY OFF / CLIENT REPLY ON pair
+  //!
+  //! \param redis_cmds writes to be sent
+  //! \return current instance
+  //!
+  client& send_all_unacknowledged(const std::vector<std::vector<std::string>>& redis_cmds);
+
   //!
   //! Sends all the commands that have been stored by calling send() since the last commit() call to the redis server.
   //! That is, pipelining is supported in a very simple and efficient way: client.send(...).send(...).send(...).commit() will send the 3 commands at once (instead of sending 3 network requests, one for each command, as it would have been done without pipelining).
@@ -215,25 +440,286 @@ public:
   template <class Rep, class Period>
   client&
   sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    if (m_nb_combined_writes) {
+      flush_combined_writes();
+    }
+
+    if (m_batched_gets) {
+      flush_get_batches();
+    }
+
     //! no need to call commit in case of reconnection
     //! the reconnection flow will do it for us
+    commit_secondary_nodes();
+
     if (!is_reconnecting()) {
       try_commit();
     }
 
-    std::unique_lock<std::mutex> lock_callback(m_callbacks_mutex);
-    __CPP_REDIS_LOG(debug, "cpp_redis::client waiting for callbacks to complete");
-    if (!m_sync_condvar.wait_for(lock_callback, timeout, [=] { return m_callbacks_running == 0 && m_commands.empty(); })) {
-      __CPP_REDIS_LOG(debug, "cpp_redis::client finished waiting for callback");
-    }
-    else {
-      __CPP_REDIS_LOG(debug, "cpp_redis::client timed out waiting for callback");
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+
+    {
+      std::unique_lock<std::mutex> lock_callback(m_callbacks_mutex);
+      __CPP_REDIS_LOG(debug, "cpp_redis::client waiting for callbacks to complete");
+      spin_before_block(lock_callback);
+      if (!m_sync_condvar.wait_until(lock_callback, deadline, [=] { return m_callbacks_running == 0 && m_commands.empty(); })) {
+        __CPP_REDIS_LOG(debug, "cpp_redis::client finished waiting for callback");
+      }
+      else {
+        __CPP_REDIS_LOG(debug, "cpp_redis::client timed out waiting for callback");
+      }
     }
 
+    wait_for_secondary_nodes(&deadline);
+
     return *this;
   }
 
 private:
+  //!
+  //! busy wait for pending callbacks to complete, for at most the spin_before_block_usecs connection option
+  //! the lock is released while spinning and held again on return
+  //!
+  //! \param lock lock held on m_callbacks_mutex
+  //!
+  void spin_before_block(std::unique_lock<std::mutex>& lock);
+
+  //!
+  //! initialize the latency moving average if no reply was received yet
+  //!
+  //! \param rtt measured round trip time
+  //!
+  void seed_latency(std::chrono::microseconds rtt);
+
+  //!
+  //! \return routing score of this client: latency weighted by the number of commands in flight, the lower the better
+  //!
+  double get_routing_score(void);
+
+  //!
+  //! \return replica the given read-only command should be sent to, nullptr to send it to the master
+  //!
+  std::shared_ptr<client> select_replica(void);
+
+  //!
+  //! \param primary node the command was sent to (nullptr for the master)
+  //! \return node a hedge of the command should be sent to (nullptr for the master), or primary if there is no other node available
+  //!
+  std::shared_ptr<client> select_hedge_target(const std::shared_ptr<client>& primary);
+
+  //!
+  //! send a read-only command to the given node and schedule a hedge of the command after the hedge delay of that node
+  //!
+  //! \param primary node the command is sent to (nullptr for the master)
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on the first reply
+  //!
+  void hedged_send(const std::shared_ptr<client>& primary, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! send a command and commit it right away, without any read routing
+  //! used for hedges: failures are reported through the callback
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //!
+  void send_now(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! record a latency sample and refresh the hedge delay when hedging is enabled
+  //! must be called with m_callbacks_mutex held
+  //!
+  //! \param sample latency in microseconds
+  //!
+  void add_latency_sample(double sample);
+
+  //!
+  //! \return connection of the blocking lane the given blocking command should be sent to, nullptr to send it to the master connection
+  //!
+  std::shared_ptr<client> select_blocking_node(void);
+
+  //!
+  //! send the command to a replica or to the blocking lane if it should be
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return whether the command was sent, false if it must go through the master connection
+  //!
+  bool route_to_secondary_node(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! keep track of MULTI / EXEC / DISCARD
+  //!
+  //! \param command_name upper case name of the command to be sent
+  //! \return whether the command belongs to a transaction (MULTI, EXEC and DISCARD included)
+  //!
+  bool update_transaction_state(const std::string& command_name);
+
+  //!
+  //! attach a read to an identical read in flight, or register it as in flight
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \param coalescing_callback set, when the read is registered as in flight, to the callback to be sent instead of callback: it dispatches the reply to all the attached reads
+  //! \return whether the read has been attached to a read in flight
+  //!
+  bool coalesce_read(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, reply_callback_t& coalescing_callback);
+
+  //!
+  //! send the command to the connection it should go to (replica, blocking lane or master)
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //!
+  void send_to_connection(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! GETs waiting to be sent as a MGET
+  //!
+  struct get_batch {
+    //! keys of the GETs
+    std::vector<std::string> keys;
+    //! callbacks of the GETs
+    std::vector<reply_callback_t> callbacks;
+  };
+
+  //!
+  //! add a GET to its batch, or send the waiting GETs before any other command
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return whether the command has been added to a batch
+  //!
+  bool batch_get(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! send all the waiting GETs
+  //!
+  void flush_get_batches(void);
+
+  //!
+  //! send a batch as a single MGET (or GET for a single key), m_get_batches_mutex must be held
+  //!
+  //! \param batch batch to be sent, its callbacks are moved out
+  //!
+  void send_get_batch(get_batch& batch);
+
+  //!
+  //! flush and commit the waiting GETs once the batching window elapsed
+  //!
+  void schedule_get_batches_flush(void);
+
+  //!
+  //! writes to the same key waiting to be sent as a single command
+  //!
+  struct combined_write {
+    //! combined command: name, key and the elements of all the writes
+    std::vector<std::string> command;
+    //! number of elements of each write
+    std::vector<std::size_t> sizes;
+    //! callbacks of the writes
+    std::vector<reply_callback_t> callbacks;
+  };
+
+  //!
+  //! add a write to the writes waiting for its key, or send the waiting writes before any other command
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return whether the command has been combined
+  //!
+  bool combine_write(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! send all the waiting writes
+  //!
+  void flush_combined_writes(void);
+
+  //!
+  //! send combined writes as a single command, m_combined_writes_mutex must be held
+  //!
+  //! \param write writes to be sent, their callbacks are moved out
+  //!
+  void send_combined_write(combined_write& write);
+
+  //!
+  //! flush and commit the waiting writes once the combining window elapsed
+  //!
+  void schedule_combined_writes_flush(void);
+
+  //!
+  //! serve a read from the near cache, or invalidate the keys of a write
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \param filling_callback set, on a cacheable miss, to the callback to be sent instead of callback: it fills the cache with the reply
+  //! \return whether the command was served from the cache
+  //!
+  bool send_through_near_cache(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, reply_callback_t& filling_callback);
+
+  //!
+  //! invalidate the near cache entries a command may modify
+  //!
+  //! \param name upper case name of the command
+  //! \param redis_cmd command to be sent
+  //!
+  void invalidate_near_cache(const std::string& name, const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! reply null to a read of a key missing from the key filter, or add the keys of a write to the filter
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return whether the command was answered by the filter
+  //!
+  bool filter_missing_key(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! add the keys a write may create to the key filter
+  //!
+  //! \param name upper case name of the command
+  //! \param redis_cmd command to be sent
+  //!
+  void add_to_key_filter(const std::string& name, const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! compress the values written by a command, or decompress the values a read replies
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \param encoded_cmd set, when values are compressed, to the command to be sent instead of redis_cmd
+  //! \param decoding_callback set, for reads of values, to the callback to be sent instead of callback: it decompresses the reply
+  //!
+  void apply_codec(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, std::vector<std::string>& encoded_cmd, reply_callback_t& decoding_callback);
+
+  //!
+  //! commit the replicas and blocking lane connections that received commands since the last commit
+  //! connections failing to commit flush their callbacks with an error reply, no exception is thrown
+  //!
+  void commit_secondary_nodes(void);
+
+  //!
+  //! wait for the callbacks of the commands routed to replicas and to the blocking lane to complete
+  //!
+  //! \param deadline time after which to stop waiting, nullptr to wait without limit
+  //!
+  void wait_for_secondary_nodes(const std::chrono::steady_clock::time_point* deadline);
+
+  //!
+  //! run discover_replicas() on a dedicated thread: used after reconnections, which run on a network thread
+  //!
+  void async_discover_replicas(void);
+
+  //!
+  //! connect a client to a node, with the same settings (auth, db, reconnection, socket options) as this client
+  //!
+  //! \param host node host
+  //! \param port node port
+  //! \param reconnect whether the client should reconnect on its own
+  //! \return connected client
+  //!
+  std::shared_ptr<client> connect_node(const std::string& host, std::size_t port, bool reconnect);
+
   //!
   //! \return whether a reconnection attempt should be performed
   //!
@@ -469,6 +955,10 @@ public:
   };
 
 public:
+  //!
+  //! getset, hset, lpush, rpush, sadd and set also accept values of any type having a to_redis specialization (numbers, user defined types, ...)
+  //! floating point numbers are sent with their shortest exact representation, see value_traits.hpp
+  //!
   client&
   append(const std::string& key, const std::string& value, const reply_callback_t& reply_callback);
   std::future<reply> append(const std::string& key, const std::string& value);
@@ -531,6 +1021,7 @@ public:
   client& client_pause(int timeout, const reply_callback_t& reply_callback);
   std::future<reply> client_pause(int timeout);
 
+  //! OFF and SKIP leave the following commands without reply, which their callbacks would wait for forever: use send_unacknowledged() instead
   client& client_reply(const std::string& mode, const reply_callback_t& reply_callback);
   std::future<reply> client_reply(const std::string& mode);
 
@@ -636,6 +1127,10 @@ public:
 
   client& decrby(const std::string& key, int val, const reply_callback_t& reply_callback);
   std::future<reply> decrby(const std::string& key, int val);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type decrby(const std::string& key, T val, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type decrby(const std::string& key, T val);
 
   client& del(const std::vector<std::string>& key, const reply_callback_t& reply_callback);
   std::future<reply> del(const std::vector<std::string>& key);
@@ -663,9 +1158,17 @@ public:
 
   client& expire(const std::string& key, int seconds, const reply_callback_t& reply_callback);
   std::future<reply> expire(const std::string& key, int seconds);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type expire(const std::string& key, T seconds, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type expire(const std::string& key, T seconds);
 
   client& expireat(const std::string& key, int timestamp, const reply_callback_t& reply_callback);
   std::future<reply> expireat(const std::string& key, int timestamp);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type expireat(const std::string& key, T timestamp, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type expireat(const std::string& key, T timestamp);
 
   client& flushall(const reply_callback_t& reply_callback);
   std::future<reply> flushall();
@@ -713,6 +1216,10 @@ public:
 
   client& getset(const std::string& key, const std::string& val, const reply_callback_t& reply_callback);
   std::future<reply> getset(const std::string& key, const std::string& val);
+  template <typename T>
+  typename std::enable_if<!std::is_convertible<T, std::string>::value, client&>::type getset(const std::string& key, const T& val, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<!std::is_convertible<T, std::string>::value, std::future<reply>>::type getset(const std::string& key, const T& val);
 
   client& hdel(const std::string& key, const std::vector<std::string>& fields, const reply_callback_t& reply_callback);
   std::future<reply> hdel(const std::string& key, const std::vector<std::string>& fields);
@@ -728,9 +1235,13 @@ public:
 
   client& hincrby(const std::string& key, const std::string& field, int incr, const reply_callback_t& reply_callback);
   std::future<reply> hincrby(const std::string& key, const std::string& field, int incr);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type hincrby(const std::string& key, const std::string& field, T incr, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type hincrby(const std::string& key, const std::string& field, T incr);
 
-  client& hincrbyfloat(const std::string& key, const std::string& field, float incr, const reply_callback_t& reply_callback);
-  std::future<reply> hincrbyfloat(const std::string& key, const std::string& field, float incr);
+  client& hincrbyfloat(const std::string& key, const std::string& field, double incr, const reply_callback_t& reply_callback);
+  std::future<reply> hincrbyfloat(const std::string& key, const std::string& field, double incr);
 
   client& hkeys(const std::string& key, const reply_callback_t& reply_callback);
   std::future<reply> hkeys(const std::string& key);
@@ -758,6 +1269,10 @@ public:
 
   client& hset(const std::string& key, const std::string& field, const std::string& value, const reply_callback_t& reply_callback);
   std::future<reply> hset(const std::string& key, const std::string& field, const std::string& value);
+  template <typename T>
+  typename std::enable_if<!std::is_convertible<T, std::string>::value, client&>::type hset(const std::string& key, const std::string& field, const T& value, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<!std::is_convertible<T, std::string>::value, std::future<reply>>::type hset(const std::string& key, const std::string& field, const T& value);
 
   client& hsetnx(const std::string& key, const std::string& field, const std::string& value, const reply_callback_t& reply_callback);
   std::future<reply> hsetnx(const std::string& key, const std::string& field, const std::string& value);
@@ -773,9 +1288,13 @@ public:
 
   client& incrby(const std::string& key, int incr, const reply_callback_t& reply_callback);
   std::future<reply> incrby(const std::string& key, int incr);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type incrby(const std::string& key, T incr, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type incrby(const std::string& key, T incr);
 
-  client& incrbyfloat(const std::string& key, float incr, const reply_callback_t& reply_callback);
-  std::future<reply> incrbyfloat(const std::string& key, float incr);
+  client& incrbyfloat(const std::string& key, double incr, const reply_callback_t& reply_callback);
+  std::future<reply> incrbyfloat(const std::string& key, double incr);
 
   client& info(const reply_callback_t& reply_callback);
   client& info(const std::string& section, const reply_callback_t& reply_callback);
@@ -801,6 +1320,10 @@ public:
 
   client& lpush(const std::string& key, const std::vector<std::string>& values, const reply_callback_t& reply_callback);
   std::future<reply> lpush(const std::string& key, const std::vector<std::string>& values);
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, std::string>::value, client&>::type lpush(const std::string& key, const std::vector<T>& values, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, std::string>::value, std::future<reply>>::type lpush(const std::string& key, const std::vector<T>& values);
 
   client& lpushx(const std::string& key, const std::string& value, const reply_callback_t& reply_callback);
   std::future<reply> lpushx(const std::string& key, const std::string& value);
@@ -847,9 +1370,17 @@ public:
 
   client& pexpire(const std::string& key, int milliseconds, const reply_callback_t& reply_callback);
   std::future<reply> pexpire(const std::string& key, int milliseconds);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type pexpire(const std::string& key, T milliseconds, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type pexpire(const std::string& key, T milliseconds);
 
   client& pexpireat(const std::string& key, int milliseconds_timestamp, const reply_callback_t& reply_callback);
   std::future<reply> pexpireat(const std::string& key, int milliseconds_timestamp);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, client&>::type pexpireat(const std::string& key, T milliseconds_timestamp, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type pexpireat(const std::string& key, T milliseconds_timestamp);
 
   client& pfadd(const std::string& key, const std::vector<std::string>& elements, const reply_callback_t& reply_callback);
   std::future<reply> pfadd(const std::string& key, const std::vector<std::string>& elements);
@@ -913,12 +1444,20 @@ public:
 
   client& rpush(const std::string& key, const std::vector<std::string>& values, const reply_callback_t& reply_callback);
   std::future<reply> rpush(const std::string& key, const std::vector<std::string>& values);
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, std::string>::value, client&>::type rpush(const std::string& key, const std::vector<T>& values, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, std::string>::value, std::future<reply>>::type rpush(const std::string& key, const std::vector<T>& values);
 
   client& rpushx(const std::string& key, const std::string& value, const reply_callback_t& reply_callback);
   std::future<reply> rpushx(const std::string& key, const std::string& value);
 
   client& sadd(const std::string& key, const std::vector<std::string>& members, const reply_callback_t& reply_callback);
   std::future<reply> sadd(const std::string& key, const std::vector<std::string>& members);
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, std::string>::value, client&>::type sadd(const std::string& key, const std::vector<T>& members, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<!std::is_same<T, std::string>::value, std::future<reply>>::type sadd(const std::string& key, const std::vector<T>& members);
 
   client& save(const reply_callback_t& reply_callback);
   std::future<reply> save();
@@ -964,6 +1503,10 @@ public:
 
   client& set(const std::string& key, const std::string& value, const reply_callback_t& reply_callback);
   std::future<reply> set(const std::string& key, const std::string& value);
+  template <typename T>
+  typename std::enable_if<!std::is_convertible<T, std::string>::value, client&>::type set(const std::string& key, const T& value, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<!std::is_convertible<T, std::string>::value, std::future<reply>>::type set(const std::string& key, const T& value);
 
   client& set_advanced(const std::string& key, const std::string& value, const reply_callback_t& reply_callback);
   client& set_advanced(const std::string& key, const std::string& value, bool ex, int ex_sec, bool px, int px_milli, bool nx, bool xx, const reply_callback_t& reply_callback);
@@ -1097,6 +1640,10 @@ public:
 
   client& zadd(const std::string& key, const std::vector<std::string>& options, const std::multimap<std::string, std::string>& score_members, const reply_callback_t& reply_callback);
   std::future<reply> zadd(const std::string& key, const std::vector<std::string>& options, const std::multimap<std::string, std::string>& score_members);
+  template <typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value, client&>::type zadd(const std::string& key, const std::vector<std::string>& options, const std::multimap<T, std::string>& score_members, const reply_callback_t& reply_callback);
+  template <typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value, std::future<reply>>::type zadd(const std::string& key, const std::vector<std::string>& options, const std::multimap<T, std::string>& score_members);
 
   client& zcard(const std::string& key, const reply_callback_t& reply_callback);
   std::future<reply> zcard(const std::string& key);
@@ -1349,12 +1896,13 @@ private:
 
 private:
   //!
-  //! redis connection receive handler, triggered whenever a reply has been read by the redis connection
+  //! redis connection receive handler, triggered whenever replies have been read by the redis connection
+  //! all the callbacks matching the replies of a single read are dequeued under a single lock and waiters are notified once
   //!
   //! \param connection redis_connection instance
-  //! \param reply parsed reply
+  //! \param replies parsed replies, in reception order
   //!
-  void connection_receive_handler(network::redis_connection& connection, reply& reply);
+  void connection_receive_handler(network::redis_connection& connection, std::vector<reply>& replies);
 
   //!
   //! redis_connection disconnection handler, triggered whenever a disconnection occurred
@@ -1363,8 +1911,17 @@ private:
   //!
   void connection_disconnection_handler(network::redis_connection& connection);
 
+  //!
+  //! run the callbacks matching a batch of replies, then notify sync_commit waiters
+  //!
+  //! \param callbacks callbacks to be run, callbacks[i] being called with replies[i]
+  //! \param replies replies matching the callbacks (may contain more replies than callbacks)
+  //!
+  void run_callbacks(std::vector<reply_callback_t>& callbacks, std::vector<reply>& replies);
+
   //!
   //! reset the queue of pending callbacks
+  //! the dequeued callbacks are called with an error reply on the client executor, or on the failure thread of this client (m_failure_executor) when running inline
   //!
   void clear_callbacks(void);
 
@@ -1384,6 +1941,31 @@ private:
   struct command_request {
     std::vector<std::string> command;
     reply_callback_t callback;
+    //! when the command was committed (written to the connection), default value while it is only buffered
+    std::chrono::steady_clock::time_point sent_at;
+  };
+
+  //!
+  //! read-only command sent to several nodes, only the first reply is forwarded to the user callback
+  //!
+  struct hedged_request {
+    //! whether a reply was already forwarded
+    std::atomic_bool done;
+    //! user callback
+    reply_callback_t callback;
+  };
+
+  //!
+  //! additional connection: to a replica of the master, or to the master itself for blocking commands
+  //!
+  struct node_connection {
+    //! node address
+    std::string host;
+    std::size_t port;
+    //! client connected to the node
+    std::shared_ptr<client> node;
+    //! whether commands were sent to the node since the last commit
+    bool uncommitted;
   };
 
 private:
@@ -1435,6 +2017,11 @@ private:
   //!
   std::uint32_t m_reconnect_interval_msecs = 0;
 
+  //!
+  //! socket options, kept for reconnections
+  //!
+  network::connection_options m_connection_options;
+
   //!
   //! reconnection status
   //!
@@ -1447,7 +2034,7 @@ private:
   //!
   //! sent commands waiting to be executed
   //!
-  std::queue<command_request> m_commands;
+  std::deque<command_request> m_commands;
 
   //!
   //! user defined connect status callback
@@ -1468,6 +2055,251 @@ private:
   //! number of callbacks currently being running
   //!
   std::atomic<unsigned int> m_callbacks_running;
+
+  //!
+  //! executor running reply callbacks in order (nullptr to run them inline)
+  //!
+  std::shared_ptr<serial_executor> m_callbacks_executor;
+
+  //!
+  //! latency moving average, updated under m_callbacks_mutex
+  //!
+  latency_ewma m_latency_ewma;
+
+  //!
+  //! m_latency_ewma, published for lock free reads
+  //!
+  std::atomic<std::uint64_t> m_latency_usecs;
+
+  //!
+  //! latency percentile used as hedge delay, 0 when hedging is disabled
+  //!
+  double m_hedge_percentile = 0;
+
+  //!
+  //! lower bound of the hedge delay
+  //!
+  std::chrono::microseconds m_hedge_min_delay = std::chrono::microseconds(0);
+
+  //!
+  //! latest latency samples in microseconds (circular buffer), updated under m_callbacks_mutex when hedging is enabled
+  //!
+  std::vector<std::uint32_t> m_latency_samples;
+
+  //!
+  //! number of samples recorded so far
+  //!
+  std::size_t m_nb_latency_samples = 0;
+
+  //!
+  //! hedge delay in microseconds, published for lock free reads
+  //!
+  std::atomic<std::uint64_t> m_hedge_delay_usecs;
+
+  //!
+  //! thread sending hedges once their delay expired, created on first use
+  //!
+  std::unique_ptr<timer_executor> m_hedge_timer;
+
+  //!
+  //! m_hedge_timer thread safety
+  //!
+  std::mutex m_hedge_mutex;
+
+  //!
+  //! executor given to set_executor(), also used by the replicas
+  //!
+  std::shared_ptr<executor_iface> m_executor;
+
+  //!
+  //! read routing policy
+  //!
+  read_policy m_read_policy = read_policy::primary_only;
+
+  //!
+  //! replicas used for reads
+  //!
+  std::vector<std::shared_ptr<node_connection>> m_replicas;
+
+  //!
+  //! number of routing decisions, used to spread ties and to schedule probes
+  //!
+  std::size_t m_next_replica = 0;
+
+  //!
+  //! share of reads used as probes
+  //!
+  double m_probe_rate = 0.05;
+
+  //!
+  //! m_replicas, m_next_replica and m_probe_rate thread safety
+  //!
+  std::mutex m_replicas_mutex;
+
+  //!
+  //! maximum number of blocking lane connections, 0 when the lane is disabled
+  //!
+  std::size_t m_max_blocking_connections = 0;
+
+  //!
+  //! blocking lane connections, opened on demand
+  //!
+  std::vector<std::shared_ptr<node_connection>> m_blocking_nodes;
+
+  //!
+  //! m_blocking_nodes thread safety
+  //!
+  std::mutex m_blocking_mutex;
+
+  //!
+  //! whether a MULTI was sent without its EXEC / DISCARD yet: commands are not routed to other connections meanwhile
+  //!
+  std::atomic_bool m_in_transaction;
+
+  //!
+  //! in-process cache of reads (nullptr when disabled)
+  //!
+  std::shared_ptr<near_cache> m_near_cache;
+
+  //!
+  //! negative lookup filter (nullptr when disabled)
+  //!
+  std::shared_ptr<key_filter> m_key_filter;
+
+  //!
+  //! codec compressing large values (nullptr when disabled)
+  //!
+  std::shared_ptr<codec_iface> m_codec;
+
+  //!
+  //! size from which values are compressed
+  //!
+  std::size_t m_codec_min_size = 1024;
+
+  //!
+  //! whether identical reads are coalesced
+  //!
+  bool m_read_coalescing = false;
+
+  //!
+  //! callbacks of the reads attached to each read in flight, by command and arguments
+  //!
+  std::unordered_map<std::string, std::shared_ptr<std::vector<reply_callback_t>>> m_inflight_reads;
+
+  //!
+  //! m_inflight_reads thread safety
+  //!
+  std::mutex m_inflight_reads_mutex;
+
+  //!
+  //! maximum number of keys per MGET, 0 when GET batching is disabled
+  //!
+  std::size_t m_get_batch_max_keys = 0;
+
+  //!
+  //! maximum time a committed GET waits for other GETs
+  //!
+  std::chrono::microseconds m_get_batch_window = std::chrono::microseconds(100);
+
+  //!
+  //! whether batches are grouped by cluster hash slot
+  //!
+  bool m_get_batch_by_slot = false;
+
+  //!
+  //! GETs waiting to be sent, by hash slot (always 0 when not grouped by slot)
+  //!
+  std::map<std::uint16_t, get_batch> m_get_batches;
+
+  //!
+  //! number of GETs in m_get_batches, checked without locking
+  //!
+  std::atomic<std::size_t> m_batched_gets;
+
+  //!
+  //! whether the previous command was ASKING, the next one must not be batched
+  //!
+  std::atomic_bool m_get_batch_bypass;
+
+  //!
+  //! whether a flush of the batches is scheduled on m_get_batch_timer
+  //!
+  bool m_get_batches_flush_scheduled = false;
+
+  //!
+  //! m_get_batches and m_get_batches_flush_scheduled thread safety
+  //!
+  std::mutex m_get_batches_mutex;
+
+  //!
+  //! timer flushing the batches, created on first use
+  //!
+  std::unique_ptr<timer_executor> m_get_batch_timer;
+
+  //!
+  //! maximum number of elements per combined write, 0 when write combining is disabled
+  //!
+  std::size_t m_write_combining_max_elements = 0;
+
+  //!
+  //! maximum time a committed write waits for other writes
+  //!
+  std::chrono::microseconds m_write_combining_window = std::chrono::microseconds(100);
+
+  //!
+  //! writes waiting to be sent, in the order of the first write of each key
+  //!
+  std::list<combined_write> m_combined_writes;
+
+  //!
+  //! entries of m_combined_writes, by key
+  //!
+  std::unordered_map<std::string, std::list<combined_write>::iterator> m_combined_writes_by_key;
+
+  //!
+  //! number of writes in m_combined_writes, checked without locking
+  //!
+  std::atomic<std::size_t> m_nb_combined_writes;
+
+  //!
+  //! whether the previous command was ASKING, the next one must not be combined
+  //!
+  std::atomic_bool m_write_combining_bypass;
+
+  //!
+  //! whether a flush of the writes is scheduled on m_write_combining_timer
+  //!
+  bool m_combined_writes_flush_scheduled = false;
+
+  //!
+  //! m_combined_writes, m_combined_writes_by_key and m_combined_writes_flush_scheduled thread safety
+  //!
+  std::mutex m_combined_writes_mutex;
+
+  //!
+  //! timer flushing the writes, created on first use
+  //!
+  std::unique_ptr<timer_executor> m_write_combining_timer;
+
+  //!
+  //! thread running replica discovery after reconnections, created on first use
+  //!
+  std::unique_ptr<thread_pool_executor> m_discovery_executor;
+
+  //!
+  //! m_discovery_executor thread safety
+  //!
+  std::mutex m_discovery_mutex;
+
+  //!
+  //! thread running the failure callbacks of clear_callbacks() when no executor is set, created on first use and joined by the dtor
+  //!
+  std::unique_ptr<thread_pool_executor> m_failure_executor;
+
+  //!
+  //! m_failure_executor thread safety
+  //!
+  std::mutex m_failure_executor_mutex;
 }; // namespace cpp_redis
 
 } // namespace cpp_redis
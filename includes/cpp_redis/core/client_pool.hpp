@@ -0,0 +1,281 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/misc/command_traits.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/network/connection_options.hpp>
+
+namespace cpp_redis {
+
+//!
+//! pool of clients connected to the same redis server
+//! each client owns its own connection, so commands sent through different clients are processed in parallel and a slow command only delays the commands sharing its connection
+//! commands sent through a given client keep their ordering, commands sent through the pool have no ordering guarantee between each other
+//!
+class client_pool {
+public:
+  //!
+  //! how a client is chosen for each command
+  //!  * round_robin: clients are used in turn
+  //!  * least_inflight: the client with the fewest commands waiting for a reply is used
+  //!
+  enum class routing_policy {
+    round_robin,
+    least_inflight
+  };
+
+public:
+  //!
+  //! ctor
+  //!
+  //! \param nb_connections number of clients of the pool (at least 1)
+  //! \param policy how a client is chosen for each command
+  //!
+  explicit client_pool(std::size_t nb_connections, routing_policy policy = routing_policy::least_inflight);
+
+  //!
+  //! custom ctor to specify custom tcp_clients
+  //!
+  //! \param nb_connections number of clients of the pool (at least 1)
+  //! \param tcp_client_factory called once per client to create its tcp client
+  //! \param policy how a client is chosen for each command
+  //!
+  client_pool(std::size_t nb_connections, const std::function<std::shared_ptr<network::tcp_client_iface>(void)>& tcp_client_factory, routing_policy policy = routing_policy::least_inflight);
+
+  //! dtor
+  ~client_pool(void) = default;
+
+  //! copy ctor
+  client_pool(const client_pool&) = delete;
+  //! assignment operator
+  client_pool& operator=(const client_pool&) = delete;
+
+public:
+  //!
+  //! connect all the clients of the pool to redis server
+  //! each client handles its own reconnection, as configured by max_reconnects and reconnect_interval_msecs
+  //!
+  //! \param host host to be connected to, or unix:///path/to/redis.sock for a unix domain socket
+  //! \param port port to be connected to (ignored for unix domain sockets)
+  //! \param connect_callback connect handler to be called on connect events of any client (may be null)
+  //! \param timeout_msecs maximum time to connect
+  //! \param max_reconnects maximum attempts of reconnection if connection dropped
+  //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on connection and kept for reconnections
+  //!
+  void connect(
+    const std::string& host                            = "127.0.0.1",
+    std::size_t port                                   = 6379,
+    const client::connect_callback_t& connect_callback = nullptr,
+    std::uint32_t timeout_msecs                        = 0,
+    std::int32_t max_reconnects                        = 0,
+    std::uint32_t reconnect_interval_msecs             = 0,
+    const network::connection_options& options         = network::connection_options());
+
+  //!
+  //! \return whether all the clients of the pool are connected
+  //!
+  bool is_connected(void) const;
+
+  //!
+  //! disconnect all the clients from redis server
+  //!
+  //! \param wait_for_removal when sets to true, disconnect blocks until the underlying TCP clients have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void disconnect(bool wait_for_removal = false);
+
+  //!
+  //! stop any reconnect in progress
+  //!
+  void cancel_reconnect(void);
+
+  //!
+  //! set the executor running reply callbacks of all the clients
+  //! callbacks of a given client keep running one at a time and in order
+  //! should be called before connect()
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
+  //!
+  //! \return number of clients of the pool
+  //!
+  std::size_t size(void) const;
+
+  //!
+  //! enable hedged reads: when a read-only command sent through send() did not get its reply within the hedge delay, the same command is sent through the least loaded other client of the pool and the first reply wins
+  //! the hedge delay is the given percentile of the latency of the last replies received by the client the command went to (see client::set_hedging)
+  //! the loser reply is discarded, a hedge also flushes the commands buffered on the client it is sent through
+  //! should be called before connect()
+  //!
+  //! \param percentile latency percentile used as hedge delay, in ]0, 100[, 0 to disable hedging
+  //! \param min_delay lower bound of the hedge delay
+  //!
+  void set_hedging(double percentile, std::chrono::microseconds min_delay = std::chrono::microseconds(1000));
+
+public:
+  //!
+  //! pick a client according to the routing policy
+  //! the returned client exposes the whole command API: commands buffered on it are sent by the next commit() / sync_commit() of the pool (or of the client itself)
+  //! several commands that must be processed in order (MULTI/EXEC, WATCH, SELECT, ...) must all be sent through the same returned client
+  //!
+  //! \return selected client
+  //!
+  client& get_client(void);
+
+  //!
+  //! \param index index of the client, in [0, size())
+  //! \return client at the given index
+  //!
+  client& get_client(std::size_t index);
+
+public:
+  //!
+  //! send the given command through a client picked according to the routing policy
+  //! the command is only buffered, please call commit() / sync_commit() to flush the buffers
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return current instance
+  //!
+  client_pool& send(const std::vector<std::string>& redis_cmd, const client::reply_callback_t& callback);
+
+  //!
+  //! same as the other send method
+  //! but future based: does not take any callback and return an std::future to handle the reply
+  //!
+  //! \param redis_cmd command to be sent
+  //! \return std::future to handler redis reply
+  //!
+  std::future<reply> send(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! send the commands buffered on any client of the pool since the last commit
+  //!
+  //! \return current instance
+  //!
+  client_pool& commit(void);
+
+  //!
+  //! same as commit(), but synchronous
+  //! will block until a reply has been received for all the commands sent through any client of the pool and all underlying callbacks completed
+  //!
+  //! \return current instance
+  //!
+  client_pool& sync_commit(void);
+
+  //!
+  //! same as sync_commit, but with a timeout
+  //! the timeout applies to the whole pool, not to each client
+  //!
+  //! \return current instance
+  //!
+  template <class Rep, class Period>
+  client_pool&
+  sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    commit();
+
+    for (const auto& client : m_clients) {
+      auto now = std::chrono::steady_clock::now();
+      client->sync_commit(deadline > now ? deadline - now : std::chrono::steady_clock::duration::zero());
+    }
+
+    return *this;
+  }
+
+private:
+  //!
+  //! pick a client index according to the routing policy and flag it as having buffered commands
+  //!
+  //! \return selected index
+  //!
+  std::size_t select_client(void);
+
+  //!
+  //! send a read-only command through the given client and schedule a hedge of the command through another client after the hedge delay
+  //!
+  //! \param index index of the client the command is sent through
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on the first reply
+  //!
+  void hedged_send(std::size_t index, const std::vector<std::string>& redis_cmd, const client::reply_callback_t& callback);
+
+private:
+  //!
+  //! clients of the pool
+  //!
+  std::vector<std::unique_ptr<client>> m_clients;
+
+  //!
+  //! routing policy
+  //!
+  routing_policy m_policy;
+
+  //!
+  //! next client to be used in round robin, also used to break ties in least_inflight
+  //!
+  std::atomic<std::size_t> m_next_client;
+
+  //!
+  //! clients that were handed out since the last commit and may have buffered commands
+  //!
+  std::vector<bool> m_uncommitted;
+
+  //!
+  //! m_uncommitted thread safety
+  //!
+  std::mutex m_uncommitted_mutex;
+
+  //!
+  //! whether read-only commands are hedged
+  //!
+  bool m_hedging = false;
+
+  //!
+  //! m_hedge_timer thread safety
+  //!
+  std::mutex m_hedge_mutex;
+
+  //!
+  //! thread sending hedges once their delay expired, created on first use
+  //! declared last so that it is destroyed, dropping the hedges not sent yet, before the clients they refer to
+  //!
+  std::unique_ptr<timer_executor> m_hedge_timer;
+};
+
+} // namespace cpp_redis
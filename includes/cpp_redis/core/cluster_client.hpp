@@ -0,0 +1,430 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/core/multi_key_commands.hpp>
+#include <cpp_redis/misc/command_traits.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/hash_slot.hpp>
+#include <cpp_redis/misc/multi_key_command.hpp>
+#include <cpp_redis/network/connection_options.hpp>
+
+//!
+//! maximum number of MOVED / ASK redirections followed for a single command before its error reply is returned to the caller
+//!
+#define __CPP_REDIS_CLUSTER_MAX_REDIRECTIONS 5
+
+namespace cpp_redis {
+
+//!
+//! redis cluster client
+//! keys are hashed locally and each command is sent to the node owning its slot, one connection per node
+//! MOVED and ASK redirections are followed transparently and MOVED replies trigger a background refresh of the slot map
+//! del, exists, mget, mset, touch and unlink are provided by multi_key_commands, on top of send()
+//!
+class cluster_client : public multi_key_commands<cluster_client> {
+public:
+  //!
+  //! ctor
+  //!
+  cluster_client(void);
+
+  //!
+  //! dtor
+  //! waits for the commands in flight and for any topology refresh to complete
+  //!
+  ~cluster_client(void);
+
+  //! copy ctor
+  cluster_client(const cluster_client&) = delete;
+  //! assignment operator
+  cluster_client& operator=(const cluster_client&) = delete;
+
+public:
+  //!
+  //! reply callback called whenever a reply is received
+  //! takes as parameter the received reply
+  //!
+  typedef client::reply_callback_t reply_callback_t;
+
+public:
+  //!
+  //! connect to the cluster through one of its nodes and load the slot map (CLUSTER SLOTS)
+  //! connections to the other nodes are opened as soon as a command is routed to them
+  //!
+  //! \param host host of any node of the cluster
+  //! \param port port of that node
+  //! \param timeout_msecs maximum time to connect, for each node
+  //! \param max_reconnects maximum attempts of reconnection if a node connection dropped
+  //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on each node connection
+  //!
+  void connect(
+    const std::string& host                    = "127.0.0.1",
+    std::size_t port                           = 6379,
+    std::uint32_t timeout_msecs                = 0,
+    std::int32_t max_reconnects                = 0,
+    std::uint32_t reconnect_interval_msecs     = 0,
+    const network::connection_options& options = network::connection_options());
+
+  //!
+  //! \return whether the client is connected to at least one node of the cluster
+  //!
+  bool is_connected(void);
+
+  //!
+  //! disconnect from all the nodes of the cluster
+  //!
+  //! \param wait_for_removal when sets to true, disconnect blocks until the underlying TCP clients have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void disconnect(bool wait_for_removal = false);
+
+  //!
+  //! set the executor running reply callbacks of all the node connections
+  //! should be called before connect()
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
+  //!
+  //! batch single-key GETs of the same hash slot into MGETs on every node connection (see client::set_get_batching())
+  //! should be called before connect()
+  //!
+  //! \param max_keys maximum number of keys per MGET, 0 to disable batching (default)
+  //! \param window maximum time a GET waits for other GETs once committed
+  //!
+  void set_get_batching(std::size_t max_keys, std::chrono::microseconds window = std::chrono::microseconds(100));
+
+  //!
+  //! combine writes to the same key on every node connection (see client::set_write_combining())
+  //! should be called before connect()
+  //!
+  //! \param max_elements maximum number of elements per combined command, 0 to disable combining (default)
+  //! \param window maximum time a write waits for other writes once committed
+  //!
+  void set_write_combining(std::size_t max_elements, std::chrono::microseconds window = std::chrono::microseconds(100));
+
+public:
+  //!
+  //! send the given command to the node owning its (first) key
+  //! commands without key are sent to the node the client connected through
+  //! MGET, MSET, DEL, EXISTS, UNLINK and TOUCH whose keys belong to several slots are split into one command per slot, sent in parallel, and their replies merged into a single reply, in the original key order
+  //! the command is only buffered, please call commit() / sync_commit() to flush the buffers
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply, after any redirection has been followed
+  //! \return current instance
+  //!
+  cluster_client& send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! same as the other send method
+  //! but future based: does not take any callback and return an std::future to handle the reply
+  //!
+  //! \param redis_cmd command to be sent
+  //! \return std::future to handler redis reply
+  //!
+  std::future<reply> send(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! send the commands buffered for any node since the last commit
+  //!
+  //! \return current instance
+  //!
+  cluster_client& commit(void);
+
+  //!
+  //! same as commit(), but synchronous
+  //! will block until a final reply has been received (redirections included) for all the commands sent and all underlying callbacks completed
+  //!
+  //! \return current instance
+  //!
+  cluster_client& sync_commit(void);
+
+  //!
+  //! same as sync_commit, but with a timeout
+  //! will simply block until it completes or timeout expires
+  //!
+  //! \return current instance
+  //!
+  template <class Rep, class Period>
+  cluster_client&
+  sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    commit();
+
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    m_pending_condvar.wait_for(lock, timeout, [=] { return m_pending == 0; });
+
+    return *this;
+  }
+
+public:
+  //!
+  //! reload the slot map synchronously
+  //!
+  void refresh_slots(void);
+
+  //!
+  //! \param key key to be looked up
+  //! \return client connected to the node currently owning the slot of the key, to use the typed command API (redirections are not followed for commands sent that way)
+  //!
+  client& get_client_for_key(const std::string& key);
+
+  //!
+  //! \param key key to be looked up
+  //! \return address (host:port) of the node currently owning the slot of the key
+  //!
+  std::string get_node_for_key(const std::string& key) const;
+
+private:
+  //!
+  //! connection to a node of the cluster
+  //!
+  struct node {
+    //! client connected to the node
+    std::unique_ptr<cpp_redis::client> client;
+    //! guarantees that ASKING and the command it applies to are not interleaved with other commands
+    std::mutex send_mutex;
+  };
+
+  //!
+  //! node owning each slot (host:port), an empty string when unknown
+  //! immutable once published: refreshes build a new map and swap it atomically, so that routing never waits for a refresh
+  //!
+  typedef std::vector<std::string> slot_map_t;
+
+private:
+  //!
+  //! \param slot hash slot
+  //! \return address of the node currently owning the slot
+  //!
+  std::string get_node_for_slot(std::uint16_t slot) const;
+
+  //!
+  //! \param redis_cmd command to be routed
+  //! \return address of the node the command should be sent to
+  //!
+  std::string get_node_for_command(const std::vector<std::string>& redis_cmd) const;
+
+  //!
+  //! \param addr node address (host:port)
+  //! \return connection to the given node, opened on first use (outside of m_nodes_mutex, so that a slow connection does not block the other nodes)
+  //!
+  node& get_node(const std::string& addr);
+
+  //!
+  //! send a command to the given node, following redirections when it replies MOVED or ASK
+  //!
+  //! \param addr node address
+  //! \param redis_cmd command to be sent
+  //! \param callback user callback
+  //! \param nb_redirections number of redirections already followed for this command
+  //! \param asking whether ASKING must be sent before the command
+  //! \param commit whether the node should be committed right away (redirections)
+  //!
+  void send_to_node(const std::string& addr, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, unsigned int nb_redirections, bool asking, bool commit);
+
+  //!
+  //! resend a command to the node a MOVED or ASK redirection points to
+  //! may block while connecting to a node seen for the first time
+  //!
+  //! \param addr node the command is redirected to
+  //! \param redis_cmd command to be sent
+  //! \param callback user callback
+  //! \param nb_redirections number of redirections followed for this command, including this one
+  //! \param asking whether ASKING must be sent before the command
+  //! \return false if the command could not be sent (its callback has not been called)
+  //!
+  bool follow_redirection(const std::string& addr, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, unsigned int nb_redirections, bool asking);
+
+  //!
+  //! split a multi-key command whose keys belong to several slots into one command per slot and merge their replies
+  //! the caller must have counted the command as pending: it is completed by the last sub-command
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback user callback, called once with the merged reply
+  //! \return false if the command is not a supported multi-key command or if all its keys belong to the same slot
+  //!
+  bool scatter_send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! build a slot map from a CLUSTER SLOTS reply
+  //!
+  //! \param reply CLUSTER SLOTS reply
+  //! \param default_host host to be used for nodes announced without host
+  //! \return the new slot map, nullptr if the reply is invalid
+  //!
+  static std::shared_ptr<const slot_map_t> parse_slots(const reply& reply, const std::string& default_host);
+
+  //!
+  //! reload the slot map in the background, unless a refresh is already in progress
+  //!
+  void async_refresh_slots(void);
+
+  //!
+  //! record the new owner of a single slot, following a MOVED redirection
+  //! kept aside of the slot map until the next refresh, so that a MOVED does not copy the whole map
+  //!
+  //! \param slot slot that moved
+  //! \param addr new owner
+  //!
+  void update_slot(std::uint16_t slot, const std::string& addr);
+
+  //!
+  //! publish a new slot map, dropping the slots recorded by update_slot() it supersedes
+  //!
+  //! \param slots new slot map
+  //!
+  void set_slots(const std::shared_ptr<const slot_map_t>& slots);
+
+  //!
+  //! notify sync_commit() waiters that a command completed
+  //!
+  void command_done(void);
+
+  //!
+  //! mark the background refresh as completed
+  //!
+  void refresh_done(void);
+
+private:
+  //!
+  //! connect timeout, used for every node
+  //!
+  std::uint32_t m_connect_timeout_msecs = 0;
+
+  //!
+  //! max reconnect attempts, used for every node
+  //!
+  std::int32_t m_max_reconnects = 0;
+
+  //!
+  //! reconnect interval, used for every node
+  //!
+  std::uint32_t m_reconnect_interval_msecs = 0;
+
+  //!
+  //! socket options, used for every node
+  //!
+  network::connection_options m_connection_options;
+
+  //!
+  //! executor running reply callbacks, used for every node
+  //!
+  std::shared_ptr<executor_iface> m_executor;
+
+  //!
+  //! GET batching settings, used for every node
+  //!
+  std::size_t m_get_batch_max_keys            = 0;
+  std::chrono::microseconds m_get_batch_window = std::chrono::microseconds(100);
+
+  //!
+  //! write combining settings, used for every node
+  //!
+  std::size_t m_write_combining_max_elements         = 0;
+  std::chrono::microseconds m_write_combining_window = std::chrono::microseconds(100);
+
+  //!
+  //! node the client connected through, used for commands without key and as fallback for unknown slots
+  //!
+  std::string m_seed_node;
+
+  //!
+  //! current slot map, accessed through std::atomic_load / std::atomic_store
+  //!
+  std::shared_ptr<const slot_map_t> m_slots;
+
+  //!
+  //! slots redirected by MOVED since the last refresh, looked up before m_slots
+  //!
+  std::unordered_map<std::uint16_t, std::string> m_moved_slots;
+
+  //!
+  //! size of m_moved_slots, so that routing only locks when some slots moved
+  //!
+  std::atomic<std::size_t> m_nb_moved_slots;
+
+  //!
+  //! m_moved_slots thread safety
+  //!
+  mutable std::mutex m_moved_slots_mutex;
+
+  //!
+  //! node connections, by address
+  //!
+  std::map<std::string, std::unique_ptr<node>> m_nodes;
+
+  //!
+  //! nodes that received commands since the last commit
+  //!
+  std::set<std::string> m_uncommitted_nodes;
+
+  //!
+  //! m_nodes and m_uncommitted_nodes thread safety
+  //!
+  mutable std::mutex m_nodes_mutex;
+
+  //!
+  //! whether a background refresh of the slot map is in progress
+  //!
+  std::atomic_bool m_refreshing;
+
+  //!
+  //! whether the client is being destroyed: redirections to new nodes are not followed anymore
+  //!
+  std::atomic_bool m_stopping;
+
+  //!
+  //! number of commands sent that did not get their final reply yet
+  //!
+  std::size_t m_pending;
+
+  //!
+  //! m_pending thread safety
+  //!
+  std::mutex m_pending_mutex;
+
+  //!
+  //! condvar for m_pending and m_refreshing updates
+  //!
+  std::condition_variable m_pending_condvar;
+};
+
+} // namespace cpp_redis
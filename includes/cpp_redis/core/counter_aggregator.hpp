@@ -0,0 +1,214 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/misc/executor.hpp>
+
+namespace cpp_redis {
+
+//!
+//! write-behind aggregation of counter increments
+//! increments are merged locally, in shards picked by calling thread, and flushed as one pipelined batch of INCRBY / HINCRBY (one command per counter) every flush interval, or as soon as max_pending_keys counters are waiting
+//! flushes are at most once: the increments of a failed flush are dropped (the server may have applied part of them) and counted in the statistics
+//! staleness is bounded: a crash loses at most the increments of one flush interval, on at most max_pending_keys counters
+//! increments still waiting are flushed on destruction, call sync_flush() before shutting down to know they have been applied
+//!
+class counter_aggregator {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param connection client the increments are flushed to, connected or not
+  //! \param flush_interval time between two flushes
+  //! \param max_pending_keys number of distinct counters triggering a flush before the end of the interval
+  //! \param nb_shards number of shards, 0 for one per hardware thread
+  //!
+  explicit counter_aggregator(
+    const std::shared_ptr<client>& connection,
+    std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100),
+    std::size_t max_pending_keys             = 10000,
+    std::size_t nb_shards                    = 0);
+
+  //!
+  //! dtor
+  //! flushes the increments still waiting and waits for their replies
+  //!
+  ~counter_aggregator(void);
+
+  //! copy ctor
+  counter_aggregator(const counter_aggregator&) = delete;
+  //! assignment operator
+  counter_aggregator& operator=(const counter_aggregator&) = delete;
+
+public:
+  //!
+  //! aggregation statistics
+  //!
+  struct aggregator_stats {
+    //! increments received
+    std::uint64_t increments;
+    //! INCRBY / HINCRBY commands sent
+    std::uint64_t flushed_commands;
+    //! commands sent that failed
+    std::uint64_t failed_commands;
+    //! counters waiting for the next flush
+    std::size_t pending_keys;
+  };
+
+public:
+  //!
+  //! increment a counter by 1
+  //!
+  //! \param key counter key
+  //!
+  void incr(const std::string& key);
+
+  //!
+  //! increment a counter
+  //!
+  //! \param key counter key
+  //! \param increment increment, may be negative
+  //!
+  void incrby(const std::string& key, std::int64_t increment);
+
+  //!
+  //! increment a counter stored in a hash field
+  //!
+  //! \param key hash key
+  //! \param field counter field
+  //! \param increment increment, may be negative
+  //!
+  void hincrby(const std::string& key, const std::string& field, std::int64_t increment);
+
+  //!
+  //! send the increments waiting, without waiting for their replies
+  //!
+  void flush(void);
+
+  //!
+  //! send the increments waiting, and wait for the replies of all the commands of the client
+  //!
+  void sync_flush(void);
+
+  //!
+  //! \return aggregation statistics
+  //!
+  aggregator_stats get_stats(void) const;
+
+private:
+  //!
+  //! increments merged by a subset of the threads
+  //!
+  struct shard {
+    //! INCRBY increments by key
+    std::unordered_map<std::string, std::int64_t> counters;
+    //! HINCRBY increments by key and field
+    std::unordered_map<std::string, std::unordered_map<std::string, std::int64_t>> hash_counters;
+    //! shard thread safety
+    std::mutex mutex;
+  };
+
+  //!
+  //! \return shard of the calling thread
+  //!
+  shard& get_shard(void);
+
+  //!
+  //! flush soon on the timer thread, once the size limit is reached
+  //!
+  void request_flush(void);
+
+  //!
+  //! flush every flush interval
+  //!
+  //! \param timer timer running the flushes
+  //!
+  void schedule_periodic_flush(timer_executor* timer);
+
+  //!
+  //! buffer the increments waiting on the client
+  //!
+  //! \return number of commands buffered
+  //!
+  std::size_t send_pending(void);
+
+private:
+  //!
+  //! client the increments are flushed to
+  //!
+  std::shared_ptr<client> m_connection;
+
+  //!
+  //! time between two flushes
+  //!
+  std::chrono::milliseconds m_flush_interval;
+
+  //!
+  //! number of distinct counters triggering a flush
+  //!
+  std::size_t m_max_pending_keys;
+
+  //!
+  //! shards
+  //!
+  std::vector<std::unique_ptr<shard>> m_shards;
+
+  //!
+  //! number of distinct counters waiting
+  //!
+  std::atomic<std::size_t> m_pending_keys;
+
+  //!
+  //! whether a flush has been requested on the timer thread
+  //!
+  std::atomic_bool m_flush_requested;
+
+  //!
+  //! whether the aggregator is being destroyed (stops the periodic flush)
+  //!
+  std::atomic_bool m_stopping;
+
+  //!
+  //! statistics, failures are shared with the callbacks that may complete after destruction
+  //!
+  std::atomic<std::uint64_t> m_increments;
+  std::atomic<std::uint64_t> m_flushed_commands;
+  std::shared_ptr<std::atomic<std::uint64_t>> m_failed_commands;
+
+  //!
+  //! timer running the flushes
+  //!
+  std::unique_ptr<timer_executor> m_timer;
+};
+
+} // namespace cpp_redis
@@ -0,0 +1,185 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/misc/command_traits.hpp>
+#include <cpp_redis/misc/executor.hpp>
+
+namespace cpp_redis {
+
+//!
+//! lightweight client handle multiplexed with other handles over the connection of a shared cpp_redis::client
+//! many components can pipeline over a single socket without coordinating with each other: each handle has its own callback ordering and sync_commit() scope
+//! commands changing the state of the connection (SELECT, AUTH, MULTI/EXEC, WATCH, SUBSCRIBE, CLIENT REPLY, ...) would affect all the handles and are rejected
+//! blocking commands would block all the handles: enable client::set_blocking_connections() on the shared client to use them
+//!
+class logical_client {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param connection shared client, connected or not, whose connection is used by this handle
+  //!
+  explicit logical_client(const std::shared_ptr<client>& connection);
+
+  //!
+  //! dtor
+  //! waits for the callbacks of the commands sent through this handle
+  //!
+  ~logical_client(void);
+
+  //! copy ctor
+  logical_client(const logical_client&) = delete;
+  //! assignment operator
+  logical_client& operator=(const logical_client&) = delete;
+
+public:
+  //!
+  //! reply callback called whenever a reply is received
+  //! takes as parameter the received reply
+  //!
+  typedef client::reply_callback_t reply_callback_t;
+
+public:
+  //!
+  //! set the executor running the reply callbacks of this handle, one at a time and in order
+  //! by default, callbacks run on the thread running the callbacks of the shared client, so that a slow callback delays all the handles
+  //! should be called before sending commands
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them on the callbacks thread of the shared client)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
+  //!
+  //! \return shared client
+  //!
+  const std::shared_ptr<client>& get_connection(void) const;
+
+  //!
+  //! \return whether the shared client is connected
+  //!
+  bool is_connected(void) const;
+
+  //!
+  //! \return number of commands sent through this handle that did not complete yet
+  //!
+  std::size_t get_pending_commands_count(void);
+
+public:
+  //!
+  //! send the given command through the shared connection
+  //! the command is only buffered, please call commit() / sync_commit() to flush the buffer
+  //! throws redis_error for commands changing the state of the connection
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return current instance
+  //!
+  logical_client& send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! same as the other send method
+  //! but future based: does not take any callback and return an std::future to handle the reply
+  //!
+  //! \param redis_cmd command to be sent
+  //! \return std::future to handler redis reply
+  //!
+  std::future<reply> send(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! flush the buffer of the shared connection
+  //! commands buffered by the other handles are sent at the same time
+  //!
+  //! \return current instance
+  //!
+  logical_client& commit(void);
+
+  //!
+  //! same as commit(), but synchronous
+  //! only waits for the commands sent through this handle and for their callbacks
+  //!
+  //! \return current instance
+  //!
+  logical_client& sync_commit(void);
+
+  //!
+  //! same as sync_commit, but with a timeout
+  //! will simply block until it completes or timeout expires
+  //!
+  //! \return current instance
+  //!
+  template <class Rep, class Period>
+  logical_client&
+  sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    commit();
+
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->condvar.wait_for(lock, timeout, [=] { return m_state->pending == 0; });
+
+    return *this;
+  }
+
+private:
+  //!
+  //! state shared with the callbacks in flight
+  //!
+  struct state {
+    //! commands sent that did not complete yet
+    std::size_t pending = 0;
+    //! executor running the callbacks of the handle in order (nullptr to run them inline)
+    std::shared_ptr<serial_executor> executor;
+    //! pending thread safety
+    std::mutex mutex;
+    //! condvar for pending updates
+    std::condition_variable condvar;
+  };
+
+  //!
+  //! mark a command as completed
+  //!
+  //! \param state state of the handle
+  //!
+  static void command_done(const std::shared_ptr<state>& state);
+
+private:
+  //!
+  //! shared client
+  //!
+  std::shared_ptr<client> m_connection;
+
+  //!
+  //! handle state
+  //!
+  std::shared_ptr<state> m_state;
+};
+
+} // namespace cpp_redis
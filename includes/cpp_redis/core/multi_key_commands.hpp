@@ -0,0 +1,154 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cpp_redis/core/reply.hpp>
+
+namespace cpp_redis {
+
+//!
+//! multi-key commands (DEL, EXISTS, MGET, MSET, TOUCH, UNLINK) of the clients spreading keys over several nodes
+//! same signatures as the client ones: the commands are built here and given to the send() of Derived, which splits them over the nodes when needed
+//!
+//! Derived must provide:
+//!   Derived& send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+//!   std::future<reply> send(const std::vector<std::string>& redis_cmd);
+//!
+template <typename Derived>
+class multi_key_commands {
+public:
+  //!
+  //! callback called whenever a reply is received
+  //! takes as parameter the received reply
+  //!
+  typedef std::function<void(reply&)> reply_callback_t;
+
+public:
+  Derived&
+  del(const std::vector<std::string>& keys, const reply_callback_t& reply_callback) {
+    return derived().send(make_keys_command("DEL", keys), reply_callback);
+  }
+
+  std::future<reply>
+  del(const std::vector<std::string>& keys) {
+    return derived().send(make_keys_command("DEL", keys));
+  }
+
+  Derived&
+  exists(const std::vector<std::string>& keys, const reply_callback_t& reply_callback) {
+    return derived().send(make_keys_command("EXISTS", keys), reply_callback);
+  }
+
+  std::future<reply>
+  exists(const std::vector<std::string>& keys) {
+    return derived().send(make_keys_command("EXISTS", keys));
+  }
+
+  Derived&
+  mget(const std::vector<std::string>& keys, const reply_callback_t& reply_callback) {
+    return derived().send(make_keys_command("MGET", keys), reply_callback);
+  }
+
+  std::future<reply>
+  mget(const std::vector<std::string>& keys) {
+    return derived().send(make_keys_command("MGET", keys));
+  }
+
+  Derived&
+  mset(const std::vector<std::pair<std::string, std::string>>& key_vals, const reply_callback_t& reply_callback) {
+    return derived().send(make_mset_command(key_vals), reply_callback);
+  }
+
+  std::future<reply>
+  mset(const std::vector<std::pair<std::string, std::string>>& key_vals) {
+    return derived().send(make_mset_command(key_vals));
+  }
+
+  Derived&
+  touch(const std::vector<std::string>& keys, const reply_callback_t& reply_callback) {
+    return derived().send(make_keys_command("TOUCH", keys), reply_callback);
+  }
+
+  std::future<reply>
+  touch(const std::vector<std::string>& keys) {
+    return derived().send(make_keys_command("TOUCH", keys));
+  }
+
+  Derived&
+  unlink(const std::vector<std::string>& keys, const reply_callback_t& reply_callback) {
+    return derived().send(make_keys_command("UNLINK", keys), reply_callback);
+  }
+
+  std::future<reply>
+  unlink(const std::vector<std::string>& keys) {
+    return derived().send(make_keys_command("UNLINK", keys));
+  }
+
+protected:
+  //! only usable as a base class
+  multi_key_commands(void) = default;
+  //! dtor
+  ~multi_key_commands(void) = default;
+
+private:
+  //!
+  //! \return the client the commands are sent through
+  //!
+  Derived&
+  derived(void) {
+    return static_cast<Derived&>(*this);
+  }
+
+  //!
+  //! \return command name followed by the keys
+  //!
+  static std::vector<std::string>
+  make_keys_command(const std::string& name, const std::vector<std::string>& keys) {
+    std::vector<std::string> cmd = {name};
+    cmd.insert(cmd.end(), keys.begin(), keys.end());
+    return cmd;
+  }
+
+  //!
+  //! \return MSET command setting the given pairs
+  //!
+  static std::vector<std::string>
+  make_mset_command(const std::vector<std::pair<std::string, std::string>>& key_vals) {
+    std::vector<std::string> cmd = {"MSET"};
+
+    for (const auto& obj : key_vals) {
+      cmd.push_back(obj.first);
+      cmd.push_back(obj.second);
+    }
+
+    return cmd;
+  }
+};
+
+} // namespace cpp_redis
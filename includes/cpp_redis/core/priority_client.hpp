@@ -0,0 +1,248 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/network/connection_options.hpp>
+
+namespace cpp_redis {
+
+//!
+//! client sending each command through the connection (lane) of its priority class
+//! a connection writes and processes its commands in order: interactive commands sent on their own connection never wait behind megabytes of bulk commands buffered or in flight on another one
+//! commands of the same priority keep their ordering, commands of different priorities have no ordering guarantee between each other
+//!
+class priority_client {
+public:
+  //!
+  //! priority classes, each class has its own connection
+  //!  * interactive: latency critical commands, committed first
+  //!  * normal: default class
+  //!  * bulk: background traffic (bulk loads, SCAN sweeps, ...) allowed to saturate its connection
+  //!
+  enum class priority {
+    interactive,
+    normal,
+    bulk
+  };
+
+public:
+#ifndef __CPP_REDIS_USE_CUSTOM_TCP_CLIENT
+  //! ctor
+  priority_client(void);
+#endif /* __CPP_REDIS_USE_CUSTOM_TCP_CLIENT */
+
+  //!
+  //! custom ctor to specify custom tcp_clients
+  //!
+  //! \param tcp_client_factory called once per priority class to create the tcp client of its connection
+  //!
+  explicit priority_client(const std::function<std::shared_ptr<network::tcp_client_iface>(void)>& tcp_client_factory);
+
+  //! dtor
+  ~priority_client(void) = default;
+
+  //! copy ctor
+  priority_client(const priority_client&) = delete;
+  //! assignment operator
+  priority_client& operator=(const priority_client&) = delete;
+
+public:
+  //!
+  //! set socket options specific to the connection of a priority class, used instead of the options given to connect()
+  //! typically TCP_NODELAY for the interactive class and larger socket buffers for the bulk class
+  //! should be called before connect()
+  //!
+  //! \param lane priority class
+  //! \param options socket options of its connection
+  //!
+  void set_connection_options(priority lane, const network::connection_options& options);
+
+  //!
+  //! connect the connections of all the priority classes to redis server
+  //! each connection handles its own reconnection, as configured by max_reconnects and reconnect_interval_msecs
+  //!
+  //! \param host host to be connected to, or unix:///path/to/redis.sock for a unix domain socket
+  //! \param port port to be connected to (ignored for unix domain sockets)
+  //! \param connect_callback connect handler to be called on connect events of any connection (may be null)
+  //! \param timeout_msecs maximum time to connect
+  //! \param max_reconnects maximum attempts of reconnection if connection dropped
+  //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options of the classes without specific options
+  //!
+  void connect(
+    const std::string& host                            = "127.0.0.1",
+    std::size_t port                                   = 6379,
+    const client::connect_callback_t& connect_callback = nullptr,
+    std::uint32_t timeout_msecs                        = 0,
+    std::int32_t max_reconnects                        = 0,
+    std::uint32_t reconnect_interval_msecs             = 0,
+    const network::connection_options& options         = network::connection_options());
+
+  //!
+  //! \return whether the connections of all the priority classes are connected
+  //!
+  bool is_connected(void) const;
+
+  //!
+  //! disconnect all the connections from redis server
+  //!
+  //! \param wait_for_removal when sets to true, disconnect blocks until the underlying TCP clients have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void disconnect(bool wait_for_removal = false);
+
+  //!
+  //! stop any reconnect in progress
+  //!
+  void cancel_reconnect(void);
+
+  //!
+  //! set the executor running reply callbacks of all the connections
+  //! should be called before connect()
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
+public:
+  //!
+  //! the returned client exposes the whole command API: commands buffered on it are sent by the next commit() / sync_commit() (of this instance or of the client itself)
+  //!
+  //! \param lane priority class
+  //! \return client of the given priority class
+  //!
+  client& get_client(priority lane);
+
+  //!
+  //! send the given command through the connection of the given priority class
+  //! the command is only buffered, please call commit() / sync_commit() to flush the buffers
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \param lane priority class of the command
+  //! \return current instance
+  //!
+  priority_client& send(const std::vector<std::string>& redis_cmd, const client::reply_callback_t& callback, priority lane = priority::normal);
+
+  //!
+  //! same as the other send method
+  //! but future based: does not take any callback and return an std::future to handle the reply
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param lane priority class of the command
+  //! \return std::future to handler redis reply
+  //!
+  std::future<reply> send(const std::vector<std::string>& redis_cmd, priority lane = priority::normal);
+
+  //!
+  //! send the commands buffered since the last commit, highest priority first
+  //!
+  //! \return current instance
+  //!
+  priority_client& commit(void);
+
+  //!
+  //! same as commit(), but synchronous
+  //! will block until a reply has been received for all the commands sent through any priority class and all underlying callbacks completed
+  //!
+  //! \return current instance
+  //!
+  priority_client& sync_commit(void);
+
+  //!
+  //! same as sync_commit, but only for a given priority class: an interactive request does not have to wait for the bulk traffic
+  //!
+  //! \param lane priority class
+  //! \return current instance
+  //!
+  priority_client& sync_commit(priority lane);
+
+  //!
+  //! same as sync_commit, but with a timeout
+  //! the timeout applies to the whole client, not to each connection
+  //!
+  //! \return current instance
+  //!
+  template <class Rep, class Period>
+  priority_client&
+  sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    commit();
+
+    for (const auto& client : m_clients) {
+      auto now = std::chrono::steady_clock::now();
+      client->sync_commit(deadline > now ? deadline - now : std::chrono::steady_clock::duration::zero());
+    }
+
+    return *this;
+  }
+
+private:
+  //!
+  //! \param lane priority class
+  //! \return index of its connection in m_clients
+  //!
+  static std::size_t lane_index(priority lane);
+
+  //!
+  //! flag the connection of the given priority class as having buffered commands
+  //!
+  //! \param lane priority class
+  //! \return client of the priority class
+  //!
+  client& use_lane(priority lane);
+
+private:
+  //!
+  //! connection of each priority class, highest priority first
+  //!
+  std::vector<std::unique_ptr<client>> m_clients;
+
+  //!
+  //! socket options of each priority class, when set with set_connection_options()
+  //!
+  std::vector<std::unique_ptr<network::connection_options>> m_connection_options;
+
+  //!
+  //! priority classes that received commands since the last commit
+  //!
+  std::vector<bool> m_uncommitted;
+
+  //!
+  //! m_uncommitted thread safety
+  //!
+  std::mutex m_uncommitted_mutex;
+};
+
+} // namespace cpp_redis
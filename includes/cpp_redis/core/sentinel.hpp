@@ -27,6 +27,7 @@
 #include <queue>
 #include <vector>
 
+#include <cpp_redis/misc/executor.hpp>
 #include <cpp_redis/misc/logger.hpp>
 #include <cpp_redis/network/redis_connection.hpp>
 
@@ -121,8 +122,8 @@ public:
   //!
   //! add a sentinel definition. Required for connect() or get_master_addr_by_name() when autoconnect is enabled.
   //!
-  //! \param host sentinel host
-  //! \param port sentinel port
+  //! \param host sentinel host, or unix:///path/to/sentinel.sock for a unix domain socket
+  //! \param port sentinel port (ignored for unix domain sockets)
   //! \param timeout_msecs maximum time to connect
   //! \return current instance
   //!
@@ -146,6 +147,16 @@ public:
   //!
   bool is_connected(void);
 
+  //!
+  //! set the executor running reply callbacks
+  //! by default, callbacks run inline on the network thread that read the reply
+  //! whatever the executor, callbacks run one at a time and in the order the commands were sent
+  //! should be called before connecting
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
   //!
   //! handlers called whenever disconnection occurred
   //! function takes the sentinel current instance as parameter
@@ -163,8 +174,8 @@ public:
   //!
   //! Connect to named sentinel
   //!
-  //! \param host host to be connected to
-  //! \param port port to be connected to
+  //! \param host host to be connected to, or unix:///path/to/sentinel.sock for a unix domain socket
+  //! \param port port to be connected to (ignored for unix domain sockets)
   //! \param timeout_msecs maximum time to connect
   //! \param disconnect_handler handler to be called whenever disconnection occurs
   //!
@@ -193,6 +204,22 @@ public:
     std::size_t& port,
     bool autoconnect = true);
 
+  //!
+  //! Used to find the replicas of a redis master by asking one or more sentinels (SENTINEL SLAVES).
+  //! Replicas flagged as down or disconnected by the sentinel are skipped.
+  //! Handles connect() and disconnect() automatically when autoconnect=true
+  //! This method is synchronous. No need to call sync_commit() or process a reply callback.
+  //!
+  //! \param name sentinel name
+  //! \param replicas filled in with the host and port of each replica
+  //! \param autoconnect see get_master_addr_by_name()
+  //! \return true if the sentinel answered, false otherwise
+  //!
+  bool get_replicas_addr_by_name(
+    const std::string& name,
+    std::vector<std::pair<std::string, std::size_t>>& replicas,
+    bool autoconnect = true);
+
 public:
   sentinel& ckquorum(const std::string& name, const reply_callback_t& reply_callback = nullptr);
   sentinel& failover(const std::string& name, const reply_callback_t& reply_callback = nullptr);
@@ -342,6 +369,11 @@ private:
   //! number of callbacks currently being running
   //!
   std::atomic<unsigned int> m_callbacks_running;
+
+  //!
+  //! executor running reply callbacks in order (nullptr to run them inline)
+  //!
+  std::shared_ptr<serial_executor> m_callbacks_executor;
 };
 
 } // namespace cpp_redis
@@ -0,0 +1,297 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/core/multi_key_commands.hpp>
+#include <cpp_redis/misc/command_traits.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/hash_ring.hpp>
+#include <cpp_redis/misc/multi_key_command.hpp>
+#include <cpp_redis/network/connection_options.hpp>
+
+namespace cpp_redis {
+
+//!
+//! client sharding keys over independent (non cluster) redis nodes
+//! keys are mapped to nodes by a consistent hash ring with virtual nodes, so that adding or removing one node out of N only remaps about 1/N of the keys
+//! commands are pipelined on one connection per node and multi-key commands spanning several nodes are fanned out
+//! del, exists, mget, mset, touch and unlink are provided by multi_key_commands, on top of send()
+//!
+class sharded_client : public multi_key_commands<sharded_client> {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param nb_virtual_nodes number of points of each node on the hash ring (and per unit of weight)
+  //!
+  explicit sharded_client(std::size_t nb_virtual_nodes = 160);
+
+  //!
+  //! dtor
+  //! waits for the commands in flight to complete
+  //!
+  ~sharded_client(void);
+
+  //! copy ctor
+  sharded_client(const sharded_client&) = delete;
+  //! assignment operator
+  sharded_client& operator=(const sharded_client&) = delete;
+
+public:
+  //!
+  //! reply callback called whenever a reply is received
+  //! takes as parameter the received reply
+  //!
+  typedef client::reply_callback_t reply_callback_t;
+
+public:
+  //!
+  //! connect to a node and add it to the hash ring
+  //! keys it now owns are routed to it for the commands sent afterwards
+  //!
+  //! \param host host to be connected to
+  //! \param port port to be connected to
+  //! \param weight relative share of the keys the node should get
+  //! \param timeout_msecs maximum time to connect
+  //! \param max_reconnects maximum attempts of reconnection if the connection dropped
+  //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on the connection
+  //!
+  void add_node(
+    const std::string& host,
+    std::size_t port,
+    std::size_t weight                         = 1,
+    std::uint32_t timeout_msecs                = 0,
+    std::int32_t max_reconnects                = 0,
+    std::uint32_t reconnect_interval_msecs     = 0,
+    const network::connection_options& options = network::connection_options());
+
+  //!
+  //! remove a node from the hash ring
+  //! commands already sent to the node are committed and the connection is closed once they completed (blocking)
+  //!
+  //! \param host host of the node
+  //! \param port port of the node
+  //!
+  void remove_node(const std::string& host, std::size_t port);
+
+  //!
+  //! \return addresses (host:port) of the nodes of the ring
+  //!
+  std::vector<std::string> get_nodes(void) const;
+
+  //!
+  //! \return whether the client is connected to all the nodes of the ring (false if there is none)
+  //!
+  bool is_connected(void) const;
+
+  //!
+  //! disconnect from all the nodes
+  //! nodes stay part of the ring
+  //!
+  //! \param wait_for_removal when sets to true, disconnect blocks until the underlying TCP clients have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void disconnect(bool wait_for_removal = false);
+
+  //!
+  //! set the executor running reply callbacks of the node connections
+  //! should be called before add_node()
+  //!
+  //! \param executor executor running reply callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
+public:
+  //!
+  //! send the given command to the node owning its (first) key
+  //! MGET, MSET, DEL, EXISTS, UNLINK and TOUCH whose keys belong to several nodes are split into one command per node and their replies merged into a single reply, in the original key order
+  //! commands without key can not be routed and throw a redis_error: use get_client() for them
+  //! the command is only buffered, please call commit() / sync_commit() to flush the buffers
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return current instance
+  //!
+  sharded_client& send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! same as the other send method
+  //! but future based: does not take any callback and return an std::future to handle the reply
+  //!
+  //! \param redis_cmd command to be sent
+  //! \return std::future to handler redis reply
+  //!
+  std::future<reply> send(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! send the commands buffered for any node since the last commit
+  //!
+  //! \return current instance
+  //!
+  sharded_client& commit(void);
+
+  //!
+  //! same as commit(), but synchronous
+  //! will block until a reply has been received for all the commands sent and all underlying callbacks completed
+  //!
+  //! \return current instance
+  //!
+  sharded_client& sync_commit(void);
+
+  //!
+  //! same as sync_commit, but with a timeout
+  //! will simply block until it completes or timeout expires
+  //!
+  //! \return current instance
+  //!
+  template <class Rep, class Period>
+  sharded_client&
+  sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    commit();
+
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    m_pending_condvar.wait_for(lock, timeout, [=] { return m_pending == 0; });
+
+    return *this;
+  }
+
+public:
+  //!
+  //! \param key key to be looked up
+  //! \return address (host:port) of the node owning the key, throws redis_error if the ring is empty
+  //!
+  std::string get_node_for_key(const std::string& key) const;
+
+  //!
+  //! \param key key to be looked up
+  //! \return client connected to the node owning the key, to use the typed command API
+  //! the node is committed on the next commit(), but commands sent that way are not waited for by sync_commit()
+  //!
+  client& get_client_for_key(const std::string& key);
+
+  //!
+  //! \param host host of the node
+  //! \param port port of the node
+  //! \return client connected to the given node, throws redis_error if it is not part of the ring
+  //!
+  client& get_client(const std::string& host, std::size_t port);
+
+private:
+  //!
+  //! hash ring and the connections to its nodes
+  //! immutable once published: updates copy the whole state and swap it atomically, so that routing never waits for a topology change
+  //!
+  struct ring_state {
+    //! hash ring
+    hash_ring ring;
+    //! connection to each node, in the order of ring.get_nodes()
+    std::vector<std::shared_ptr<client>> clients;
+  };
+
+private:
+  //!
+  //! \param state ring state to be used
+  //! \param key key to be looked up
+  //! \return client connected to the node owning the key
+  //!
+  static const std::shared_ptr<client>& get_node_client(const ring_state& state, const std::string& key);
+
+  //!
+  //! buffer a command on the given node
+  //!
+  //! \param node connection to the node
+  //! \param redis_cmd command to be sent
+  //! \param callback callback called once the command completed
+  //!
+  void send_to_node(const std::shared_ptr<client>& node, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! split a multi-key command whose keys belong to several nodes into one command per node and merge their replies
+  //! the caller must have counted the command as pending: it is completed by the last sub-command
+  //!
+  //! \param state ring state to be used
+  //! \param redis_cmd command to be sent
+  //! \param callback user callback, called once with the merged reply
+  //! \return false if the command is not a supported multi-key command or if all its keys belong to the same node
+  //!
+  bool scatter_send(const ring_state& state, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! notify sync_commit() waiters that a command completed
+  //!
+  void command_done(void);
+
+private:
+  //!
+  //! current ring state, accessed through std::atomic_load / std::atomic_store
+  //!
+  std::shared_ptr<const ring_state> m_state;
+
+  //!
+  //! serializes ring updates (add_node / remove_node)
+  //!
+  std::mutex m_update_mutex;
+
+  //!
+  //! executor running reply callbacks, used for every node
+  //!
+  std::shared_ptr<executor_iface> m_executor;
+
+  //!
+  //! nodes that received commands since the last commit
+  //!
+  std::set<std::shared_ptr<client>> m_uncommitted_nodes;
+
+  //!
+  //! m_uncommitted_nodes thread safety
+  //!
+  std::mutex m_uncommitted_mutex;
+
+  //!
+  //! number of commands sent that did not get their reply yet
+  //!
+  std::size_t m_pending;
+
+  //!
+  //! m_pending thread safety
+  //!
+  std::mutex m_pending_mutex;
+
+  //!
+  //! condvar for m_pending updates
+  //!
+  std::condition_variable m_pending_condvar;
+};
+
+} // namespace cpp_redis
@@ -25,10 +25,15 @@
 #include <atomic>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <cpp_redis/core/sentinel.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/key_filter.hpp>
+#include <cpp_redis/network/connection_options.hpp>
 #include <cpp_redis/network/redis_connection.hpp>
 #include <cpp_redis/network/tcp_client_iface.hpp>
 
@@ -92,12 +97,13 @@ public:
   //!
   //! Connect to redis server
   //!
-  //! \param host host to be connected to
-  //! \param port port to be connected to
+  //! \param host host to be connected to, or unix:///path/to/redis.sock for a unix domain socket
+  //! \param port port to be connected to (ignored for unix domain sockets)
   //! \param connect_callback connect handler to be called on connect events (may be null)
   //! \param timeout_msecs maximum time to connect
   //! \param max_reconnects maximum attempts of reconnection if connection dropped
   //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on connection and kept for reconnections
   //!
   void connect(
     const std::string& host                    = "127.0.0.1",
@@ -105,7 +111,8 @@ public:
     const connect_callback_t& connect_callback = nullptr,
     std::uint32_t timeout_msecs                = 0,
     std::int32_t max_reconnects                = 0,
-    std::uint32_t reconnect_interval_msecs     = 0);
+    std::uint32_t reconnect_interval_msecs     = 0,
+    const network::connection_options& options = network::connection_options());
 
   //!
   //! Connect to redis server
@@ -115,13 +122,15 @@ public:
   //! \param timeout_msecs maximum time to connect
   //! \param max_reconnects maximum attempts of reconnection if connection dropped
   //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on connection and kept for reconnections
   //!
   void connect(
     const std::string& name,
     const connect_callback_t& connect_callback = nullptr,
     std::uint32_t timeout_msecs                = 0,
     std::int32_t max_reconnects                = 0,
-    std::uint32_t reconnect_interval_msecs     = 0);
+    std::uint32_t reconnect_interval_msecs     = 0,
+    const network::connection_options& options = network::connection_options());
 
   //!
   //! \return whether we are connected to the redis server
@@ -145,6 +154,16 @@ public:
   //!
   void cancel_reconnect(void);
 
+  //!
+  //! set the executor running subscribe, acknowledgement and auth callbacks
+  //! by default, callbacks run inline on the network thread that read the message
+  //! whatever the executor, callbacks run one at a time and in the order messages were received
+  //! should be called before connect()
+  //!
+  //! \param executor executor running callbacks (nullptr or an inline_executor to run them inline)
+  //!
+  void set_executor(const std::shared_ptr<executor_iface>& executor);
+
 public:
   //!
   //! reply callback called whenever a reply is received
@@ -163,6 +182,22 @@ public:
   //!
   subscriber& auth(const std::string& password, const reply_callback_t& reply_callback = nullptr);
 
+  //!
+  //! client id callback, called with the id of the connection once CLIENT ID completes
+  //!
+  typedef std::function<void(int64_t)> client_id_callback_t;
+
+  //!
+  //! retrieve the id of the subscriber connection (CLIENT ID), typically to redirect CLIENT TRACKING invalidations to it
+  //! the id is requested again on each reconnection (before re-subscribing) and callback is called with the new id
+  //! must be called before any subscribe() as the command is not allowed once the connection is in subscribe mode
+  //! The command is not effectively sent immediately but stored in an internal buffer until commit() is called.
+  //!
+  //! \param callback callback to be called with the connection id
+  //! \return current instance
+  //!
+  subscriber& client_id(const client_id_callback_t& callback);
+
   //!
   //! subscribe callback, called whenever a new message is published on a subscribed channel
   //! takes as parameter the channel and the message
@@ -201,6 +236,37 @@ public:
   //!
   subscriber& psubscribe(const std::string& pattern, const subscribe_callback_t& callback, const acknowledgement_callback_t& acknowledgement_callback = nullptr);
 
+  //!
+  //! invalidation callback, called whenever a CLIENT TRACKING invalidation message is received
+  //! takes as parameter the invalidated keys, an empty vector meaning that the whole keyspace has been flushed
+  //!
+  typedef std::function<void(const std::vector<std::string>& keys)> invalidation_callback_t;
+
+  //!
+  //! Subscribes to the __redis__:invalidate channel on which the server publishes CLIENT TRACKING invalidations redirected to this connection and:
+  //!  * calls acknowledgement_callback once the server has acknowledged about the subscription.
+  //!  * calls callback each time an invalidation message is received.
+  //! The command is not effectively sent immediately but stored in an internal buffer until commit() is called.
+  //!
+  //! \param callback callback to be called whenever keys are invalidated
+  //! \param acknowledgement_callback callback to be called on subscription completion (nullable)
+  //! \return current instance
+  //!
+  subscriber& subscribe_invalidations(const invalidation_callback_t& callback, const acknowledgement_callback_t& acknowledgement_callback = nullptr);
+
+  //!
+  //! Psubscribes to the keyspace events (__keyevent@<db>__:*) of a database and adds the keys they report to the given filter, so that the keys created by other clients are not reported as missing by the filter.
+  //! Requires keyspace events to be enabled on the server (notify-keyspace-events containing at least E and A, or the classes of the keys to be filtered).
+  //! Keys created while the subscriber is disconnected are missed: the filter should then be marked as not ready, and populated again once reconnected.
+  //! The command is not effectively sent immediately but stored in an internal buffer until commit() is called.
+  //!
+  //! \param filter filter to be kept up to date
+  //! \param db database whose events are received
+  //! \param acknowledgement_callback callback to be called on subscription completion (nullable)
+  //! \return current instance
+  //!
+  subscriber& subscribe_key_events(const std::shared_ptr<key_filter>& filter, int db = 0, const acknowledgement_callback_t& acknowledgement_callback = nullptr);
+
   //!
   //! unsubscribe from the given channel
   //! The command is not effectively sent immediately, but stored inside an internal buffer until commit() is called.
@@ -259,11 +325,12 @@ public:
 
 private:
   //!
-  //! struct to hold callbacks (sub and ack) for a given channel or pattern
+  //! struct to hold callbacks (sub, ack and invalidation for the invalidation channel) for a given channel or pattern
   //!
   struct callback_holder {
     subscribe_callback_t subscribe_callback;
     acknowledgement_callback_t acknowledgement_callback;
+    invalidation_callback_t invalidation_callback;
   };
 
 private:
@@ -275,6 +342,13 @@ private:
   //!
   void connection_receive_handler(network::redis_connection& connection, reply& reply);
 
+  //!
+  //! dispatch a received reply to the matching auth, acknowledgement or subscribe callback
+  //!
+  //! \param reply parsed reply
+  //!
+  void handle_reply(reply& reply);
+
   //!
   //! redis_connection disconnection handler, triggered whenever a disconnection occurred
   //!
@@ -328,6 +402,11 @@ private:
   //!
   void re_auth(void);
 
+  //!
+  //! request the connection id again if client_id() has been called, the id changes on each reconnection
+  //!
+  void re_client_id(void);
+
   //!
   //! resubscribe (sub and psub) to previously subscribed channels/patterns
   //!
@@ -414,6 +493,11 @@ private:
   //!
   std::uint32_t m_reconnect_interval_msecs = 0;
 
+  //!
+  //! socket options, kept for reconnections
+  //!
+  network::connection_options m_connection_options;
+
   //!
   //! reconnection status
   //!
@@ -450,6 +534,15 @@ private:
   //! auth reply callback
   //!
   reply_callback_t m_auth_reply_callback;
+
+  //!
+  //! client id callback (kept to request the new id on reconnection)
+  //!
+  client_id_callback_t m_client_id_callback;
+  //!
+  //! executor running callbacks in order (nullptr to run them inline)
+  //!
+  std::shared_ptr<serial_executor> m_callbacks_executor;
 };
 
 } // namespace cpp_redis
@@ -0,0 +1,401 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/core/subscriber.hpp>
+
+namespace cpp_redis {
+
+//!
+//! client caching GET, HGET and HGETALL replies locally, kept coherent by the server through CLIENT TRACKING (redis >= 6)
+//! tracking is redirected to a dedicated subscriber connection listening on __redis__:invalidate: the server publishes there the keys read through this client whenever they are modified (or, in broadcasting mode, any key matching the given prefixes)
+//! cached reads are served without any round trip and their callback is called immediately, in the calling thread
+//! the cache is bypassed while the invalidation connection is not ready, during transactions and for keys not matching the broadcasting prefixes, and flushed whenever one of the two connections is lost
+//! writes sent through this client evict their keys locally right away, writes sent through get_client() are only evicted once their invalidation is received
+//!
+class tracking_client {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param max_bytes approximate memory bound of the cache, least recently used keys are evicted beyond it
+  //!
+  explicit tracking_client(std::size_t max_bytes = 64 * 1024 * 1024);
+
+  //! dtor
+  ~tracking_client(void);
+
+  //! copy ctor
+  tracking_client(const tracking_client&) = delete;
+  //! assignment operator
+  tracking_client& operator=(const tracking_client&) = delete;
+
+public:
+  //!
+  //! reply callback called whenever a reply is received
+  //! takes as parameter the received reply
+  //!
+  typedef client::reply_callback_t reply_callback_t;
+
+  //!
+  //! cache statistics
+  //!
+  struct cache_stats {
+    //! reads served from the cache
+    std::uint64_t hits;
+    //! cacheable reads sent to the server
+    std::uint64_t misses;
+    //! keys evicted by an invalidation message or a local write
+    std::uint64_t invalidations;
+    //! keys evicted to honor the memory bound
+    std::uint64_t evictions;
+    //! number of cached keys
+    std::size_t keys;
+    //! approximate memory used by the cached replies
+    std::size_t bytes;
+  };
+
+public:
+  //!
+  //! switch to the broadcasting mode (CLIENT TRACKING BCAST): invalidations are received for all the keys matching one of the prefixes, whether they have been read or not
+  //! only keys matching one of the prefixes are then cached
+  //! should be called before connect()
+  //!
+  //! \param prefixes key prefixes to be tracked, empty to go back to the default mode (only the keys read through this client are tracked)
+  //!
+  void set_bcast_prefixes(const std::vector<std::string>& prefixes);
+
+  //!
+  //! set the password used to authenticate both connections
+  //! should be called before connect()
+  //!
+  //! \param password password to be used for authentication
+  //!
+  void set_password(const std::string& password);
+
+  //!
+  //! connect the client and the invalidation connection to the redis server
+  //!
+  //! \param host host to be connected to
+  //! \param port port to be connected to
+  //! \param connect_callback connect handler to be called on connect events of the client (may be null)
+  //! \param timeout_msecs maximum time to connect
+  //! \param max_reconnects maximum attempts of reconnection if connection dropped
+  //! \param reconnect_interval_msecs time between two attempts of reconnection
+  //! \param options socket options applied on connection and kept for reconnections
+  //!
+  void connect(
+    const std::string& host                            = "127.0.0.1",
+    std::size_t port                                   = 6379,
+    const client::connect_callback_t& connect_callback = nullptr,
+    std::uint32_t timeout_msecs                        = 0,
+    std::int32_t max_reconnects                        = 0,
+    std::uint32_t reconnect_interval_msecs             = 0,
+    const network::connection_options& options         = network::connection_options());
+
+  //!
+  //! \return whether both connections are established
+  //!
+  bool is_connected(void) const;
+
+  //!
+  //! disconnect both connections and flush the cache
+  //!
+  //! \param wait_for_removal when sets to true, disconnect blocks until the underlying TCP clients have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void disconnect(bool wait_for_removal = false);
+
+  //!
+  //! \return underlying client, to send commands bypassing the cache
+  //!
+  client& get_client(void);
+
+public:
+  //!
+  //! send the given command
+  //! GET, HGET and HGETALL are served from the cache when possible, other commands evict their keys from the cache and are forwarded to the underlying client
+  //! the command is only buffered, please call commit() / sync_commit() to flush the buffer
+  //!
+  //! \param redis_cmd command to be sent
+  //! \param callback callback to be called on received reply
+  //! \return current instance
+  //!
+  tracking_client& send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback);
+
+  //!
+  //! same as the other send method
+  //! but future based: does not take any callback and return an std::future to handle the reply
+  //!
+  //! \param redis_cmd command to be sent
+  //! \return std::future to handler redis reply
+  //!
+  std::future<reply> send(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! cached GET
+  //!
+  tracking_client& get(const std::string& key, const reply_callback_t& reply_callback);
+  std::future<reply> get(const std::string& key);
+
+  //!
+  //! cached HGET
+  //!
+  tracking_client& hget(const std::string& key, const std::string& field, const reply_callback_t& reply_callback);
+  std::future<reply> hget(const std::string& key, const std::string& field);
+
+  //!
+  //! cached HGETALL
+  //!
+  tracking_client& hgetall(const std::string& key, const reply_callback_t& reply_callback);
+  std::future<reply> hgetall(const std::string& key);
+
+  //!
+  //! send the buffered commands
+  //!
+  //! \return current instance
+  //!
+  tracking_client& commit(void);
+
+  //!
+  //! same as commit(), but synchronous
+  //!
+  //! \return current instance
+  //!
+  tracking_client& sync_commit(void);
+
+  //!
+  //! same as sync_commit, but with a timeout
+  //! will simply block until it completes or timeout expires
+  //!
+  //! \return current instance
+  //!
+  template <class Rep, class Period>
+  tracking_client&
+  sync_commit(const std::chrono::duration<Rep, Period>& timeout) {
+    m_client.sync_commit(timeout);
+
+    return *this;
+  }
+
+public:
+  //!
+  //! \return cache statistics
+  //!
+  cache_stats get_stats(void);
+
+  //!
+  //! flush the cache
+  //!
+  void clear(void);
+
+private:
+  //!
+  //! cached reply of a given read on a key (or the placeholder of a read in flight)
+  //!
+  struct cached_reply {
+    //! cached reply
+    reply value;
+    //! identifies the read filling the entry
+    std::uint64_t fill_id;
+    //! whether value has been received
+    bool filled;
+    //! approximate size of the entry
+    std::size_t bytes;
+  };
+
+  //!
+  //! cached replies of a key
+  //!
+  struct cache_entry {
+    //! replies by read (GET, HGETALL, HGET <field>)
+    std::map<std::string, cached_reply> replies;
+    //! position of the key in m_lru
+    std::list<std::string>::iterator lru_position;
+  };
+
+private:
+  //!
+  //! \param redis_cmd command
+  //! \param key set to the key read by the command
+  //! \param signature set to the read identifier within the key entry
+  //! \return whether the command is a cacheable read (GET, HGET, HGETALL)
+  //!
+  static bool get_cacheable_read(const std::vector<std::string>& redis_cmd, std::string& key, std::string& signature);
+
+  //!
+  //! \return whether key may be cached given the current state of the connections and the tracking mode
+  //!
+  bool is_cacheable_key(const std::string& key) const;
+
+  //!
+  //! look the given read up, and register a placeholder for it on a miss
+  //!
+  //! \return whether the read is a hit (value is then set), fill_id is set to the id of the placeholder otherwise
+  //!
+  bool lookup(const std::string& key, const std::string& signature, reply& value, std::uint64_t& fill_id);
+
+  //!
+  //! store the reply of a read in its placeholder, unless the key has been invalidated or the connections changed meanwhile
+  //! the placeholder is dropped when the reply is not stored
+  //!
+  //! \param tracked whether the read has been sent on a tracked connection
+  //!
+  void fill(const std::string& key, const std::string& signature, std::uint64_t fill_id, std::uint64_t epoch, bool tracked, const reply& value);
+
+  //!
+  //! evict a key, m_cache_mutex must be held
+  //!
+  //! \return whether the key was cached
+  //!
+  bool unprotected_evict(const std::string& key);
+
+  //!
+  //! evict the keys of a write sent through this client
+  //!
+  void evict_command_keys(const std::vector<std::string>& redis_cmd);
+
+  //!
+  //! invalidation handler of the subscriber connection
+  //!
+  void on_invalidation(const std::vector<std::string>& keys);
+
+  //!
+  //! flush the cache and require tracking to be enabled again before caching anything (connection changes)
+  //!
+  void reset_tracking(void);
+
+  //!
+  //! buffer CLIENT TRACKING on the client if needed, m_tracking_mutex must be held
+  //!
+  //! \param redirect_id id of the invalidation connection
+  //!
+  void unprotected_enable_tracking(std::int64_t redirect_id);
+
+private:
+  //!
+  //! cache memory bound
+  //!
+  std::size_t m_max_bytes;
+
+  //!
+  //! broadcasting prefixes (empty for the default tracking mode)
+  //!
+  std::vector<std::string> m_bcast_prefixes;
+
+  //!
+  //! password of both connections
+  //!
+  std::string m_password;
+
+  //!
+  //! cached keys
+  //!
+  std::unordered_map<std::string, cache_entry> m_entries;
+
+  //!
+  //! cached keys, most recently used first
+  //!
+  std::list<std::string> m_lru;
+
+  //!
+  //! approximate memory used by the cache
+  //!
+  std::size_t m_bytes = 0;
+
+  //!
+  //! id of the next placeholder
+  //!
+  std::uint64_t m_next_fill_id = 0;
+
+  //!
+  //! m_entries, m_lru, m_bytes and m_next_fill_id thread safety
+  //!
+  std::mutex m_cache_mutex;
+
+  //!
+  //! incremented whenever the cache is flushed following a connection change: reads sent before are not cached
+  //!
+  std::atomic<std::uint64_t> m_epoch;
+
+  //!
+  //! id of the invalidation connection, -1 while it is not subscribed to the invalidations
+  //!
+  std::atomic<std::int64_t> m_redirect_id;
+
+  //!
+  //! id received by the invalidation connection, published in m_redirect_id once subscribed
+  //!
+  std::atomic<std::int64_t> m_pending_redirect_id;
+
+  //!
+  //! whether CLIENT TRACKING has been buffered on the current client connection for the current redirect id
+  //!
+  std::atomic_bool m_tracking_enabled;
+
+  //!
+  //! whether the server rejected CLIENT TRACKING (cache disabled until the next connect())
+  //!
+  std::atomic_bool m_tracking_rejected;
+
+  //!
+  //! whether a MULTI is in progress (reads return QUEUED and must not be cached)
+  //!
+  std::atomic_bool m_in_transaction;
+
+  //!
+  //! keeps CLIENT TRACKING ordered before the reads relying on it
+  //!
+  std::mutex m_tracking_mutex;
+
+  //!
+  //! statistics
+  //!
+  std::atomic<std::uint64_t> m_hits;
+  std::atomic<std::uint64_t> m_misses;
+  std::atomic<std::uint64_t> m_invalidations;
+  std::atomic<std::uint64_t> m_evictions;
+
+  //!
+  //! client connection, declared after the cache as its callbacks access it
+  //!
+  client m_client;
+
+  //!
+  //! invalidation connection
+  //!
+  subscriber m_subscriber;
+};
+
+} // namespace cpp_redis
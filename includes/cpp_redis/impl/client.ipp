@@ -128,4 +128,185 @@ client::client_kill_future(const T arg, const Ts... args) {
     arg, args..., std::placeholders::_1));
 }
 
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::decrby(const std::string& key, T val, const reply_callback_t& reply_callback) {
+  send({"DECRBY", key, to_redis_string(val)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::decrby(const std::string& key, T val) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return decrby(key, val, cb); });
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::expire(const std::string& key, T seconds, const reply_callback_t& reply_callback) {
+  send({"EXPIRE", key, to_redis_string(seconds)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::expire(const std::string& key, T seconds) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return expire(key, seconds, cb); });
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::expireat(const std::string& key, T timestamp, const reply_callback_t& reply_callback) {
+  send({"EXPIREAT", key, to_redis_string(timestamp)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::expireat(const std::string& key, T timestamp) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return expireat(key, timestamp, cb); });
+}
+
+template <typename T>
+typename std::enable_if<!std::is_convertible<T, std::string>::value, client&>::type
+client::getset(const std::string& key, const T& val, const reply_callback_t& reply_callback) {
+  return getset(key, to_redis_string(val), reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_convertible<T, std::string>::value, std::future<reply>>::type
+client::getset(const std::string& key, const T& val) {
+  return getset(key, to_redis_string(val));
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::hincrby(const std::string& key, const std::string& field, T incr, const reply_callback_t& reply_callback) {
+  send({"HINCRBY", key, field, to_redis_string(incr)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::hincrby(const std::string& key, const std::string& field, T incr) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return hincrby(key, field, incr, cb); });
+}
+
+template <typename T>
+typename std::enable_if<!std::is_convertible<T, std::string>::value, client&>::type
+client::hset(const std::string& key, const std::string& field, const T& value, const reply_callback_t& reply_callback) {
+  return hset(key, field, to_redis_string(value), reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_convertible<T, std::string>::value, std::future<reply>>::type
+client::hset(const std::string& key, const std::string& field, const T& value) {
+  return hset(key, field, to_redis_string(value));
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::incrby(const std::string& key, T incr, const reply_callback_t& reply_callback) {
+  send({"INCRBY", key, to_redis_string(incr)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::incrby(const std::string& key, T incr) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return incrby(key, incr, cb); });
+}
+
+template <typename T>
+typename std::enable_if<!std::is_same<T, std::string>::value, client&>::type
+client::lpush(const std::string& key, const std::vector<T>& values, const reply_callback_t& reply_callback) {
+  return lpush(key, to_redis_strings(values), reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_same<T, std::string>::value, std::future<reply>>::type
+client::lpush(const std::string& key, const std::vector<T>& values) {
+  return lpush(key, to_redis_strings(values));
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::pexpire(const std::string& key, T milliseconds, const reply_callback_t& reply_callback) {
+  send({"PEXPIRE", key, to_redis_string(milliseconds)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::pexpire(const std::string& key, T milliseconds) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return pexpire(key, milliseconds, cb); });
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, client&>::type
+client::pexpireat(const std::string& key, T milliseconds_timestamp, const reply_callback_t& reply_callback) {
+  send({"PEXPIREAT", key, to_redis_string(milliseconds_timestamp)}, reply_callback);
+  return *this;
+}
+
+template <typename T>
+typename std::enable_if<is_wide_integer<T>::value, std::future<reply>>::type
+client::pexpireat(const std::string& key, T milliseconds_timestamp) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return pexpireat(key, milliseconds_timestamp, cb); });
+}
+
+template <typename T>
+typename std::enable_if<!std::is_same<T, std::string>::value, client&>::type
+client::rpush(const std::string& key, const std::vector<T>& values, const reply_callback_t& reply_callback) {
+  return rpush(key, to_redis_strings(values), reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_same<T, std::string>::value, std::future<reply>>::type
+client::rpush(const std::string& key, const std::vector<T>& values) {
+  return rpush(key, to_redis_strings(values));
+}
+
+template <typename T>
+typename std::enable_if<!std::is_same<T, std::string>::value, client&>::type
+client::sadd(const std::string& key, const std::vector<T>& members, const reply_callback_t& reply_callback) {
+  return sadd(key, to_redis_strings(members), reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_same<T, std::string>::value, std::future<reply>>::type
+client::sadd(const std::string& key, const std::vector<T>& members) {
+  return sadd(key, to_redis_strings(members));
+}
+
+template <typename T>
+typename std::enable_if<!std::is_convertible<T, std::string>::value, client&>::type
+client::set(const std::string& key, const T& value, const reply_callback_t& reply_callback) {
+  return set(key, to_redis_string(value), reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_convertible<T, std::string>::value, std::future<reply>>::type
+client::set(const std::string& key, const T& value) {
+  return set(key, to_redis_string(value));
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, client&>::type
+client::zadd(const std::string& key, const std::vector<std::string>& options, const std::multimap<T, std::string>& score_members, const reply_callback_t& reply_callback) {
+  std::multimap<std::string, std::string> members;
+
+  for (const auto& sm : score_members) {
+    members.emplace(to_redis_string(sm.first), sm.second);
+  }
+
+  return zadd(key, options, members, reply_callback);
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::future<reply>>::type
+client::zadd(const std::string& key, const std::vector<std::string>& options, const std::multimap<T, std::string>& score_members) {
+  return exec_cmd([=](const reply_callback_t& cb) -> client& { return zadd(key, options, score_members, cb); });
+}
+
 } // namespace cpp_redis
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace cpp_redis {
+
+//!
+//! interface defining how values are compressed by client::set_codec()
+//! values are stored as the magic of the codec followed by the compressed data, so that reads recognize them
+//!
+class codec_iface {
+public:
+  //! ctor
+  codec_iface(void) = default;
+  //! dtor
+  virtual ~codec_iface(void) = default;
+
+public:
+  //!
+  //! \return prefix tagging the values compressed by this codec, which uncompressed values are very unlikely to start with
+  //!
+  virtual const std::string& get_magic(void) const = 0;
+
+  //!
+  //! compress a value
+  //!
+  //! \param input value to be compressed
+  //! \param output set to the compressed data (without magic)
+  //!
+  virtual void compress(const std::string& input, std::string& output) const = 0;
+
+  //!
+  //! decompress a value
+  //! throws redis_error if the data is corrupted
+  //!
+  //! \param input compressed data (without magic)
+  //! \param size size of the compressed data
+  //! \param output set to the value
+  //!
+  virtual void decompress(const char* input, std::size_t size, std::string& output) const = 0;
+};
+
+} // namespace cpp_redis
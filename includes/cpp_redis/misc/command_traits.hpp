@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace cpp_redis {
+
+//!
+//! \param command_name name of a redis command, case insensitive
+//! \return whether the command only reads data (and can therefore be served by a replica)
+//!
+bool is_read_only_command(const std::string& command_name);
+
+//!
+//! \param redis_cmd redis command
+//! \return whether the command only reads data (and can therefore be served by a replica)
+//!
+bool is_read_only_command(const std::vector<std::string>& redis_cmd);
+
+//!
+//! WAIT is not considered blocking: it waits for the replication of the writes of the connection it is sent on, and must therefore share the connection of these writes
+//!
+//! \param redis_cmd redis command
+//! \return whether the command may block its connection until some data is available (BLPOP, BRPOP, BRPOPLPUSH, BZPOPMIN, BZPOPMAX, XREAD and XREADGROUP with BLOCK)
+//!
+bool is_blocking_command(const std::vector<std::string>& redis_cmd);
+
+//!
+//! \param redis_cmd redis command
+//! \return whether the command changes the state of its connection (SELECT, AUTH, MULTI, WATCH, SUBSCRIBE, CLIENT REPLY, ...) and would therefore affect the other users of a shared connection
+//!
+bool is_connection_state_command(const std::vector<std::string>& redis_cmd);
+
+//!
+//! find the first key of a command, used to route it to the node owning that key
+//! keys are usually the first argument, with a few exceptions (EVAL, XREAD, BITOP, subcommands, ...)
+//!
+//! \param redis_cmd redis command
+//! \param key set to the first key of the command
+//! \return false if the command has no key
+//!
+bool get_command_key(const std::vector<std::string>& redis_cmd, std::string& key);
+
+} // namespace cpp_redis
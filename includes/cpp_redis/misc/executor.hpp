@@ -0,0 +1,308 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace cpp_redis {
+
+//!
+//! executor_iface
+//! should be inherited by any class intended to be used to run callbacks (reply callbacks, subscribe callbacks, ...)
+//!
+class executor_iface {
+public:
+  //! ctor
+  executor_iface(void) = default;
+  //! dtor
+  virtual ~executor_iface(void) = default;
+
+  //! copy ctor
+  executor_iface(const executor_iface&) = delete;
+  //! assignment operator
+  executor_iface& operator=(const executor_iface&) = delete;
+
+public:
+  //!
+  //! task to be executed
+  //!
+  typedef std::function<void()> task_t;
+
+  //!
+  //! schedule the execution of the given task
+  //! no ordering is required between two tasks: cpp_redis wraps executors into a serial_executor whenever ordering matters
+  //!
+  //! \param task task to be executed
+  //!
+  virtual void execute(const task_t& task) = 0;
+};
+
+//!
+//! executor running tasks right away, in the calling thread
+//!
+class inline_executor : public executor_iface {
+public:
+  //! ctor
+  inline_executor(void) = default;
+  //! dtor
+  ~inline_executor(void) = default;
+
+public:
+  //!
+  //! run the given task
+  //!
+  //! \param task task to be executed
+  //!
+  void execute(const task_t& task);
+};
+
+//!
+//! executor running tasks on a fixed pool of threads
+//! a pool of 1 thread is a dedicated thread
+//!
+class thread_pool_executor : public executor_iface {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param nb_threads number of threads of the pool
+  //!
+  explicit thread_pool_executor(std::size_t nb_threads = 1);
+
+  //!
+  //! dtor
+  //! runs the remaining tasks and joins the threads
+  //!
+  ~thread_pool_executor(void);
+
+public:
+  //!
+  //! queue the given task for execution by one of the pool threads
+  //!
+  //! \param task task to be executed
+  //!
+  void execute(const task_t& task);
+
+private:
+  //!
+  //! pool threads main loop
+  //!
+  void run(void);
+
+private:
+  //!
+  //! pool threads
+  //!
+  std::vector<std::thread> m_threads;
+
+  //!
+  //! tasks waiting to be executed
+  //!
+  std::queue<task_t> m_tasks;
+
+  //!
+  //! whether the pool is being destroyed
+  //!
+  bool m_stop;
+
+  //!
+  //! tasks queue thread safety
+  //!
+  std::mutex m_tasks_mutex;
+
+  //!
+  //! condvar for tasks queue updates
+  //!
+  std::condition_variable m_tasks_condvar;
+};
+
+//!
+//! executor running tasks on a dedicated thread, right away or after a delay
+//!
+class timer_executor : public executor_iface {
+public:
+  //! ctor
+  timer_executor(void);
+
+  //!
+  //! dtor
+  //! joins the thread, tasks whose delay did not expire yet are discarded
+  //!
+  ~timer_executor(void);
+
+public:
+  //!
+  //! queue the given task for immediate execution
+  //!
+  //! \param task task to be executed
+  //!
+  void execute(const task_t& task);
+
+  //!
+  //! queue the given task for execution once the delay expired
+  //! tasks due at the same time run in the order they were queued
+  //!
+  //! \param delay time to wait before running the task
+  //! \param task task to be executed
+  //!
+  void execute_after(std::chrono::steady_clock::duration delay, const task_t& task);
+
+private:
+  //!
+  //! thread main loop
+  //!
+  void run(void);
+
+private:
+  //!
+  //! task waiting for its deadline
+  //!
+  struct timed_task {
+    std::chrono::steady_clock::time_point deadline;
+    std::uint64_t sequence;
+    task_t task;
+
+    //! ordering of the queue: earliest deadline on top
+    bool
+    operator<(const timed_task& other) const {
+      return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+    }
+  };
+
+private:
+  //!
+  //! tasks waiting to be executed, earliest deadline first
+  //!
+  std::priority_queue<timed_task> m_tasks;
+
+  //!
+  //! number of tasks queued so far, used to keep the queuing order of tasks with the same deadline
+  //!
+  std::uint64_t m_sequence;
+
+  //!
+  //! whether the executor is being destroyed
+  //!
+  bool m_stop;
+
+  //!
+  //! tasks queue thread safety
+  //!
+  std::mutex m_tasks_mutex;
+
+  //!
+  //! condvar for tasks queue updates
+  //!
+  std::condition_variable m_tasks_condvar;
+
+  //!
+  //! thread running the tasks, started last
+  //!
+  std::thread m_thread;
+};
+
+//!
+//! executor adaptor running the tasks given to it one at a time and in order, on top of any other executor
+//! typically used to run the callbacks of a given connection on a shared pool without reordering them
+//!
+class serial_executor : public executor_iface {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param executor underlying executor running the tasks
+  //!
+  explicit serial_executor(const std::shared_ptr<executor_iface>& executor);
+
+  //! dtor
+  ~serial_executor(void) = default;
+
+public:
+  //!
+  //! queue the given task, to be executed after all the previously queued ones have completed
+  //!
+  //! \param task task to be executed
+  //!
+  void execute(const task_t& task);
+
+  //!
+  //! block until all the queued tasks have been executed
+  //! must not be called from one of these tasks
+  //!
+  void wait(void);
+
+private:
+  //!
+  //! state shared with the tasks scheduled on the underlying executor, so that it outlives the serial_executor if needed
+  //!
+  struct state {
+    std::queue<task_t> tasks;
+    bool running = false;
+    std::mutex mutex;
+    std::condition_variable condvar;
+  };
+
+  //!
+  //! execute queued tasks until the queue is empty
+  //!
+  //! \param state state holding the queued tasks
+  //!
+  static void drain(const std::shared_ptr<state>& state);
+
+private:
+  //!
+  //! underlying executor
+  //!
+  std::shared_ptr<executor_iface> m_executor;
+
+  //!
+  //! queued tasks
+  //!
+  std::shared_ptr<state> m_state;
+};
+
+//!
+//! run a task in the calling thread, logging the exceptions it throws instead of propagating them
+//! used by the executors and to run user callbacks whose completion must be accounted for even if they throw
+//!
+//! \param task task to be executed
+//!
+void run_task(const executor_iface::task_t& task);
+
+//!
+//! executor running tasks on a single background thread, created on first use
+//! used internally whenever callbacks can not be run in the calling thread (for example to fail pending callbacks from a disconnection handler)
+//!
+//! \return background executor
+//!
+const std::shared_ptr<executor_iface>& get_background_executor(void);
+
+} // namespace cpp_redis
@@ -0,0 +1,125 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cpp_redis {
+
+//!
+//! consistent hash ring (ketama style) mapping keys to nodes
+//! each node is placed at several points (virtual nodes) of a 64 bits ring and a key belongs to the first point following its hash
+//! adding or removing one node out of N therefore only remaps about 1/N of the keys
+//!
+class hash_ring {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param nb_virtual_nodes number of points per node (and per unit of weight), the higher the more even the distribution
+  //!
+  explicit hash_ring(std::size_t nb_virtual_nodes = 160);
+
+  //! dtor
+  ~hash_ring(void) = default;
+
+  //! copy ctor
+  hash_ring(const hash_ring&) = default;
+  //! assignment operator
+  hash_ring& operator=(const hash_ring&) = default;
+
+public:
+  //!
+  //! add a node to the ring (no-op if it is already part of it)
+  //!
+  //! \param node node name, typically host:port
+  //! \param weight relative share of the keys the node should get
+  //!
+  void add_node(const std::string& node, std::size_t weight = 1);
+
+  //!
+  //! remove a node from the ring (no-op if it is not part of it)
+  //!
+  //! \param node node name
+  //!
+  void remove_node(const std::string& node);
+
+  //!
+  //! \param key key to be looked up
+  //! \return node owning the key, throws redis_error if the ring is empty
+  //!
+  const std::string& get_node(const std::string& key) const;
+
+  //!
+  //! \param key key to be looked up
+  //! \return index of the node owning the key in get_nodes(), throws redis_error if the ring is empty
+  //!
+  std::size_t get_node_index(const std::string& key) const;
+
+  //!
+  //! \return nodes of the ring
+  //!
+  const std::vector<std::string>& get_nodes(void) const;
+
+  //!
+  //! 64 bits hash used to place nodes and keys on the ring (FNV-1a followed by a splitmix64 finalizer)
+  //!
+  //! \param buffer data to be hashed
+  //! \param size size of the data
+  //! \return hash
+  //!
+  static std::uint64_t hash(const char* buffer, std::size_t size);
+
+private:
+  //!
+  //! rebuild m_points from m_nodes
+  //!
+  void build(void);
+
+private:
+  //!
+  //! number of points per node and per unit of weight
+  //!
+  std::size_t m_nb_virtual_nodes;
+
+  //!
+  //! nodes of the ring
+  //!
+  std::vector<std::string> m_nodes;
+
+  //!
+  //! weight of each node
+  //!
+  std::vector<std::size_t> m_weights;
+
+  //!
+  //! points of the ring (hash, node index), sorted by hash
+  //!
+  std::vector<std::pair<std::uint64_t, std::size_t>> m_points;
+};
+
+} // namespace cpp_redis
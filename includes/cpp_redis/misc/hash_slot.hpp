@@ -0,0 +1,54 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//!
+//! number of hash slots of a redis cluster
+//!
+#define __CPP_REDIS_CLUSTER_SLOTS 16384
+
+namespace cpp_redis {
+
+//!
+//! CRC16 (XMODEM variant) as used by redis cluster to map keys to hash slots
+//!
+//! \param buffer data to be hashed
+//! \param size size of the data
+//! \return checksum
+//!
+std::uint16_t crc16(const char* buffer, std::size_t size);
+
+//!
+//! compute the cluster hash slot of a key, the same way redis-server does
+//! if the key contains a non empty hash tag ({...}), only the hash tag is hashed so that related keys can be stored in the same slot
+//!
+//! \param key key to be hashed
+//! \return hash slot, in [0, __CPP_REDIS_CLUSTER_SLOTS)
+//!
+std::uint16_t hash_slot(const std::string& key);
+
+} // namespace cpp_redis
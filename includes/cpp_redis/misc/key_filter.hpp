@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace cpp_redis {
+
+//!
+//! client-side negative lookup filter: a blocked bloom filter of the keys that may exist in a database
+//! a key the filter has never seen definitely does not exist (as long as all the key creations are added), so that reading it needs no round trip
+//! all the bits a key sets live in the same 64 bytes block: a lookup touches a single cache line
+//! a filter is not ready until it has been populated (see client::bootstrap_key_filter()): until then every key may exist
+//! keys can not be removed, deleted keys simply remain false positives until the filter is populated again
+//!
+class key_filter {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param max_bytes memory budget of the filter (rounded down to 64 bytes blocks, 1 block at least)
+  //! \param false_positive_rate target false positive rate, which determines the number of bits set per key and the number of keys the budget can hold at that rate
+  //!
+  explicit key_filter(std::size_t max_bytes, double false_positive_rate = 0.01);
+
+  //! dtor
+  ~key_filter(void) = default;
+
+  //! copy ctor
+  key_filter(const key_filter&) = delete;
+  //! assignment operator
+  key_filter& operator=(const key_filter&) = delete;
+
+public:
+  //!
+  //! filter statistics
+  //!
+  struct filter_stats {
+    //! keys added (a key added twice is counted twice)
+    std::uint64_t additions;
+    //! lookups of keys that may exist
+    std::uint64_t positives;
+    //! lookups of keys that definitely do not exist
+    std::uint64_t negatives;
+    //! number of keys the filter holds at its target false positive rate
+    std::size_t capacity;
+    //! memory used by the filter
+    std::size_t bytes;
+  };
+
+public:
+  //!
+  //! record a key that may exist
+  //!
+  //! \param key key to be added
+  //!
+  void add(const std::string& key);
+
+  //!
+  //! \param key key to be looked up
+  //! \return false if the key definitely does not exist, true if it may exist or if the filter is not ready
+  //!
+  bool may_exist(const std::string& key);
+
+  //!
+  //! forget all the keys and mark the filter as not ready, before populating it again
+  //!
+  void clear(void);
+
+  //!
+  //! mark the filter as ready (populated), or as not ready when keys may have been missed (lost keyspace notifications, database change, ...)
+  //!
+  //! \param ready whether lookups may report keys as not existing
+  //!
+  void set_ready(bool ready);
+
+  //!
+  //! \return whether lookups may report keys as not existing
+  //!
+  bool is_ready(void) const;
+
+  //!
+  //! \return filter statistics
+  //!
+  filter_stats get_stats(void) const;
+
+private:
+  //!
+  //! locate the block of a key
+  //!
+  //! \param key key to be located
+  //! \param bits set to the hash giving the positions of the bits of the key in the block
+  //! \return index of the first word of the block
+  //!
+  std::size_t locate(const std::string& key, std::uint64_t& bits) const;
+
+private:
+  //!
+  //! number of 64 bytes blocks
+  //!
+  std::size_t m_nb_blocks;
+
+  //!
+  //! number of bits set per key
+  //!
+  std::size_t m_nb_hashes;
+
+  //!
+  //! number of keys held at the target false positive rate
+  //!
+  std::size_t m_capacity;
+
+  //!
+  //! bits of the blocks, 8 words per block
+  //!
+  std::unique_ptr<std::atomic<std::uint64_t>[]> m_words;
+
+  //!
+  //! whether the filter has been populated
+  //!
+  std::atomic_bool m_ready;
+
+  //!
+  //! statistics
+  //!
+  std::atomic<std::uint64_t> m_additions;
+  std::atomic<std::uint64_t> m_positives;
+  std::atomic<std::uint64_t> m_negatives;
+};
+
+} // namespace cpp_redis
@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <cpp_redis/misc/codec_iface.hpp>
+
+namespace cpp_redis {
+
+//!
+//! codec producing LZ4 blocks (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), preceded by the size of the value (LEB128 varint)
+//! the compressor is a greedy single pass matcher (hash table of 4 bytes sequences, 64KB window) skipping faster over incompressible data, favoring speed over ratio
+//!
+class lz4_codec : public codec_iface {
+public:
+  //! ctor
+  lz4_codec(void) = default;
+  //! dtor
+  ~lz4_codec(void) = default;
+
+public:
+  //!
+  //! \return "\0LZ4"
+  //!
+  const std::string& get_magic(void) const;
+
+  //!
+  //! compress a value
+  //!
+  //! \param input value to be compressed
+  //! \param output set to the compressed data (without magic)
+  //!
+  void compress(const std::string& input, std::string& output) const;
+
+  //!
+  //! decompress a value
+  //! throws redis_error if the data is corrupted
+  //!
+  //! \param input compressed data (without magic)
+  //! \param size size of the compressed data
+  //! \param output set to the value
+  //!
+  void decompress(const char* input, std::size_t size, std::string& output) const;
+};
+
+} // namespace cpp_redis
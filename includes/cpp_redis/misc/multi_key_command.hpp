@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/reply.hpp>
+
+namespace cpp_redis {
+
+//!
+//! part of a multi-key command split over several nodes
+//!
+struct multi_key_command_part {
+  //! command restricted to the keys of the part
+  std::vector<std::string> command;
+  //! position of these keys in the original command
+  std::vector<std::size_t> indexes;
+};
+
+//!
+//! split a multi-key command (MGET, MSET, DEL, EXISTS, TOUCH, UNLINK) according to the group (slot, node, ...) of each of its keys
+//!
+//! \param redis_cmd command to be split
+//! \param get_group returns the group of a key
+//! \return parts of the command, by group (empty if the command is not a supported multi-key command)
+//!
+std::map<std::size_t, multi_key_command_part> split_multi_key_command(const std::vector<std::string>& redis_cmd, const std::function<std::size_t(const std::string&)>& get_group);
+
+//!
+//! merge the replies of the parts of a split multi-key command into the reply the whole command would have received
+//!  * MGET: values in the original key order
+//!  * MSET: OK
+//!  * DEL, EXISTS, TOUCH, UNLINK: sum of the counts
+//!  * the first error reply wins
+//!
+class multi_key_reply_merger {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param redis_cmd command that has been split
+  //! \param nb_parts number of parts
+  //! \param callback called with the merged reply once all the parts replied
+  //!
+  multi_key_reply_merger(const std::vector<std::string>& redis_cmd, std::size_t nb_parts, const std::function<void(reply&)>& callback);
+
+  //! dtor
+  ~multi_key_reply_merger(void) = default;
+
+  //! copy ctor
+  multi_key_reply_merger(const multi_key_reply_merger&) = delete;
+  //! assignment operator
+  multi_key_reply_merger& operator=(const multi_key_reply_merger&) = delete;
+
+public:
+  //!
+  //! merge the reply of a part, calling the callback if it was the last one
+  //! thread safe
+  //!
+  //! \param part part that replied
+  //! \param reply reply of the part
+  //!
+  void add_reply(const multi_key_command_part& part, reply& reply);
+
+private:
+  //!
+  //! whether the command is MGET
+  //!
+  bool m_is_mget;
+
+  //!
+  //! whether the command is MSET
+  //!
+  bool m_is_mset;
+
+  //!
+  //! parts that did not reply yet
+  //!
+  std::size_t m_remaining;
+
+  //!
+  //! MGET values
+  //!
+  std::vector<reply> m_values;
+
+  //!
+  //! sum of the counts
+  //!
+  int64_t m_count;
+
+  //!
+  //! first error received
+  //!
+  std::string m_error;
+
+  //!
+  //! user callback
+  //!
+  std::function<void(reply&)> m_callback;
+
+  //!
+  //! thread safety
+  //!
+  std::mutex m_mutex;
+};
+
+} // namespace cpp_redis
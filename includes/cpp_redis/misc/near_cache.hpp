@@ -0,0 +1,277 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/reply.hpp>
+
+namespace cpp_redis {
+
+//!
+//! \return approximate memory used by a reply
+//!
+std::size_t approximate_reply_size(const reply& value);
+
+//!
+//! bounded in-process cache of read replies, indexed by key
+//! replies expire after a per-key TTL and the least recently used keys (CLOCK approximation) are evicted beyond the memory bound
+//! keys are spread over independently locked shards, each shard being an open addressing (linear probing) table whose probes only touch a compact array of hashes
+//! a read missing the cache registers a placeholder: invalidating the key while the read is in flight drops the placeholder and the reply is not stored
+//!
+class near_cache {
+public:
+  //!
+  //! TTL policy, returns the TTL of the replies of the given key
+  //!
+  typedef std::function<std::chrono::milliseconds(const std::string& key)> ttl_policy_t;
+
+  //!
+  //! ctor
+  //!
+  //! \param max_bytes approximate memory bound of the cache
+  //! \param ttl TTL of the cached replies
+  //! \param nb_shards number of independently locked shards
+  //! \param ttl_policy per-key TTL overriding ttl (nullable)
+  //!
+  near_cache(std::size_t max_bytes, const std::chrono::milliseconds& ttl, std::size_t nb_shards = 16, const ttl_policy_t& ttl_policy = nullptr);
+
+  //! dtor
+  ~near_cache(void) = default;
+
+  //! copy ctor
+  near_cache(const near_cache&) = delete;
+  //! assignment operator
+  near_cache& operator=(const near_cache&) = delete;
+
+public:
+  //!
+  //! cache statistics
+  //!
+  struct cache_stats {
+    //! lookups served from the cache
+    std::uint64_t hits;
+    //! lookups missing the cache
+    std::uint64_t misses;
+    //! replies dropped because their TTL expired
+    std::uint64_t expirations;
+    //! keys evicted by invalidate()
+    std::uint64_t invalidations;
+    //! keys evicted to honor the memory bound
+    std::uint64_t evictions;
+    //! number of cached keys
+    std::size_t keys;
+    //! approximate memory used by the cache
+    std::size_t bytes;
+  };
+
+public:
+  //!
+  //! look the reply of a read up, and register a placeholder for it on a miss
+  //!
+  //! \param key key read
+  //! \param signature read identifier within the key (GET, HGET <field>, ...)
+  //! \param value set to the cached reply on a hit
+  //! \param ticket set to the placeholder id on a miss, to be given back to fill() or cancel()
+  //! \return whether the read is a hit
+  //!
+  bool lookup(const std::string& key, const std::string& signature, reply& value, std::uint64_t& ticket);
+
+  //!
+  //! store the reply of a read in its placeholder, unless the key has been invalidated since lookup()
+  //! error replies are never stored
+  //!
+  //! \param key key read
+  //! \param signature read identifier within the key
+  //! \param ticket placeholder id returned by lookup()
+  //! \param value reply to be stored
+  //!
+  void fill(const std::string& key, const std::string& signature, std::uint64_t ticket, const reply& value);
+
+  //!
+  //! drop the placeholder of a read whose reply should not be stored
+  //!
+  //! \param key key read
+  //! \param signature read identifier within the key
+  //! \param ticket placeholder id returned by lookup()
+  //!
+  void cancel(const std::string& key, const std::string& signature, std::uint64_t ticket);
+
+  //!
+  //! evict all the replies of a key
+  //!
+  //! \param key key to be evicted
+  //!
+  void invalidate(const std::string& key);
+
+  //!
+  //! evict all the keys
+  //!
+  void clear(void);
+
+  //!
+  //! \return cache statistics
+  //!
+  cache_stats get_stats(void) const;
+
+private:
+  //!
+  //! cached reply of a given read on a key (or the placeholder of a read in flight)
+  //!
+  struct cached_reply {
+    //! read identifier
+    std::string signature;
+    //! cached reply
+    reply value;
+    //! placeholder id of the read filling the entry
+    std::uint64_t ticket;
+    //! whether value has been received
+    bool filled;
+    //! approximate size of the reply
+    std::size_t bytes;
+    //! expiration of the reply
+    std::chrono::steady_clock::time_point expires_at;
+  };
+
+  //!
+  //! cached replies of a key
+  //!
+  struct entry {
+    //! key
+    std::string key;
+    //! replies by read
+    std::vector<cached_reply> replies;
+    //! CLOCK reference bit, set on access
+    bool referenced;
+    //! approximate size of the key and its replies
+    std::size_t bytes;
+  };
+
+  //!
+  //! open addressing table holding a subset of the keys
+  //!
+  struct shard {
+    //! hashes of the slots (empty_slot, deleted_slot, or the hash of the key of the slot)
+    std::vector<std::uint64_t> hashes;
+    //! entries of the slots
+    std::vector<entry> entries;
+    //! number of live slots
+    std::size_t size = 0;
+    //! number of deleted slots
+    std::size_t deleted = 0;
+    //! approximate memory used by the shard
+    std::size_t bytes = 0;
+    //! CLOCK hand
+    std::size_t hand = 0;
+    //! shard thread safety
+    std::mutex mutex;
+  };
+
+private:
+  //!
+  //! \return hash of the key, never equal to empty_slot nor deleted_slot
+  //!
+  static std::uint64_t hash_key(const std::string& key);
+
+  //!
+  //! \return shard owning the given hash
+  //!
+  shard& get_shard(std::uint64_t hash);
+
+  //!
+  //! \return slot of the key in the shard, or npos
+  //!
+  static std::size_t find(const shard& shard, const std::string& key, std::uint64_t hash);
+
+  //!
+  //! insert a key missing from the shard, growing the table if needed
+  //!
+  //! \return slot of the new key
+  //!
+  static std::size_t insert(shard& shard, const std::string& key, std::uint64_t hash);
+
+  //!
+  //! free a slot
+  //!
+  static void erase(shard& shard, std::size_t slot);
+
+  //!
+  //! rebuild the table of a shard with the given capacity, dropping deleted slots
+  //!
+  static void rehash(shard& shard, std::size_t capacity);
+
+  //!
+  //! evict keys of the shard (CLOCK) until it fits in its memory bound
+  //!
+  void evict(shard& shard);
+
+  //!
+  //! drop a placeholder, and its key if it has no other reply
+  //!
+  static void drop_reply(shard& shard, std::size_t slot, std::size_t reply_index);
+
+private:
+  //!
+  //! memory bound of each shard
+  //!
+  std::size_t m_max_bytes_per_shard;
+
+  //!
+  //! default TTL
+  //!
+  std::chrono::milliseconds m_ttl;
+
+  //!
+  //! per-key TTL (nullable)
+  //!
+  ttl_policy_t m_ttl_policy;
+
+  //!
+  //! shards
+  //!
+  std::vector<std::unique_ptr<shard>> m_shards;
+
+  //!
+  //! id of the next placeholder
+  //!
+  std::atomic<std::uint64_t> m_next_ticket;
+
+  //!
+  //! statistics
+  //!
+  std::atomic<std::uint64_t> m_hits;
+  std::atomic<std::uint64_t> m_misses;
+  std::atomic<std::uint64_t> m_expirations;
+  std::atomic<std::uint64_t> m_invalidations;
+  std::atomic<std::uint64_t> m_evictions;
+};
+
+} // namespace cpp_redis
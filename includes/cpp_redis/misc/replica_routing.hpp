@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace cpp_redis {
+
+//!
+//! exponentially weighted moving average of the round trip time of a node
+//! not thread safe: callers serialize the accesses
+//!
+class latency_ewma {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param weight weight of each new sample, in ]0, 1]
+  //!
+  explicit latency_ewma(double weight = 0.2);
+
+  //! dtor
+  ~latency_ewma(void) = default;
+
+  //! copy ctor
+  latency_ewma(const latency_ewma&) = default;
+  //! assignment operator
+  latency_ewma& operator=(const latency_ewma&) = default;
+
+public:
+  //!
+  //! \param weight weight of each new sample, ignored if not in ]0, 1]
+  //!
+  void set_weight(double weight);
+
+  //!
+  //! initialize the average if no sample was received yet (samples give a better estimate)
+  //!
+  //! \param rtt measured round trip time
+  //!
+  void seed(std::chrono::microseconds rtt);
+
+  //!
+  //! feed the average, the first sample is taken as is
+  //!
+  //! \param usecs round trip time in microseconds
+  //!
+  void add_sample(double usecs);
+
+  //!
+  //! \return current average in microseconds, 0 if unknown
+  //!
+  double get(void) const;
+
+private:
+  //!
+  //! weight of each new sample
+  //!
+  double m_weight;
+
+  //!
+  //! average in microseconds
+  //!
+  double m_value;
+};
+
+//!
+//! \param latency_usecs latency moving average of the node
+//! \param nb_pending number of commands in flight on the node
+//! \return routing score of the node: latency weighted by the number of commands in flight, the lower the better
+//!
+double routing_score(double latency_usecs, std::size_t nb_pending);
+
+//!
+//! pick the candidate a read should be routed to
+//! every 1 / probe_rate decisions, the next candidate in turn is picked whatever its score, so that a node that was slow keeps being measured
+//! otherwise the best scored candidate is picked, ties are spread by starting from a rotating position
+//!
+//! \param scores routing score of each candidate, must not be empty
+//! \param decision sequence number of the decision
+//! \param probe_rate share of decisions used as probes, 0 to disable probing
+//! \return index of the selected candidate
+//!
+std::size_t select_by_routing_score(const std::vector<double>& scores, std::size_t decision, double probe_rate);
+
+} // namespace cpp_redis
@@ -0,0 +1,347 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cpp_redis/core/reply.hpp>
+#include <cpp_redis/misc/error.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cpp_redis {
+
+//!
+//! size of a buffer large enough for any number formatted by format_number
+//!
+const std::size_t max_number_length = 32;
+
+//!
+//! write the decimal representation of a number in buffer (not null terminated)
+//! floating point numbers are written with the shortest representation that parses back to the exact same value (0.1 gives "0.1", not "0.100000")
+//!
+//! \param value number to be formatted
+//! \param buffer output, must hold at least max_number_length chars
+//! \return number of chars written
+//!
+std::size_t format_number(int64_t value, char* buffer);
+std::size_t format_number(uint64_t value, char* buffer);
+std::size_t format_number(double value, char* buffer);
+std::size_t format_number(float value, char* buffer);
+
+//!
+//! parse the number stored in [first, last) without allocating
+//! the whole range must be consumed: leading spaces, trailing garbage and out of range values are rejected
+//!
+//! \param first beginning of the number
+//! \param last end of the number
+//! \param value output, only modified on success
+//! \return whether a number could be parsed
+//!
+bool parse_number(const char* first, const char* last, int64_t& value);
+bool parse_number(const char* first, const char* last, uint64_t& value);
+bool parse_number(const char* first, const char* last, double& value);
+bool parse_number(const char* first, const char* last, float& value);
+
+//!
+//! conversion of a value into a redis command argument
+//! specialize it for your own types by providing:
+//!   static std::string convert(const T& value);
+//!
+template <typename T, typename Enable = void>
+struct to_redis;
+
+//!
+//! conversion of a reply into a value
+//! specialize it for your own types by providing:
+//!   static T convert(const reply& r);
+//! conversions are expected to throw redis_error when the reply can not be converted
+//!
+template <typename T, typename Enable = void>
+struct from_redis;
+
+//!
+//! integral types other than int and bool
+//! select the typed overloads of the commands taking an int argument (INCRBY, EXPIRE, ...), so that 64 bits values are not truncated
+//!
+template <typename T>
+struct is_wide_integer : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, int>::value && !std::is_same<T, bool>::value> {};
+
+//!
+//! \return value converted into a redis command argument
+//!
+template <typename T>
+std::string
+to_redis_string(const T& value) {
+  return to_redis<T>::convert(value);
+}
+
+//!
+//! \return each of the values converted into a redis command argument
+//!
+template <typename T>
+std::vector<std::string>
+to_redis_strings(const std::vector<T>& values) {
+  std::vector<std::string> strings;
+  strings.reserve(values.size());
+
+  for (const auto& value : values) {
+    strings.push_back(to_redis<T>::convert(value));
+  }
+
+  return strings;
+}
+
+//!
+//! \return r converted into a T
+//! throws redis_error for error replies, null replies and replies that can not be converted into a T
+//!
+template <typename T>
+T
+from_redis_reply(const reply& r) {
+  return from_redis<T>::convert(r);
+}
+
+//!
+//! build a redis command from arguments of any type having a to_redis specialization
+//! for example make_command("ZADD", key, 1.5, member)
+//!
+//! \return the redis command, to be given to client::send
+//!
+template <typename... Args>
+std::vector<std::string>
+make_command(const std::string& name, const Args&... args) {
+  std::vector<std::string> redis_cmd;
+  redis_cmd.reserve(sizeof...(args) + 1);
+  redis_cmd.push_back(name);
+
+  int unpack[] = {0, (redis_cmd.push_back(to_redis_string(args)), 0)...};
+  (void) unpack;
+
+  return redis_cmd;
+}
+
+//!
+//! throw if r is an error or a null reply
+//!
+inline void
+check_convertible_reply(const reply& r) {
+  if (r.is_error()) {
+    throw redis_error(r.as_string());
+  }
+
+  if (r.is_null()) {
+    throw redis_error("cannot convert a null reply");
+  }
+}
+
+//!
+//! strings
+//!
+template <>
+struct to_redis<std::string> {
+  static std::string
+  convert(const std::string& value) {
+    return value;
+  }
+};
+
+template <std::size_t N>
+struct to_redis<char[N]> {
+  static std::string
+  convert(const char* value) {
+    return value;
+  }
+};
+
+template <>
+struct to_redis<const char*> {
+  static std::string
+  convert(const char* value) {
+    return value;
+  }
+};
+
+template <>
+struct to_redis<char*> {
+  static std::string
+  convert(const char* value) {
+    return value;
+  }
+};
+
+template <>
+struct from_redis<std::string> {
+  static std::string
+  convert(const reply& r) {
+    check_convertible_reply(r);
+
+    if (r.is_integer()) {
+      char buffer[max_number_length];
+      return std::string(buffer, format_number(static_cast<int64_t>(r.as_integer()), buffer));
+    }
+
+    if (!r.is_string()) {
+      throw redis_error("cannot convert an array reply into a string");
+    }
+
+    return r.as_string();
+  }
+};
+
+//!
+//! booleans, sent as 1 and 0
+//!
+template <>
+struct to_redis<bool> {
+  static std::string
+  convert(bool value) {
+    return value ? "1" : "0";
+  }
+};
+
+template <>
+struct from_redis<bool> {
+  static bool
+  convert(const reply& r) {
+    check_convertible_reply(r);
+
+    int64_t value;
+    if (r.is_integer()) {
+      value = r.as_integer();
+    }
+    else if (!r.is_string() || !parse_number(r.as_string().data(), r.as_string().data() + r.as_string().size(), value)) {
+      throw redis_error("cannot convert reply into a boolean");
+    }
+
+    return value != 0;
+  }
+};
+
+//!
+//! integers
+//!
+template <typename T>
+struct to_redis<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+  static std::string
+  convert(T value) {
+    //! widen to the 64 bits integer of the same signedness
+    typedef typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type wide_type;
+
+    char buffer[max_number_length];
+    return std::string(buffer, format_number(static_cast<wide_type>(value), buffer));
+  }
+};
+
+template <typename T>
+struct from_redis<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+  static T
+  convert(const reply& r) {
+    typedef typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type wide_type;
+
+    check_convertible_reply(r);
+
+    wide_type value;
+    if (r.is_integer()) {
+      if (!std::is_signed<T>::value && r.as_integer() < 0) {
+        throw redis_error("integer reply out of range");
+      }
+
+      value = static_cast<wide_type>(r.as_integer());
+    }
+    else if (!r.is_string() || !parse_number(r.as_string().data(), r.as_string().data() + r.as_string().size(), value)) {
+      throw redis_error("cannot convert reply into an integer");
+    }
+
+    if (value < static_cast<wide_type>(std::numeric_limits<T>::min()) || value > static_cast<wide_type>(std::numeric_limits<T>::max())) {
+      throw redis_error("integer reply out of range");
+    }
+
+    return static_cast<T>(value);
+  }
+};
+
+//!
+//! floating point numbers, formatted with the shortest representation that round trips
+//!
+template <typename T>
+struct to_redis<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  static std::string
+  convert(T value) {
+    //! float keeps its own shortest representation, long double is narrowed to double
+    typedef typename std::conditional<std::is_same<T, float>::value, float, double>::type format_type;
+
+    char buffer[max_number_length];
+    return std::string(buffer, format_number(static_cast<format_type>(value), buffer));
+  }
+};
+
+template <typename T>
+struct from_redis<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+  static T
+  convert(const reply& r) {
+    typedef typename std::conditional<std::is_same<T, float>::value, float, double>::type parse_type;
+
+    check_convertible_reply(r);
+
+    if (r.is_integer()) {
+      return static_cast<T>(r.as_integer());
+    }
+
+    parse_type value;
+    if (!r.is_string() || !parse_number(r.as_string().data(), r.as_string().data() + r.as_string().size(), value)) {
+      throw redis_error("cannot convert reply into a floating point number");
+    }
+
+    return static_cast<T>(value);
+  }
+};
+
+//!
+//! arrays, converted element by element
+//!
+template <typename T>
+struct from_redis<std::vector<T>> {
+  static std::vector<T>
+  convert(const reply& r) {
+    check_convertible_reply(r);
+
+    if (!r.is_array()) {
+      throw redis_error("cannot convert a non array reply into a vector");
+    }
+
+    std::vector<T> values;
+    values.reserve(r.as_array().size());
+
+    for (const auto& row : r.as_array()) {
+      values.push_back(from_redis<T>::convert(row));
+    }
+
+    return values;
+  }
+};
+
+} // namespace cpp_redis
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+namespace cpp_redis {
+
+namespace network {
+
+//!
+//! socket level tuning applied to a connection once it is established (and again after each reconnection)
+//! every option defaults to a value leaving the system default untouched
+//!
+struct connection_options {
+  //!
+  //! disable Nagle's algorithm (TCP_NODELAY)
+  //!
+  bool tcp_nodelay = false;
+
+  //!
+  //! size of the kernel send buffer in bytes (SO_SNDBUF), 0 to keep the system default
+  //!
+  std::uint32_t send_buffer_size = 0;
+
+  //!
+  //! size of the kernel receive buffer in bytes (SO_RCVBUF), 0 to keep the system default
+  //!
+  std::uint32_t receive_buffer_size = 0;
+
+  //!
+  //! enable TCP keepalive probes (SO_KEEPALIVE)
+  //!
+  bool keepalive = false;
+
+  //!
+  //! idle time before the first keepalive probe in seconds (TCP_KEEPIDLE), 0 to keep the system default
+  //!
+  std::uint32_t keepalive_idle_secs = 0;
+
+  //!
+  //! interval between two keepalive probes in seconds (TCP_KEEPINTVL), 0 to keep the system default
+  //!
+  std::uint32_t keepalive_interval_secs = 0;
+
+  //!
+  //! number of unanswered keepalive probes before dropping the connection (TCP_KEEPCNT), 0 to keep the system default
+  //!
+  std::uint32_t keepalive_count = 0;
+
+  //!
+  //! time to busy poll the device queue on blocking reads in microseconds (SO_BUSY_POLL, linux only), 0 to disable
+  //!
+  std::uint32_t busy_poll_usecs = 0;
+
+  //!
+  //! time sync_commit() spins waiting for replies before blocking on its condition variable, in microseconds
+  //! trades cpu for latency on deployments where replies come back faster than a thread wake-up, 0 to block right away
+  //!
+  std::uint32_t spin_before_block_usecs = 0;
+};
+
+} // namespace network
+
+} // namespace cpp_redis
@@ -29,12 +29,17 @@
 #include <vector>
 
 #include <cpp_redis/builders/reply_builder.hpp>
+#include <cpp_redis/network/connection_options.hpp>
 #include <cpp_redis/network/tcp_client_iface.hpp>
 
 #ifndef __CPP_REDIS_READ_SIZE
 #define __CPP_REDIS_READ_SIZE 4096
 #endif /* __CPP_REDIS_READ_SIZE */
 
+#ifndef __CPP_REDIS_UNIX_SOCKET_URI_PREFIX
+#define __CPP_REDIS_UNIX_SOCKET_URI_PREFIX "unix://"
+#endif /* __CPP_REDIS_UNIX_SOCKET_URI_PREFIX */
+
 namespace cpp_redis {
 
 namespace network {
@@ -75,21 +80,37 @@ public:
   //!
   typedef std::function<void(redis_connection&, reply&)> reply_callback_t;
 
+  //!
+  //! replies handler takes as parameter the instance of the redis_connection and all the replies built from a single read
+  //!
+  typedef std::function<void(redis_connection&, std::vector<reply>&)> replies_callback_t;
+
   //!
   //! connect to the given host and port, and set both disconnection and reply callbacks
+  //! host can be given as unix:///path/to/redis.sock to connect through a unix domain socket (port is then ignored)
   //!
   //! \param host host to be connected to
   //! \param port port to be connected to
   //! \param disconnection_handler handler to be called in case of disconnection
   //! \param reply_callback handler to be called once a reply is ready
   //! \param timeout_msecs max time to connect (in ms)
+  //! \param options socket options to be applied once connected
   //!
   void connect(
     const std::string& host                              = "127.0.0.1",
     std::size_t port                                     = 6379,
     const disconnection_handler_t& disconnection_handler = nullptr,
     const reply_callback_t& reply_callback               = nullptr,
-    std::uint32_t timeout_msecs                          = 0);
+    std::uint32_t timeout_msecs                          = 0,
+    const connection_options& options                    = connection_options());
+
+  //!
+  //! set a handler receiving all the replies built from a single read at once (instead of calling the reply callback once per reply)
+  //! when set, it takes precedence over the reply callback passed to connect()
+  //!
+  //! \param replies_callback handler to be called once per read with the replies that have been built
+  //!
+  void set_replies_callback(const replies_callback_t& replies_callback);
 
   //!
   //! disconnect from redis server
@@ -103,6 +124,12 @@ public:
   //!
   bool is_connected(void) const;
 
+  //!
+  //! \param host host, as given to connect()
+  //! \return whether host refers to a unix domain socket (unix:///path/to/redis.sock)
+  //!
+  static bool is_unix_socket_uri(const std::string& host);
+
   //!
   //! send the given command
   //! the command is actually pipelined and only buffered, so nothing is sent to the network
@@ -159,6 +186,11 @@ private:
   //!
   reply_callback_t m_reply_callback;
 
+  //!
+  //! replies callback called once per read with all the replies built from it
+  //!
+  replies_callback_t m_replies_callback;
+
   //!
   //! disconnection handler whenever a disconnection occurred
   //!
@@ -25,6 +25,12 @@
 #include <cpp_redis/misc/error.hpp>
 #include <cpp_redis/network/tcp_client_iface.hpp>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
 #include <tacopie/tacopie>
 
 namespace cpp_redis {
@@ -33,17 +39,30 @@ namespace network {
 
 //!
 //! implementation of the tcp_client_iface based on tacopie networking library
+//! the socket is driven directly on a tacopie io service held by the client (rather than through a tacopie::tcp_client, which can only use the global default io service), so that connections can be attached to io shards
 //!
 class tcp_client : public tcp_client_iface {
 public:
+  //!
   //! ctor
-  tcp_client(void) = default;
+  //! the underlying connection is attached to the default io service, or to the next io shard if set_io_shards() has been called
+  //!
+  tcp_client(void);
+  //!
   //! dtor
-  ~tcp_client(void) = default;
+  //! disconnects and waits for the socket to be removed from the io service
+  //!
+  ~tcp_client(void);
+
+  //! copy ctor
+  tcp_client(const tcp_client&) = delete;
+  //! assignment operator
+  tcp_client& operator=(const tcp_client&) = delete;
 
 public:
   //!
   //! start the tcp client
+  //! a port of 0 means that addr is the path of a unix domain socket
   //!
   //! \param addr host to be connected to
   //! \param port port to be connected to
@@ -63,8 +82,17 @@ public:
   //!
   bool is_connected(void) const;
 
+  //!
+  //! apply socket level options to the current connection
+  //! TCP specific options are skipped for unix domain sockets and options rejected by the system are only logged
+  //!
+  //! \param options options to be applied
+  //!
+  void set_connection_options(const connection_options& options);
+
   //!
   //! set number of io service workers for the io service monitoring this tcp connection
+  //! ignored (with a warning) for connections attached to an io shard: shards rely on running a single worker
   //!
   //! \param nb_threads number of threads to be assigned
   //!
@@ -95,9 +123,97 @@ public:
 
 private:
   //!
-  //! tcp client for redis connection
+  //! io service callback: the socket is readable, process the first read request
+  //!
+  void on_read_available(tacopie::fd_t fd);
+
+  //!
+  //! io service callback: the socket is writable, process the first write request
+  //!
+  void on_write_available(tacopie::fd_t fd);
+
+  //!
+  //! pop the first read request and read from the socket
+  //!
+  //! \param result result of the read operation
+  //! \return callback of the processed request (nullptr if there was no request)
+  //!
+  async_read_callback_t process_read(read_result& result);
+
+  //!
+  //! pop the first write request and write to the socket
+  //!
+  //! \param result result of the write operation
+  //! \return callback of the processed request (nullptr if there was no request)
+  //!
+  async_write_callback_t process_write(write_result& result);
+
+  //!
+  //! drop the pending read requests
+  //!
+  void clear_read_requests(void);
+
+  //!
+  //! drop the pending write requests
+  //!
+  void clear_write_requests(void);
+
+private:
+  //!
+  //! io service monitoring the socket: the default io service, or the io shard the connection is attached to
+  //! holding it keeps a shard alive after set_io_shards() replaced it
+  //!
+  std::shared_ptr<tacopie::io_service> m_io_service;
+
   //!
-  tacopie::tcp_client m_client;
+  //! socket of the redis connection
+  //!
+  tacopie::tcp_socket m_socket;
+
+  //!
+  //! whether the socket is connected (and tracked by m_io_service)
+  //!
+  std::atomic_bool m_is_connected;
+
+  //!
+  //! pending read requests
+  //!
+  std::queue<read_request> m_read_requests;
+
+  //!
+  //! m_read_requests thread safety
+  //!
+  std::mutex m_read_requests_mutex;
+
+  //!
+  //! pending write requests
+  //!
+  std::queue<write_request> m_write_requests;
+
+  //!
+  //! m_write_requests thread safety
+  //!
+  std::mutex m_write_requests_mutex;
+
+  //!
+  //! handler called when the connection is lost
+  //!
+  disconnection_handler_t m_disconnection_handler;
+
+  //!
+  //! cpu the io shard running this connection is pinned to (-1 when not pinned)
+  //!
+  int m_cpu = -1;
+
+  //!
+  //! whether we are connected through a unix domain socket (port 0)
+  //!
+  bool m_is_unix_socket = false;
+
+  //!
+  //! whether the connection is attached to an io shard
+  //!
+  bool m_is_sharded = false;
 };
 
 //!
@@ -107,6 +223,17 @@ private:
 //!
 void set_default_nb_workers(std::size_t nb_threads);
 
+//!
+//! enable the sharded reactor mode: tcp clients created afterwards are spread (round robin) over nb_shards dedicated io services running one worker each.
+//! all the reads, reply parsing and callbacks of a given connection therefore always run on the same thread, keeping its state hot in that core cache.
+//! connections created before the call keep their current io service.
+//! tacopie's global default io service is left untouched: other tacopie objects of the application are not affected.
+//!
+//! \param nb_shards number of io services, 0 to go back to the default io service
+//! \param cpus cpus the shard workers are pinned to (shard i is pinned to cpus[i % cpus.size()]), leave empty to disable pinning (only supported on linux and windows)
+//!
+void set_io_shards(std::size_t nb_shards, const std::vector<int>& cpus = {});
+
 } // namespace network
 
 } // namespace cpp_redis
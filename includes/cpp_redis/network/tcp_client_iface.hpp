@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 
+#include <cpp_redis/network/connection_options.hpp>
+
 namespace cpp_redis {
 
 namespace network {
@@ -44,6 +46,7 @@ public:
 public:
   //!
   //! start the tcp client
+  //! a port of 0 means that addr is the path of a unix domain socket
   //!
   //! \param addr host to be connected to
   //! \param port port to be connected to
@@ -63,6 +66,14 @@ public:
   //!
   virtual bool is_connected(void) const = 0;
 
+  //!
+  //! apply socket level options to the current connection
+  //! called right after each successful connect(): implementations that do not support socket tuning may keep this default no-op
+  //!
+  //! \param options options to be applied
+  //!
+  virtual void set_connection_options(const connection_options& options) { (void) options; }
+
 public:
   //!
   //! structure to store read requests result
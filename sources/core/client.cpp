@@ -22,15 +22,29 @@
 
 #include <cpp_redis/core/client.hpp>
 #include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/hash_slot.hpp>
 #include <cpp_redis/misc/macro.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <thread>
+#include <unordered_set>
+
 namespace cpp_redis {
 
 #ifndef __CPP_REDIS_USE_CUSTOM_TCP_CLIENT
 client::client(void)
 : m_reconnecting(false)
 , m_cancel(false)
-, m_callbacks_running(0) {
+, m_callbacks_running(0)
+, m_latency_usecs(0)
+, m_hedge_delay_usecs(0)
+, m_in_transaction(false)
+, m_batched_gets(0)
+, m_get_batch_bypass(false)
+, m_nb_combined_writes(0)
+, m_write_combining_bypass(false) {
   __CPP_REDIS_LOG(debug, "cpp_redis::client created");
 }
 #endif /* __CPP_REDIS_USE_CUSTOM_TCP_CLIENT */
@@ -40,150 +54,1764 @@ client::client(const std::shared_ptr<network::tcp_client_iface>& tcp_client)
 , m_sentinel(tcp_client)
 , m_reconnecting(false)
 , m_cancel(false)
-, m_callbacks_running(0) {
+, m_callbacks_running(0)
+, m_latency_usecs(0)
+, m_hedge_delay_usecs(0)
+, m_in_transaction(false)
+, m_batched_gets(0)
+, m_get_batch_bypass(false)
+, m_nb_combined_writes(0)
+, m_write_combining_bypass(false) {
   __CPP_REDIS_LOG(debug, "cpp_redis::client created");
 }
 
-client::~client(void) {
-  //! ensure we stopped reconnection attempts
-  if (!m_cancel) {
-    cancel_reconnect();
+client::~client(void) {
+  //! drop the hedges not sent yet, they refer to this client
+  {
+    std::lock_guard<std::mutex> lock(m_hedge_mutex);
+    m_hedge_timer = nullptr;
+  }
+
+  //! same for the GET batches and combined writes flushes, waiting for a flush in progress
+  m_get_batch_timer       = nullptr;
+  m_write_combining_timer = nullptr;
+
+  //! ensure we stopped reconnection attempts
+  if (!m_cancel) {
+    cancel_reconnect();
+  }
+
+  //! wait for a replica discovery in progress
+  {
+    std::lock_guard<std::mutex> lock(m_discovery_mutex);
+    m_discovery_executor = nullptr;
+  }
+
+  //! If for some reason sentinel is connected then disconnect now.
+  if (m_sentinel.is_connected()) {
+    m_sentinel.disconnect(true);
+  }
+
+  //! disconnect underlying tcp socket
+  if (m_client.is_connected()) {
+    m_client.disconnect(true);
+  }
+
+  //! wait for the callbacks still queued on executors
+  {
+    std::unique_lock<std::mutex> lock_callback(m_callbacks_mutex);
+    m_sync_condvar.wait(lock_callback, [=] { return m_callbacks_running == 0; });
+  }
+
+  //! the failure thread may still be notifying m_sync_condvar: join it before the members go away
+  {
+    std::lock_guard<std::mutex> lock(m_failure_executor_mutex);
+    m_failure_executor = nullptr;
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::client destroyed");
+}
+
+void
+client::connect(
+  const std::string& name,
+  const connect_callback_t& connect_callback,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  //! Save for auto reconnects
+  m_master_name = name;
+
+  //! We rely on the sentinel to tell us which redis server is currently the master.
+  if (m_sentinel.get_master_addr_by_name(name, m_redis_server, m_redis_port, true)) {
+    connect(m_redis_server, m_redis_port, connect_callback, timeout_msecs, max_reconnects, reconnect_interval_msecs, options);
+  }
+  else {
+    throw redis_error("cpp_redis::client::connect() could not find master for name " + name);
+  }
+}
+
+
+void
+client::connect(
+  const std::string& host, std::size_t port,
+  const connect_callback_t& connect_callback,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::client attempts to connect");
+
+  //! Save for auto reconnects
+  m_redis_server             = host;
+  m_redis_port               = port;
+  m_connect_callback         = connect_callback;
+  m_max_reconnects           = max_reconnects;
+  m_reconnect_interval_msecs = reconnect_interval_msecs;
+  m_connection_options       = options;
+
+  //! notify start
+  if (m_connect_callback) {
+    m_connect_callback(host, port, connect_state::start);
+  }
+
+  auto disconnection_handler = std::bind(&client::connection_disconnection_handler, this, std::placeholders::_1);
+  auto receive_handler       = std::bind(&client::connection_receive_handler, this, std::placeholders::_1, std::placeholders::_2);
+  m_client.set_replies_callback(receive_handler);
+  m_client.connect(host, port, disconnection_handler, nullptr, timeout_msecs, options);
+
+  //! reconnections run on a network thread, which must not block waiting for replies
+  if (m_read_policy != read_policy::primary_only) {
+    if (is_reconnecting()) {
+      async_discover_replicas();
+    }
+    else {
+      try {
+        discover_replicas();
+      }
+      catch (const redis_error&) {
+        __CPP_REDIS_LOG(warn, "cpp_redis::client could not discover replicas, reads are sent to the master");
+      }
+    }
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::client connected");
+
+  //! notify end
+  if (m_connect_callback) {
+    m_connect_callback(m_redis_server, m_redis_port, connect_state::ok);
+  }
+}
+
+void
+client::disconnect(bool wait_for_removal) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::client attempts to disconnect");
+
+  //! close connection
+  m_client.disconnect(wait_for_removal);
+
+  //! make sure we clear buffer of unsent commands
+  clear_callbacks();
+
+  //! replicas are discovered again on the next connect
+  std::vector<std::shared_ptr<node_connection>> replicas;
+
+  {
+    std::lock_guard<std::mutex> lock(m_replicas_mutex);
+    replicas.swap(m_replicas);
+  }
+
+  for (const auto& replica : replicas) {
+    replica->node->disconnect(wait_for_removal);
+  }
+
+  //! the blocking lane is opened again on demand
+  std::vector<std::shared_ptr<node_connection>> blocking_nodes;
+
+  {
+    std::lock_guard<std::mutex> lock(m_blocking_mutex);
+    blocking_nodes.swap(m_blocking_nodes);
+  }
+
+  for (const auto& blocking_node : blocking_nodes) {
+    blocking_node->node->disconnect(wait_for_removal);
+  }
+
+  m_in_transaction = false;
+
+  __CPP_REDIS_LOG(info, "cpp_redis::client disconnected");
+}
+
+bool
+client::is_connected(void) const {
+  return m_client.is_connected();
+}
+
+std::size_t
+client::get_pending_commands_count(void) {
+  std::lock_guard<std::mutex> lock(m_callbacks_mutex);
+  return m_commands.size();
+}
+
+void
+client::cancel_reconnect(void) {
+  m_cancel = true;
+}
+
+bool
+client::is_reconnecting(void) const {
+  return m_reconnecting;
+}
+
+void
+client::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  m_executor = executor;
+
+  if (!executor || dynamic_cast<inline_executor*>(executor.get())) {
+    m_callbacks_executor = nullptr;
+  }
+  else {
+    m_callbacks_executor = std::make_shared<serial_executor>(executor);
+  }
+}
+
+void
+client::set_near_cache(const std::shared_ptr<near_cache>& cache) {
+  m_near_cache = cache;
+}
+
+const std::shared_ptr<near_cache>&
+client::get_near_cache(void) const {
+  return m_near_cache;
+}
+
+void
+client::set_key_filter(const std::shared_ptr<key_filter>& filter) {
+  m_key_filter = filter;
+}
+
+const std::shared_ptr<key_filter>&
+client::get_key_filter(void) const {
+  return m_key_filter;
+}
+
+void
+client::bootstrap_key_filter(std::size_t scan_count) {
+  std::shared_ptr<key_filter> filter = m_key_filter;
+
+  if (!filter) {
+    throw redis_error("cpp_redis::client::bootstrap_key_filter() requires a key filter");
+  }
+
+  filter->clear();
+
+  std::string cursor = "0";
+
+  do {
+    std::future<reply> scan = send({"SCAN", cursor, "COUNT", std::to_string(scan_count)});
+    sync_commit();
+
+    reply page = scan.get();
+
+    if (!page.is_array() || page.as_array().size() != 2 || !page.as_array()[1].is_array()) {
+      throw redis_error("cpp_redis::client::bootstrap_key_filter() SCAN failed: " + (page.is_error() ? page.as_string() : "unexpected reply"));
+    }
+
+    for (const auto& key : page.as_array()[1].as_array()) {
+      filter->add(key.as_string());
+    }
+
+    cursor = page.as_array()[0].as_string();
+  } while (cursor != "0");
+
+  filter->set_ready(true);
+}
+
+void
+client::set_codec(const std::shared_ptr<codec_iface>& codec, std::size_t min_size) {
+  m_codec          = codec;
+  m_codec_min_size = min_size;
+}
+
+const std::shared_ptr<codec_iface>&
+client::get_codec(void) const {
+  return m_codec;
+}
+
+void
+client::set_read_coalescing(bool enabled) {
+  m_read_coalescing = enabled;
+}
+
+void
+client::set_get_batching(std::size_t max_keys, std::chrono::microseconds window, bool group_by_slot) {
+  m_get_batch_max_keys = max_keys;
+  m_get_batch_window   = window;
+  m_get_batch_by_slot  = group_by_slot;
+}
+
+void
+client::set_write_combining(std::size_t max_elements, std::chrono::microseconds window) {
+  m_write_combining_max_elements = max_elements;
+  m_write_combining_window       = window;
+}
+
+void
+client::set_read_policy(read_policy policy) {
+  m_read_policy = policy;
+}
+
+void
+client::set_blocking_connections(std::size_t max_connections) {
+  m_max_blocking_connections = max_connections;
+}
+
+std::shared_ptr<client>
+client::connect_node(const std::string& host, std::size_t port, bool reconnect) {
+#ifndef __CPP_REDIS_USE_CUSTOM_TCP_CLIENT
+  auto node = std::make_shared<client>();
+  node->set_executor(m_executor);
+  node->set_hedging(m_hedge_percentile, m_hedge_min_delay);
+  node->connect(host, port, nullptr, m_connect_timeout_msecs, reconnect ? m_max_reconnects : 0, m_reconnect_interval_msecs, m_connection_options);
+
+  if (!m_password.empty()) {
+    node->auth(m_password, nullptr);
+  }
+
+  if (m_database_index) {
+    node->select(m_database_index, nullptr);
+  }
+
+  node->sync_commit();
+
+  return node;
+#else
+  (void) host;
+  (void) port;
+  (void) reconnect;
+  throw redis_error("cpp_redis::client replica routing requires the default tcp client");
+#endif /* __CPP_REDIS_USE_CUSTOM_TCP_CLIENT */
+}
+
+//!
+//! time a PING round trip on an idle connection
+//!
+static std::chrono::microseconds
+measure_rtt(client& node) {
+  auto start = std::chrono::steady_clock::now();
+  node.send({"PING"}, nullptr);
+  node.sync_commit();
+
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+void
+client::seed_latency(std::chrono::microseconds rtt) {
+  std::lock_guard<std::mutex> lock(m_callbacks_mutex);
+
+  m_latency_ewma.seed(rtt);
+  m_latency_usecs = static_cast<std::uint64_t>(m_latency_ewma.get());
+}
+
+void
+client::set_probe_rate(double rate) {
+  std::lock_guard<std::mutex> lock(m_replicas_mutex);
+  m_probe_rate = std::min(std::max(rate, 0.0), 1.0);
+}
+
+void
+client::set_latency_ewma_weight(double weight) {
+  std::lock_guard<std::mutex> lock(m_callbacks_mutex);
+
+  m_latency_ewma.set_weight(weight);
+}
+
+std::chrono::microseconds
+client::get_latency(void) const {
+  return std::chrono::microseconds(m_latency_usecs.load());
+}
+
+//!
+//! number of latency samples the hedge delay is computed from
+//!
+static const std::size_t latency_window_size = 1024;
+
+//!
+//! number of samples between two computations of the hedge delay
+//!
+static const std::size_t hedge_delay_refresh_period = 64;
+
+void
+client::set_hedging(double percentile, std::chrono::microseconds min_delay) {
+  std::lock_guard<std::mutex> lock(m_callbacks_mutex);
+
+  m_hedge_percentile   = (percentile > 0 && percentile < 100) ? percentile : 0;
+  m_hedge_min_delay    = min_delay;
+  m_nb_latency_samples = 0;
+  m_hedge_delay_usecs  = 0;
+  m_latency_samples.assign(m_hedge_percentile ? latency_window_size : 0, 0);
+}
+
+std::chrono::microseconds
+client::get_hedge_delay(void) const {
+  return std::chrono::microseconds(m_hedge_delay_usecs.load());
+}
+
+void
+client::add_latency_sample(double sample) {
+  if (!m_hedge_percentile) {
+    return;
+  }
+
+  m_latency_samples[m_nb_latency_samples++ % latency_window_size] = static_cast<std::uint32_t>(std::min(sample, 4e9));
+
+  if (m_nb_latency_samples % hedge_delay_refresh_period) {
+    return;
+  }
+
+  std::vector<std::uint32_t> samples(m_latency_samples.begin(), m_latency_samples.begin() + std::min(m_nb_latency_samples, latency_window_size));
+  auto percentile = samples.begin() + static_cast<std::ptrdiff_t>(m_hedge_percentile / 100 * static_cast<double>(samples.size() - 1));
+  std::nth_element(samples.begin(), percentile, samples.end());
+
+  m_hedge_delay_usecs = std::max(static_cast<std::uint64_t>(*percentile), static_cast<std::uint64_t>(m_hedge_min_delay.count()));
+}
+
+double
+client::get_routing_score(void) {
+  return routing_score(static_cast<double>(m_latency_usecs.load()), get_pending_commands_count());
+}
+
+void
+client::discover_replicas(void) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::client looks for replicas");
+
+  //! use a dedicated connection to the master: the commands of the user must not be flushed nor waited for
+  std::shared_ptr<client> probe = connect_node(m_redis_server, m_redis_port, false);
+  seed_latency(measure_rtt(*probe));
+
+  std::vector<std::pair<std::string, std::size_t>> addrs;
+
+  if (!m_master_name.empty()) {
+    //! use our own sentinel connection: m_sentinel may be in use by a reconnection
+    cpp_redis::sentinel lookup;
+
+    for (const auto& sentinel : m_sentinel.get_sentinels()) {
+      lookup.add_sentinel(sentinel.get_host(), sentinel.get_port(), sentinel.get_timeout_msecs());
+    }
+
+    lookup.get_replicas_addr_by_name(m_master_name, addrs, true);
+  }
+  else {
+    //! ROLE on a master: ["master", replication offset, [[ip, port, offset], ...]]
+    probe->send({"ROLE"}, [&](reply& reply) {
+      if (!reply.is_array() || reply.as_array().size() < 3 || !reply.as_array()[2].is_array()) {
+        return;
+      }
+
+      for (const auto& replica : reply.as_array()[2].as_array()) {
+        if (replica.is_array() && replica.as_array().size() >= 2 && replica.as_array()[0].is_string() && replica.as_array()[1].is_string()) {
+          addrs.push_back({replica.as_array()[0].as_string(), std::stoul(replica.as_array()[1].as_string())});
+        }
+      }
+    });
+    probe->sync_commit();
+  }
+
+  probe->disconnect(true);
+
+  std::vector<std::shared_ptr<node_connection>> current;
+
+  {
+    std::lock_guard<std::mutex> lock(m_replicas_mutex);
+    current = m_replicas;
+  }
+
+  std::vector<std::shared_ptr<node_connection>> replicas;
+
+  for (const auto& addr : addrs) {
+    std::shared_ptr<node_connection> replica;
+
+    //! keep the connections to the replicas we already know
+    for (const auto& existing : current) {
+      if (existing->host == addr.first && existing->port == addr.second && existing->node->is_connected()) {
+        replica = existing;
+      }
+    }
+
+    if (!replica) {
+      try {
+        replica              = std::make_shared<node_connection>();
+        replica->host        = addr.first;
+        replica->port        = addr.second;
+        replica->node        = connect_node(addr.first, addr.second, true);
+        replica->node->seed_latency(measure_rtt(*replica->node));
+        replica->uncommitted = false;
+      }
+      catch (const redis_error&) {
+        __CPP_REDIS_LOG(warn, "cpp_redis::client could not connect to replica " + addr.first + ":" + std::to_string(addr.second));
+        continue;
+      }
+    }
+
+    replicas.push_back(replica);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_replicas_mutex);
+    m_replicas = std::move(replicas);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::client found " + std::to_string(addrs.size()) + " replicas");
+}
+
+void
+client::async_discover_replicas(void) {
+  std::lock_guard<std::mutex> lock(m_discovery_mutex);
+
+  if (!m_discovery_executor) {
+    m_discovery_executor = std::unique_ptr<thread_pool_executor>(new thread_pool_executor(1));
+  }
+
+  m_discovery_executor->execute([this]() {
+    if (m_cancel) {
+      return;
+    }
+
+    try {
+      discover_replicas();
+    }
+    catch (const redis_error&) {
+      __CPP_REDIS_LOG(warn, "cpp_redis::client could not discover replicas, reads are sent to the master");
+    }
+  });
+}
+
+std::vector<std::string>
+client::get_replicas(void) {
+  std::lock_guard<std::mutex> lock(m_replicas_mutex);
+  std::vector<std::string> replicas;
+
+  for (const auto& replica : m_replicas) {
+    replicas.push_back(replica->host + ":" + std::to_string(replica->port));
+  }
+
+  return replicas;
+}
+
+std::shared_ptr<client>
+client::select_replica(void) {
+  std::lock_guard<std::mutex> lock(m_replicas_mutex);
+
+  //! candidates: the connected replicas, plus the master for the nearest policy (represented by nullptr)
+  std::vector<std::shared_ptr<node_connection>> candidates;
+
+  for (const auto& replica : m_replicas) {
+    //! replicas that went away are skipped until they come back
+    if (replica->node->is_connected() && !replica->node->is_reconnecting()) {
+      candidates.push_back(replica);
+    }
+  }
+
+  if (candidates.empty()) {
+    return nullptr;
+  }
+
+  //! a reconnecting master holds its lock until the reconnection completes: do not wait for it
+  if (m_read_policy == read_policy::nearest && !is_reconnecting()) {
+    candidates.push_back(nullptr);
+  }
+
+  std::vector<double> scores;
+
+  for (const auto& candidate : candidates) {
+    scores.push_back(candidate ? candidate->node->get_routing_score() : get_routing_score());
+  }
+
+  std::size_t selected = select_by_routing_score(scores, m_next_replica++, m_probe_rate);
+
+  if (!candidates[selected]) {
+    return nullptr;
+  }
+
+  candidates[selected]->uncommitted = true;
+  return candidates[selected]->node;
+}
+
+std::shared_ptr<client>
+client::select_hedge_target(const std::shared_ptr<client>& primary) {
+  std::lock_guard<std::mutex> lock(m_replicas_mutex);
+
+  std::shared_ptr<client> target = primary;
+  double best_score              = 0;
+
+  for (const auto& replica : m_replicas) {
+    if (replica->node == primary || !replica->node->is_connected() || replica->node->is_reconnecting()) {
+      continue;
+    }
+
+    double score = replica->node->get_routing_score();
+
+    if (target == primary || score < best_score) {
+      best_score = score;
+      target     = replica->node;
+    }
+  }
+
+  //! the master is only used when the command went to a replica, and never while it reconnects
+  if (primary && !is_reconnecting() && (target == primary || get_routing_score() < best_score)) {
+    target = nullptr;
+  }
+
+  return target;
+}
+
+void
+client::hedged_send(const std::shared_ptr<client>& primary, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  auto request      = std::make_shared<hedged_request>();
+  request->done     = false;
+  request->callback = callback;
+
+  reply_callback_t first_reply = [request](reply& reply) {
+    //! the loser reply is dropped
+    if (!request->done.exchange(true) && request->callback) {
+      request->callback(reply);
+    }
+  };
+
+  if (primary) {
+    primary->send(redis_cmd, first_reply);
+  }
+  else {
+    std::lock_guard<std::mutex> lock_callback(m_callbacks_mutex);
+    unprotected_send(redis_cmd, first_reply);
+  }
+
+  //! no hedge until enough replies were received to know what a slow reply is
+  std::chrono::microseconds delay = primary ? primary->get_hedge_delay() : get_hedge_delay();
+
+  if (!delay.count()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_hedge_mutex);
+
+  if (!m_hedge_timer) {
+    m_hedge_timer = std::unique_ptr<timer_executor>(new timer_executor);
+  }
+
+  m_hedge_timer->execute_after(delay, [this, primary, redis_cmd, request, first_reply]() {
+    if (request->done) {
+      return;
+    }
+
+    std::shared_ptr<client> target = select_hedge_target(primary);
+
+    if (target == primary) {
+      return;
+    }
+
+    __CPP_REDIS_LOG(debug, "cpp_redis::client sends hedged read");
+
+    if (target) {
+      target->send_now(redis_cmd, first_reply);
+    }
+    else {
+      send_now(redis_cmd, first_reply);
+    }
+  });
+}
+
+void
+client::send_now(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  {
+    std::lock_guard<std::mutex> lock_callback(m_callbacks_mutex);
+    unprotected_send(redis_cmd, callback);
+  }
+
+  //! the reconnection flow sends the command for us
+  if (is_reconnecting()) {
+    return;
+  }
+
+  //! a failed commit flushes the callbacks with an error reply
+  try {
+    try_commit();
+  }
+  catch (const redis_error&) {
+  }
+}
+
+void
+client::commit_secondary_nodes(void) {
+  if (m_read_policy == read_policy::primary_only && !m_max_blocking_connections) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<client>> nodes;
+
+  {
+    std::lock_guard<std::mutex> lock(m_replicas_mutex);
+
+    for (const auto& replica : m_replicas) {
+      if (replica->uncommitted) {
+        replica->uncommitted = false;
+        nodes.push_back(replica->node);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_blocking_mutex);
+
+    for (const auto& blocking_node : m_blocking_nodes) {
+      if (blocking_node->uncommitted) {
+        blocking_node->uncommitted = false;
+        nodes.push_back(blocking_node->node);
+      }
+    }
+  }
+
+  for (const auto& node : nodes) {
+    try {
+      node->commit();
+    }
+    catch (const redis_error&) {
+      __CPP_REDIS_LOG(warn, "cpp_redis::client could not send pipelined commands to secondary connection");
+    }
+  }
+}
+
+void
+client::wait_for_secondary_nodes(const std::chrono::steady_clock::time_point* deadline) {
+  if (m_read_policy == read_policy::primary_only && !m_max_blocking_connections) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<client>> nodes;
+
+  {
+    std::lock_guard<std::mutex> lock(m_replicas_mutex);
+
+    for (const auto& replica : m_replicas) {
+      nodes.push_back(replica->node);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_blocking_mutex);
+
+    for (const auto& blocking_node : m_blocking_nodes) {
+      nodes.push_back(blocking_node->node);
+    }
+  }
+
+  for (const auto& node : nodes) {
+    std::unique_lock<std::mutex> lock_callback(node->m_callbacks_mutex);
+    auto done = [&] { return node->m_callbacks_running == 0 && node->m_commands.empty(); };
+
+    if (deadline) {
+      node->m_sync_condvar.wait_until(lock_callback, *deadline, done);
+    }
+    else {
+      node->m_sync_condvar.wait(lock_callback, done);
+    }
+  }
+}
+
+void
+client::add_sentinel(const std::string& host, std::size_t port, std::uint32_t timeout_msecs) {
+  m_sentinel.add_sentinel(host, port, timeout_msecs);
+}
+
+const sentinel&
+client::get_sentinel(void) const {
+  return m_sentinel;
+}
+
+sentinel&
+client::get_sentinel(void) {
+  return m_sentinel;
+}
+
+void
+client::clear_sentinels(void) {
+  m_sentinel.clear_sentinels();
+}
+
+client&
+client::send_unacknowledged(const std::vector<std::string>& redis_cmd) {
+  return send_all_unacknowledged({redis_cmd});
+}
+
+client&
+client::send_all_unacknowledged(const std::vector<std::vector<std::string>>& redis_cmds) {
+  if (redis_cmds.empty()) {
+    return *this;
+  }
+
+  for (const auto& redis_cmd : redis_cmds) {
+    if (redis_cmd.empty()) {
+      throw redis_error("cpp_redis::client can not send an empty command unacknowledged");
+    }
+
+    std::string name = redis_cmd[0];
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+    //! queued commands reply QUEUED, and reads are pointless without their reply
+    if (m_in_transaction || name == "MULTI" || name == "EXEC" || name == "DISCARD" || is_read_only_command(name)) {
+      throw redis_error("cpp_redis::client can only send writes outside of transactions unacknowledged");
+    }
+
+    if (m_near_cache) {
+      invalidate_near_cache(name, redis_cmd);
+    }
+
+    if (m_key_filter) {
+      add_to_key_filter(name, redis_cmd);
+    }
+  }
+
+  //! reads sent after the writes must not get the reply of a read sent before them
+  if (m_read_coalescing) {
+    std::lock_guard<std::mutex> lock(m_inflight_reads_mutex);
+    m_inflight_reads.clear();
+  }
+
+  //! commands sent earlier but still waiting to be batched are sent first
+  if (m_nb_combined_writes) {
+    flush_combined_writes();
+  }
+
+  if (m_batched_gets) {
+    flush_get_batches();
+  }
+
+  std::vector<std::vector<std::string>> encoded_cmds;
+
+  if (m_codec) {
+    for (const auto& redis_cmd : redis_cmds) {
+      std::vector<std::string> encoded_cmd;
+      reply_callback_t decoding_callback;
+
+      apply_codec(redis_cmd, nullptr, encoded_cmd, decoding_callback);
+
+      if (encoded_cmd.empty()) {
+        encoded_cmds.push_back(redis_cmd);
+      }
+      else {
+        encoded_cmds.push_back(std::move(encoded_cmd));
+      }
+    }
+  }
+
+  const std::vector<std::vector<std::string>>& cmds = encoded_cmds.empty() ? redis_cmds : encoded_cmds;
+
+  //! the commands are buffered at once, so that no acknowledged command gets in between and loses its reply
+  std::lock_guard<std::mutex> lock_callback(m_callbacks_mutex);
+
+  if (cmds.size() == 1) {
+    m_client.send({"CLIENT", "REPLY", "SKIP"});
+    m_client.send(cmds.front());
+    return *this;
+  }
+
+  m_client.send({"CLIENT", "REPLY", "OFF"});
+
+  for (const auto& cmd : cmds) {
+    m_client.send(cmd);
+  }
+
+  //! the only reply of the batch
+  unprotected_send({"CLIENT", "REPLY", "ON"}, nullptr);
+
+  return *this;
+}
+
+client&
+client::send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  std::vector<std::string> encoded_cmd;
+  reply_callback_t decoding_callback;
+
+  //! the stages below only see compressed values
+  if (m_codec) {
+    apply_codec(redis_cmd, callback, encoded_cmd, decoding_callback);
+  }
+
+  const std::vector<std::string>& cmd    = encoded_cmd.empty() ? redis_cmd : encoded_cmd;
+  const reply_callback_t& codec_callback = decoding_callback ? decoding_callback : callback;
+
+  if (m_key_filter && filter_missing_key(cmd, codec_callback)) {
+    return *this;
+  }
+
+  reply_callback_t filling_callback;
+
+  if (m_near_cache && send_through_near_cache(cmd, codec_callback, filling_callback)) {
+    return *this;
+  }
+
+  const reply_callback_t& cache_callback = filling_callback ? filling_callback : codec_callback;
+  reply_callback_t coalescing_callback;
+
+  if (m_read_coalescing && coalesce_read(cmd, cache_callback, coalescing_callback)) {
+    return *this;
+  }
+
+  const reply_callback_t& reply_callback = coalescing_callback ? coalescing_callback : cache_callback;
+
+  if (m_write_combining_max_elements && combine_write(cmd, reply_callback)) {
+    return *this;
+  }
+
+  if (m_get_batch_max_keys && batch_get(cmd, reply_callback)) {
+    return *this;
+  }
+
+  send_to_connection(cmd, reply_callback);
+
+  return *this;
+}
+
+void
+client::send_to_connection(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  if ((m_read_policy != read_policy::primary_only || m_max_blocking_connections) && route_to_secondary_node(redis_cmd, callback)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock_callback(m_callbacks_mutex);
+
+  __CPP_REDIS_LOG(info, "cpp_redis::client attempts to store new command in the send buffer");
+  unprotected_send(redis_cmd, callback);
+  __CPP_REDIS_LOG(info, "cpp_redis::client stored new command in the send buffer");
+}
+
+bool
+client::batch_get(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  if (redis_cmd.empty()) {
+    return false;
+  }
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  bool in_transaction = update_transaction_state(name);
+
+  //! the command following ASKING must be sent as is, right after it
+  bool after_asking  = m_get_batch_bypass;
+  m_get_batch_bypass = name == "ASKING";
+
+  if (name != "GET" || redis_cmd.size() != 2 || in_transaction || after_asking) {
+    //! commands are not reordered: buffered GETs are sent before any other command
+    if (m_batched_gets) {
+      flush_get_batches();
+    }
+
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_get_batches_mutex);
+
+  //! keys of a MGET must belong to the same slot in a cluster
+  std::uint16_t slot = m_get_batch_by_slot ? hash_slot(redis_cmd[1]) : 0;
+  get_batch& batch   = m_get_batches[slot];
+
+  batch.keys.push_back(redis_cmd[1]);
+  batch.callbacks.push_back(callback);
+  ++m_batched_gets;
+
+  if (batch.keys.size() >= m_get_batch_max_keys) {
+    m_batched_gets -= batch.keys.size();
+    send_get_batch(batch);
+    m_get_batches.erase(slot);
+  }
+
+  return true;
+}
+
+void
+client::flush_get_batches(void) {
+  std::lock_guard<std::mutex> lock(m_get_batches_mutex);
+
+  for (auto& batch : m_get_batches) {
+    m_batched_gets -= batch.second.keys.size();
+    send_get_batch(batch.second);
+  }
+
+  m_get_batches.clear();
+}
+
+void
+client::send_get_batch(get_batch& batch) {
+  if (batch.keys.size() == 1) {
+    send_to_connection({"GET", batch.keys.front()}, batch.callbacks.front());
+    return;
+  }
+
+  std::vector<std::string> mget = {"MGET"};
+  mget.insert(mget.end(), batch.keys.begin(), batch.keys.end());
+
+  auto callbacks = std::make_shared<std::vector<reply_callback_t>>(std::move(batch.callbacks));
+
+  send_to_connection(mget, [callbacks](reply& reply) {
+    bool split = reply.is_array() && reply.as_array().size() == callbacks->size();
+
+    for (std::size_t i = 0; i < callbacks->size(); ++i) {
+      const reply_callback_t& callback = (*callbacks)[i];
+
+      if (!callback) {
+        continue;
+      }
+
+      //! errors (network failure, MOVED, ...) are forwarded to every GET
+      cpp_redis::reply row = split ? reply.as_array()[i] : reply;
+      callback(row);
+    }
+  });
+}
+
+void
+client::schedule_get_batches_flush(void) {
+  std::lock_guard<std::mutex> lock(m_get_batches_mutex);
+
+  if (m_get_batches_flush_scheduled || m_get_batches.empty()) {
+    return;
+  }
+
+  if (!m_get_batch_timer) {
+    m_get_batch_timer = std::unique_ptr<timer_executor>(new timer_executor);
+  }
+
+  m_get_batches_flush_scheduled = true;
+
+  m_get_batch_timer->execute_after(m_get_batch_window, [this]() {
+    {
+      std::lock_guard<std::mutex> lock(m_get_batches_mutex);
+      m_get_batches_flush_scheduled = false;
+    }
+
+    flush_get_batches();
+
+    //! a failed commit flushes the callbacks with an error reply
+    try {
+      commit();
+    }
+    catch (const redis_error&) {
+    }
+  });
+}
+
+//!
+//! number of elements (fields, members or values) written by a write that can be combined, 0 for any other command
+//!
+static std::size_t
+combinable_write_size(const std::string& name, const std::vector<std::string>& redis_cmd) {
+  if (redis_cmd.size() < 3) {
+    return 0;
+  }
+
+  std::size_t nb_args = redis_cmd.size() - 2;
+
+  if (name == "SADD" || name == "RPUSH") {
+    return nb_args;
+  }
+
+  if (name == "HSET") {
+    return nb_args % 2 ? 0 : nb_args / 2;
+  }
+
+  if (name == "ZADD") {
+    //! options apply to the whole command and change its reply
+    std::string option = redis_cmd[2];
+    std::transform(option.begin(), option.end(), option.begin(), ::toupper);
+
+    if (option == "NX" || option == "XX" || option == "GT" || option == "LT" || option == "CH" || option == "INCR") {
+      return 0;
+    }
+
+    return nb_args % 2 ? 0 : nb_args / 2;
+  }
+
+  return 0;
+}
+
+bool
+client::combine_write(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  if (redis_cmd.empty()) {
+    return false;
+  }
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  bool in_transaction = update_transaction_state(name);
+
+  //! the command following ASKING must be sent as is, right after it
+  bool after_asking        = m_write_combining_bypass;
+  m_write_combining_bypass = name == "ASKING";
+
+  std::size_t nb_elements = in_transaction || after_asking ? 0 : combinable_write_size(name, redis_cmd);
+
+  if (!nb_elements) {
+    //! commands are not reordered: waiting writes are sent before any other command
+    if (m_nb_combined_writes) {
+      flush_combined_writes();
+    }
+
+    return false;
+  }
+
+  //! nor are the writes reordered before a GET waiting for its MGET
+  if (m_batched_gets) {
+    flush_get_batches();
+  }
+
+  std::lock_guard<std::mutex> lock(m_combined_writes_mutex);
+
+  const std::string& key = redis_cmd[1];
+  auto it                = m_combined_writes_by_key.find(key);
+
+  //! another command on the same key (most likely an error) is sent after the waiting writes of the key
+  if (it != m_combined_writes_by_key.end() && it->second->command.front() != name) {
+    m_nb_combined_writes -= it->second->callbacks.size();
+    send_combined_write(*it->second);
+    m_combined_writes.erase(it->second);
+    m_combined_writes_by_key.erase(it);
+    it = m_combined_writes_by_key.end();
+  }
+
+  if (it == m_combined_writes_by_key.end()) {
+    m_combined_writes.push_back({{name, key}, {}, {}});
+    it = m_combined_writes_by_key.emplace(key, std::prev(m_combined_writes.end())).first;
+  }
+
+  combined_write& write = *it->second;
+  write.command.insert(write.command.end(), redis_cmd.begin() + 2, redis_cmd.end());
+  write.sizes.push_back(nb_elements);
+  write.callbacks.push_back(callback);
+  ++m_nb_combined_writes;
+
+  std::size_t nb_combined_elements = name == "HSET" || name == "ZADD" ? (write.command.size() - 2) / 2 : write.command.size() - 2;
+
+  if (nb_combined_elements >= m_write_combining_max_elements) {
+    m_nb_combined_writes -= write.callbacks.size();
+    send_combined_write(write);
+    m_combined_writes.erase(it->second);
+    m_combined_writes_by_key.erase(it);
+  }
+
+  return true;
+}
+
+void
+client::flush_combined_writes(void) {
+  std::lock_guard<std::mutex> lock(m_combined_writes_mutex);
+
+  for (auto& write : m_combined_writes) {
+    m_nb_combined_writes -= write.callbacks.size();
+    send_combined_write(write);
+  }
+
+  m_combined_writes.clear();
+  m_combined_writes_by_key.clear();
+}
+
+void
+client::send_combined_write(combined_write& write) {
+  if (write.callbacks.size() == 1) {
+    send_to_connection(write.command, write.callbacks.front());
+    return;
+  }
+
+  auto sizes     = std::make_shared<std::vector<std::size_t>>(std::move(write.sizes));
+  auto callbacks = std::make_shared<std::vector<reply_callback_t>>(std::move(write.callbacks));
+  bool is_rpush  = write.command.front() == "RPUSH";
+
+  send_to_connection(write.command, [sizes, callbacks, is_rpush](reply& reply) {
+    std::int64_t count = 0;
+
+    if (reply.is_integer()) {
+      //! RPUSH: length of the list before the first write, other commands: number of added elements not attributed yet
+      count = reply.as_integer();
+
+      if (is_rpush) {
+        for (std::size_t size : *sizes) {
+          count -= static_cast<std::int64_t>(size);
+        }
+      }
+    }
+
+    for (std::size_t i = 0; i < callbacks->size(); ++i) {
+      std::int64_t size = static_cast<std::int64_t>((*sizes)[i]);
+      std::int64_t value;
+
+      if (is_rpush) {
+        count += size;
+        value = count;
+      }
+      else {
+        value = std::min(size, count);
+        count -= value;
+      }
+
+      const reply_callback_t& callback = (*callbacks)[i];
+
+      if (!callback) {
+        continue;
+      }
+
+      //! errors (network failure, WRONGTYPE, MOVED, ...) are forwarded to every write
+      cpp_redis::reply row = reply.is_integer() ? cpp_redis::reply(value) : reply;
+      callback(row);
+    }
+  });
+}
+
+void
+client::schedule_combined_writes_flush(void) {
+  std::lock_guard<std::mutex> lock(m_combined_writes_mutex);
+
+  if (m_combined_writes_flush_scheduled || m_combined_writes.empty()) {
+    return;
+  }
+
+  if (!m_write_combining_timer) {
+    m_write_combining_timer = std::unique_ptr<timer_executor>(new timer_executor);
+  }
+
+  m_combined_writes_flush_scheduled = true;
+
+  m_write_combining_timer->execute_after(m_write_combining_window, [this]() {
+    {
+      std::lock_guard<std::mutex> lock(m_combined_writes_mutex);
+      m_combined_writes_flush_scheduled = false;
+    }
+
+    flush_combined_writes();
+
+    //! a failed commit flushes the callbacks with an error reply
+    try {
+      commit();
+    }
+    catch (const redis_error&) {
+    }
+  });
+}
+
+//!
+//! writes which may only create the key given as first argument
+//!
+static bool
+is_single_key_write(const std::string& name) {
+  static const std::unordered_set<std::string> single_key_writes = {
+    "APPEND", "DECR", "DECRBY", "GEOADD", "HINCRBY", "HINCRBYFLOAT", "HMSET", "HSET", "HSETNX", "INCR",
+    "INCRBY", "INCRBYFLOAT", "LINSERT", "LPUSH", "LPUSHX", "LSET", "PFADD", "PSETEX", "RPUSH", "RPUSHX",
+    "SADD", "SET", "SETBIT", "SETEX", "SETNX", "SETRANGE", "XADD", "ZADD", "ZINCRBY"};
+
+  return single_key_writes.count(name) != 0;
+}
+
+bool
+client::filter_missing_key(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  if (redis_cmd.empty()) {
+    return false;
+  }
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  bool in_transaction = update_transaction_state(name);
+  bool is_get         = name == "GET" && redis_cmd.size() == 2;
+  bool is_hget        = name == "HGET" && redis_cmd.size() == 3;
+
+  if (!is_get && !is_hget) {
+    add_to_key_filter(name, redis_cmd);
+    return false;
+  }
+
+  //! reads inside a transaction only reply QUEUED
+  if (in_transaction || m_key_filter->may_exist(redis_cmd[1])) {
+    return false;
+  }
+
+  if (callback) {
+    reply null_reply;
+    callback(null_reply);
+  }
+
+  return true;
+}
+
+void
+client::add_to_key_filter(const std::string& name, const std::vector<std::string>& redis_cmd) {
+  //! the filter describes the selected database
+  if (name == "SELECT" || name == "SWAPDB") {
+    m_key_filter->set_ready(false);
+    return;
+  }
+
+  if (redis_cmd.size() < 2 || is_read_only_command(name)) {
+    return;
+  }
+
+  if (is_single_key_write(name)) {
+    m_key_filter->add(redis_cmd[1]);
+    return;
+  }
+
+  //! arguments are not all keys, but adding a few more keys than needed only costs false positives
+  for (std::size_t i = 1; i < redis_cmd.size(); ++i) {
+    m_key_filter->add(redis_cmd[i]);
+  }
+}
+
+//!
+//! positions of the values written by a command: the first one, then every step (0 for a single value)
+//!
+//! \return whether the command writes values
+//!
+static bool
+get_value_positions(const std::string& name, std::size_t& first, std::size_t& step) {
+  step = 0;
+
+  if (name == "SET" || name == "SETNX" || name == "GETSET") {
+    first = 2;
+  }
+  else if (name == "SETEX" || name == "PSETEX" || name == "HSETNX") {
+    first = 3;
+  }
+  else if (name == "MSET" || name == "MSETNX") {
+    first = 2;
+    step  = 2;
+  }
+  else if (name == "HSET" || name == "HMSET") {
+    first = 3;
+    step  = 2;
+  }
+  else {
+    return false;
+  }
+
+  return true;
+}
+
+//!
+//! compress a value, tagged with the magic of the codec
+//!
+//! \return whether the value has to be replaced by the encoded one
+//!
+static bool
+encode_value(const codec_iface& codec, std::size_t min_size, const std::string& value, std::string& encoded) {
+  const std::string& magic = codec.get_magic();
+  bool looks_encoded       = value.compare(0, magic.size(), magic) == 0;
+
+  if (value.size() < min_size && !looks_encoded) {
+    return false;
+  }
+
+  std::string compressed;
+  codec.compress(value, compressed);
+
+  if (magic.size() + compressed.size() >= value.size() && !looks_encoded) {
+    return false;
+  }
+
+  encoded.reserve(magic.size() + compressed.size());
+  encoded.assign(magic);
+  encoded.append(compressed);
+
+  return true;
+}
+
+//!
+//! decompress a value tagged with the magic of the codec
+//!
+static void
+decode_value(const codec_iface& codec, reply& value) {
+  const std::string& magic = codec.get_magic();
+
+  if (!value.is_bulk_string() || value.as_string().compare(0, magic.size(), magic) != 0) {
+    return;
+  }
+
+  std::string decoded;
+
+  try {
+    codec.decompress(value.as_string().data() + magic.size(), value.as_string().size() - magic.size(), decoded);
+    value = {decoded, reply::string_type::bulk_string};
+  }
+  catch (const redis_error& e) {
+    value = {std::string("cpp_redis::client could not decompress value: ") + e.what(), reply::string_type::error};
+  }
+}
+
+void
+client::apply_codec(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, std::vector<std::string>& encoded_cmd, reply_callback_t& decoding_callback) {
+  if (redis_cmd.empty()) {
+    return;
   }
 
-  //! If for some reason sentinel is connected then disconnect now.
-  if (m_sentinel.is_connected()) {
-    m_sentinel.disconnect(true);
+  std::shared_ptr<codec_iface> codec = m_codec;
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  std::size_t first;
+  std::size_t step;
+
+  if (get_value_positions(name, first, step)) {
+    for (std::size_t i = first; i < redis_cmd.size(); i += step ? step : redis_cmd.size()) {
+      std::string encoded;
+
+      if (!encode_value(*codec, m_codec_min_size, redis_cmd[i], encoded)) {
+        continue;
+      }
+
+      if (encoded_cmd.empty()) {
+        encoded_cmd = redis_cmd;
+      }
+
+      encoded_cmd[i] = std::move(encoded);
+    }
   }
 
-  //! disconnect underlying tcp socket
-  if (m_client.is_connected()) {
-    m_client.disconnect(true);
+  bool is_value_read = name == "GET" || name == "GETSET" || name == "GETDEL" || name == "GETEX" || name == "SET" || name == "HGET";
+  bool is_array_read = name == "MGET" || name == "HMGET" || name == "HGETALL";
+
+  if (!callback || (!is_value_read && !is_array_read)) {
+    return;
   }
 
-  __CPP_REDIS_LOG(debug, "cpp_redis::client destroyed");
+  //! HGETALL replies fields and values, only values are compressed
+  bool values_only = name == "HGETALL";
+
+  decoding_callback = [codec, callback, values_only](reply& reply) {
+    if (reply.is_array()) {
+      std::vector<cpp_redis::reply> rows = reply.as_array();
+
+      for (std::size_t i = values_only ? 1 : 0; i < rows.size(); i += values_only ? 2 : 1) {
+        decode_value(*codec, rows[i]);
+      }
+
+      reply = cpp_redis::reply(rows);
+    }
+    else {
+      decode_value(*codec, reply);
+    }
+
+    callback(reply);
+  };
 }
 
 void
-client::connect(
-  const std::string& name,
-  const connect_callback_t& connect_callback,
-  std::uint32_t timeout_msecs,
-  std::int32_t max_reconnects,
-  std::uint32_t reconnect_interval_msecs) {
-  //! Save for auto reconnects
-  m_master_name = name;
-
-  //! We rely on the sentinel to tell us which redis server is currently the master.
-  if (m_sentinel.get_master_addr_by_name(name, m_redis_server, m_redis_port, true)) {
-    connect(m_redis_server, m_redis_port, connect_callback, timeout_msecs, max_reconnects, reconnect_interval_msecs);
+client::invalidate_near_cache(const std::string& name, const std::vector<std::string>& redis_cmd) {
+  //! cached keys belong to the selected database
+  if (name == "SELECT" || name == "SWAPDB" || name == "FLUSHDB" || name == "FLUSHALL") {
+    m_near_cache->clear();
   }
-  else {
-    throw redis_error("cpp_redis::client::connect() could not find master for name " + name);
+  else if (!is_read_only_command(name)) {
+    //! arguments are not all keys, but invalidating a few more keys than needed is harmless
+    for (std::size_t i = 1; i < redis_cmd.size(); ++i) {
+      m_near_cache->invalidate(redis_cmd[i]);
+    }
   }
 }
 
+bool
+client::send_through_near_cache(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, reply_callback_t& filling_callback) {
+  if (redis_cmd.empty()) {
+    return false;
+  }
 
-void
-client::connect(
-  const std::string& host, std::size_t port,
-  const connect_callback_t& connect_callback,
-  std::uint32_t timeout_msecs,
-  std::int32_t max_reconnects,
-  std::uint32_t reconnect_interval_msecs) {
-  __CPP_REDIS_LOG(debug, "cpp_redis::client attempts to connect");
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
 
-  //! Save for auto reconnects
-  m_redis_server             = host;
-  m_redis_port               = port;
-  m_connect_callback         = connect_callback;
-  m_max_reconnects           = max_reconnects;
-  m_reconnect_interval_msecs = reconnect_interval_msecs;
+  bool in_transaction = update_transaction_state(name);
+  bool is_get  = name == "GET" && redis_cmd.size() == 2;
+  bool is_hget = name == "HGET" && redis_cmd.size() == 3;
+  bool is_mget = name == "MGET" && redis_cmd.size() > 1;
 
-  //! notify start
-  if (m_connect_callback) {
-    m_connect_callback(host, port, connect_state::start);
+  if (!is_get && !is_hget && !is_mget) {
+    invalidate_near_cache(name, redis_cmd);
+    return false;
   }
 
-  auto disconnection_handler = std::bind(&client::connection_disconnection_handler, this, std::placeholders::_1);
-  auto receive_handler       = std::bind(&client::connection_receive_handler, this, std::placeholders::_1, std::placeholders::_2);
-  m_client.connect(host, port, disconnection_handler, receive_handler, timeout_msecs);
+  //! reads inside a transaction only reply QUEUED
+  if (in_transaction) {
+    return false;
+  }
 
-  __CPP_REDIS_LOG(info, "cpp_redis::client connected");
+  std::shared_ptr<near_cache> cache = m_near_cache;
 
-  //! notify end
-  if (m_connect_callback) {
-    m_connect_callback(m_redis_server, m_redis_port, connect_state::ok);
+  if (!is_mget) {
+    const std::string& key = redis_cmd[1];
+    std::string signature  = is_get ? "GET" : "HGET " + redis_cmd[2];
+    reply value;
+    std::uint64_t ticket;
+
+    if (cache->lookup(key, signature, value, ticket)) {
+      if (callback) {
+        callback(value);
+      }
+
+      return true;
+    }
+
+    filling_callback = [cache, key, signature, ticket, callback](reply& reply) {
+      cache->fill(key, signature, ticket, reply);
+
+      if (callback) {
+        callback(reply);
+      }
+    };
+
+    return false;
   }
-}
 
-void
-client::disconnect(bool wait_for_removal) {
-  __CPP_REDIS_LOG(debug, "cpp_redis::client attempts to disconnect");
+  //! MGET is served from the cache when all its keys are cached, it fills the GET entries of its keys otherwise
+  std::vector<reply> values(redis_cmd.size() - 1);
+  std::vector<std::uint64_t> tickets(redis_cmd.size() - 1, 0);
+  bool hit = true;
 
-  //! close connection
-  m_client.disconnect(wait_for_removal);
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if (cache->lookup(redis_cmd[i + 1], "GET", values[i], tickets[i])) {
+      tickets[i] = 0;
+    }
+    else {
+      hit = false;
+    }
+  }
 
-  //! make sure we clear buffer of unsent commands
-  clear_callbacks();
+  if (hit) {
+    if (callback) {
+      reply value(values);
+      callback(value);
+    }
 
-  __CPP_REDIS_LOG(info, "cpp_redis::client disconnected");
+    return true;
+  }
+
+  filling_callback = [cache, redis_cmd, tickets, callback](reply& reply) {
+    bool valid = reply.is_array() && reply.as_array().size() == tickets.size();
+
+    for (std::size_t i = 0; i < tickets.size(); ++i) {
+      if (!tickets[i]) {
+        continue;
+      }
+
+      //! MGET replies nil for keys of another type, where GET replies an error: only values are cached
+      if (valid && reply.as_array()[i].is_string()) {
+        cache->fill(redis_cmd[i + 1], "GET", tickets[i], reply.as_array()[i]);
+      }
+      else {
+        cache->cancel(redis_cmd[i + 1], "GET", tickets[i]);
+      }
+    }
+
+    if (callback) {
+      callback(reply);
+    }
+  };
+
+  return false;
 }
 
 bool
-client::is_connected(void) const {
-  return m_client.is_connected();
-}
+client::route_to_secondary_node(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  if (redis_cmd.empty()) {
+    return false;
+  }
 
-void
-client::cancel_reconnect(void) {
-  m_cancel = true;
+  //! all the commands of a transaction must go through the connection that sent MULTI
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  if (update_transaction_state(name)) {
+    return false;
+  }
+
+  //! blocking commands must not hold the master connection
+  if (m_max_blocking_connections && is_blocking_command(redis_cmd)) {
+    std::shared_ptr<client> blocking_node = select_blocking_node();
+
+    if (!blocking_node) {
+      return false;
+    }
+
+    blocking_node->send(redis_cmd, callback);
+    return true;
+  }
+
+  //! read-only commands may be served by a replica
+  if (m_read_policy != read_policy::primary_only && is_read_only_command(redis_cmd)) {
+    std::shared_ptr<client> replica = select_replica();
+
+    if (m_hedge_percentile) {
+      hedged_send(replica, redis_cmd, callback);
+      return true;
+    }
+
+    if (replica) {
+      replica->send(redis_cmd, callback);
+      return true;
+    }
+  }
+
+  return false;
 }
 
 bool
-client::is_reconnecting(void) const {
-  return m_reconnecting;
-}
+client::coalesce_read(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, reply_callback_t& coalescing_callback) {
+  if (redis_cmd.empty()) {
+    return false;
+  }
 
-void
-client::add_sentinel(const std::string& host, std::size_t port, std::uint32_t timeout_msecs) {
-  m_sentinel.add_sentinel(host, port, timeout_msecs);
-}
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
 
-const sentinel&
-client::get_sentinel(void) const {
-  return m_sentinel;
-}
+  bool in_transaction = update_transaction_state(name);
 
-sentinel&
-client::get_sentinel(void) {
-  return m_sentinel;
+  //! reads sent after a write must not get the reply of a read sent before it
+  if (!is_read_only_command(name)) {
+    std::lock_guard<std::mutex> lock(m_inflight_reads_mutex);
+    m_inflight_reads.clear();
+    return false;
+  }
+
+  if (in_transaction) {
+    return false;
+  }
+
+  //! length prefixed arguments, so that different commands never share a key
+  std::string read_key;
+  for (const auto& arg : redis_cmd) {
+    read_key += std::to_string(arg.size()) + ":" + arg;
+  }
+
+  std::lock_guard<std::mutex> lock(m_inflight_reads_mutex);
+
+  auto it = m_inflight_reads.find(read_key);
+  if (it != m_inflight_reads.end()) {
+    it->second->push_back(callback);
+    return true;
+  }
+
+  auto waiters = std::make_shared<std::vector<reply_callback_t>>(1, callback);
+  m_inflight_reads.emplace(read_key, waiters);
+
+  coalescing_callback = [this, read_key, waiters](reply& reply) {
+    //! reads sent from now on get a fresh reply
+    {
+      std::lock_guard<std::mutex> lock(m_inflight_reads_mutex);
+
+      auto it = m_inflight_reads.find(read_key);
+      if (it != m_inflight_reads.end() && it->second == waiters) {
+        m_inflight_reads.erase(it);
+      }
+    }
+
+    //! every waiter gets its own copy, callbacks may modify the reply
+    for (std::size_t i = 0; i < waiters->size(); ++i) {
+      const reply_callback_t& waiter = (*waiters)[i];
+
+      if (!waiter) {
+        continue;
+      }
+
+      if (i + 1 == waiters->size()) {
+        waiter(reply);
+      }
+      else {
+        cpp_redis::reply copy = reply;
+        waiter(copy);
+      }
+    }
+  };
+
+  return false;
 }
 
-void
-client::clear_sentinels(void) {
-  m_sentinel.clear_sentinels();
+bool
+client::update_transaction_state(const std::string& command_name) {
+  if (command_name == "MULTI") {
+    m_in_transaction = true;
+    return true;
+  }
+
+  if (command_name == "EXEC" || command_name == "DISCARD") {
+    m_in_transaction = false;
+    return true;
+  }
+
+  return m_in_transaction;
 }
 
-client&
-client::send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
-  std::lock_guard<std::mutex> lock_callback(m_callbacks_mutex);
+std::shared_ptr<client>
+client::select_blocking_node(void) {
+  std::vector<std::shared_ptr<node_connection>> stale;
+  std::shared_ptr<client> selected;
 
-  __CPP_REDIS_LOG(info, "cpp_redis::client attempts to store new command in the send buffer");
-  unprotected_send(redis_cmd, callback);
-  __CPP_REDIS_LOG(info, "cpp_redis::client stored new command in the send buffer");
+  {
+    std::lock_guard<std::mutex> lock(m_blocking_mutex);
 
-  return *this;
+    std::shared_ptr<node_connection> best;
+    std::size_t best_count = 0;
+
+    for (auto it = m_blocking_nodes.begin(); it != m_blocking_nodes.end();) {
+      //! the master changed (sentinel failover): the connections to the previous one are dropped
+      if ((*it)->host != m_redis_server || (*it)->port != m_redis_port) {
+        stale.push_back(*it);
+        it = m_blocking_nodes.erase(it);
+        continue;
+      }
+
+      const std::shared_ptr<client>& node = (*it)->node;
+
+      if (node->is_connected() && !node->is_reconnecting()) {
+        std::size_t count = node->get_pending_commands_count();
+
+        if (!best || count < best_count) {
+          best       = *it;
+          best_count = count;
+        }
+      }
+
+      ++it;
+    }
+
+    if ((!best || best_count) && m_blocking_nodes.size() < m_max_blocking_connections) {
+      try {
+        auto blocking_node         = std::make_shared<node_connection>();
+        blocking_node->host        = m_redis_server;
+        blocking_node->port        = m_redis_port;
+        blocking_node->node        = connect_node(m_redis_server, m_redis_port, true);
+        blocking_node->uncommitted = false;
+
+        m_blocking_nodes.push_back(blocking_node);
+        best = blocking_node;
+
+        __CPP_REDIS_LOG(info, "cpp_redis::client opened blocking lane connection " + std::to_string(m_blocking_nodes.size()));
+      }
+      catch (const redis_error&) {
+        __CPP_REDIS_LOG(warn, "cpp_redis::client could not open a blocking lane connection");
+      }
+    }
+
+    if (best) {
+      best->uncommitted = true;
+      selected          = best->node;
+    }
+  }
+
+  //! pending blocking commands of stale connections get an error reply
+  for (const auto& blocking_node : stale) {
+    blocking_node->node->disconnect();
+  }
+
+  return selected;
 }
 
 void
 client::unprotected_send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
   m_client.send(redis_cmd);
-  m_commands.push({redis_cmd, callback});
+  m_commands.push_back({redis_cmd, callback, std::chrono::steady_clock::time_point()});
 }
 
 //! commit pipelined transaction
 client&
 client::commit(void) {
+  //! GETs wait for the batching window, or for the batch to be full
+  if (m_batched_gets) {
+    schedule_get_batches_flush();
+  }
+
+  //! and so do the combined writes, or for their command to be full
+  if (m_nb_combined_writes) {
+    schedule_combined_writes_flush();
+  }
+
+  commit_secondary_nodes();
+
   //! no need to call commit in case of reconnection
   //! the reconnection flow will do it for us
   if (!is_reconnecting()) {
@@ -195,21 +1823,62 @@ client::commit(void) {
 
 client&
 client::sync_commit(void) {
+  if (m_nb_combined_writes) {
+    flush_combined_writes();
+  }
+
+  if (m_batched_gets) {
+    flush_get_batches();
+  }
+
+  commit_secondary_nodes();
+
   //! no need to call commit in case of reconnection
   //! the reconnection flow will do it for us
   if (!is_reconnecting()) {
     try_commit();
   }
 
-  std::unique_lock<std::mutex> lock_callback(m_callbacks_mutex);
-  __CPP_REDIS_LOG(debug, "cpp_redis::client waiting for callbacks to complete");
-  m_sync_condvar.wait(lock_callback, [=] { return m_callbacks_running == 0 && m_commands.empty(); });
-  __CPP_REDIS_LOG(debug, "cpp_redis::client finished waiting for callback completion");
+  {
+    std::unique_lock<std::mutex> lock_callback(m_callbacks_mutex);
+    __CPP_REDIS_LOG(debug, "cpp_redis::client waiting for callbacks to complete");
+    spin_before_block(lock_callback);
+    m_sync_condvar.wait(lock_callback, [=] { return m_callbacks_running == 0 && m_commands.empty(); });
+    __CPP_REDIS_LOG(debug, "cpp_redis::client finished waiting for callback completion");
+  }
+
+  wait_for_secondary_nodes(nullptr);
+
   return *this;
 }
 
+void
+client::spin_before_block(std::unique_lock<std::mutex>& lock) {
+  if (!m_connection_options.spin_before_block_usecs) {
+    return;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(m_connection_options.spin_before_block_usecs);
+
+  while ((m_callbacks_running != 0 || !m_commands.empty()) && std::chrono::steady_clock::now() < deadline) {
+    lock.unlock();
+    std::this_thread::yield();
+    lock.lock();
+  }
+}
+
 void
 client::try_commit(void) {
+  {
+    //! latency samples are measured from the write, not from the time the commands were buffered: stamp the commands that were not committed yet (at the back of the queue)
+    std::lock_guard<std::mutex> lock(m_callbacks_mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto it = m_commands.rbegin(); it != m_commands.rend() && it->sent_at == std::chrono::steady_clock::time_point(); ++it) {
+      it->sent_at = now;
+    }
+  }
+
   try {
     __CPP_REDIS_LOG(debug, "cpp_redis::client attempts to send pipelined commands");
     m_client.commit();
@@ -224,28 +1893,54 @@ client::try_commit(void) {
 }
 
 void
-client::connection_receive_handler(network::redis_connection&, reply& reply) {
-  reply_callback_t callback = nullptr;
+client::connection_receive_handler(network::redis_connection&, std::vector<reply>& replies) {
+  std::vector<reply_callback_t> callbacks;
+  callbacks.reserve(replies.size());
 
-  __CPP_REDIS_LOG(info, "cpp_redis::client received reply");
+  __CPP_REDIS_LOG(info, "cpp_redis::client received replies");
   {
     std::lock_guard<std::mutex> lock(m_callbacks_mutex);
-    m_callbacks_running += 1;
+    m_callbacks_running += __CPP_REDIS_LENGTH(replies.size());
+
+    auto now = std::chrono::steady_clock::now();
+
+    while (callbacks.size() < replies.size() && !m_commands.empty()) {
+      //! feed the latency moving average
+      if (m_commands.front().sent_at != std::chrono::steady_clock::time_point()) {
+        double sample = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(now - m_commands.front().sent_at).count());
+        m_latency_ewma.add_sample(sample);
+        add_latency_sample(sample);
+      }
 
-    if (m_commands.size()) {
-      callback = m_commands.front().callback;
-      m_commands.pop();
+      callbacks.push_back(std::move(m_commands.front().callback));
+      m_commands.pop_front();
     }
+
+    m_latency_usecs = static_cast<std::uint64_t>(m_latency_ewma.get());
   }
 
-  if (callback) {
-    __CPP_REDIS_LOG(debug, "cpp_redis::client executes reply callback");
-    callback(reply);
+  if (!m_callbacks_executor) {
+    run_callbacks(callbacks, replies);
+    return;
+  }
+
+  auto batch = std::make_shared<std::pair<std::vector<reply_callback_t>, std::vector<reply>>>(std::move(callbacks), std::move(replies));
+  m_callbacks_executor->execute([this, batch]() { run_callbacks(batch->first, batch->second); });
+}
+
+void
+client::run_callbacks(std::vector<reply_callback_t>& callbacks, std::vector<reply>& replies) {
+  //! a throwing callback must neither skip the next ones nor leave m_callbacks_running incremented (sync_commit and the dtor would wait forever)
+  for (std::size_t i = 0; i < callbacks.size(); ++i) {
+    if (callbacks[i]) {
+      __CPP_REDIS_LOG(debug, "cpp_redis::client executes reply callback");
+      run_task([&] { callbacks[i](replies[i]); });
+    }
   }
 
   {
     std::lock_guard<std::mutex> lock(m_callbacks_mutex);
-    m_callbacks_running -= 1;
+    m_callbacks_running -= __CPP_REDIS_LENGTH(replies.size());
     m_sync_condvar.notify_all();
   }
 }
@@ -257,26 +1952,41 @@ client::clear_callbacks(void) {
   }
 
   //! dequeue commands and move them to a local variable
-  std::queue<command_request> commands = std::move(m_commands);
+  auto commands = std::make_shared<std::queue<command_request>>(std::move(m_commands));
 
-  m_callbacks_running += __CPP_REDIS_LENGTH(commands.size());
+  m_callbacks_running += __CPP_REDIS_LENGTH(commands->size());
 
-  std::thread t([=]() mutable {
-    while (!commands.empty()) {
-      const auto& callback = commands.front().callback;
+  //! never run the failure callbacks in the calling thread: we may be holding m_callbacks_mutex
+  auto fail_commands = [this, commands]() {
+    while (!commands->empty()) {
+      const auto& callback = commands->front().callback;
 
       if (callback) {
         reply r = {"network failure", reply::string_type::error};
-        callback(r);
+        run_task([&] { callback(r); });
       }
 
       --m_callbacks_running;
-      commands.pop();
+      commands->pop();
     }
 
+    std::lock_guard<std::mutex> lock(m_callbacks_mutex);
     m_sync_condvar.notify_all();
-  });
-  t.detach();
+  };
+
+  if (m_callbacks_executor) {
+    m_callbacks_executor->execute(fail_commands);
+    return;
+  }
+
+  //! without executor, each client has its own failure thread: a failure callback blocking on another client (sync_commit, future.get()) must not hold back the failures of every other client
+  std::lock_guard<std::mutex> lock(m_failure_executor_mutex);
+
+  if (!m_failure_executor) {
+    m_failure_executor = std::unique_ptr<thread_pool_executor>(new thread_pool_executor(1));
+  }
+
+  m_failure_executor->execute(fail_commands);
 }
 
 void
@@ -286,7 +1996,7 @@ client::resend_failed_commands(void) {
   }
 
   //! dequeue commands and move them to a local variable
-  std::queue<command_request> commands = std::move(m_commands);
+  std::queue<command_request> commands(std::move(m_commands));
 
   while (commands.size() > 0) {
     //! Reissue the pending command and its callback.
@@ -400,7 +2110,7 @@ client::reconnect(void) {
 
   //! Try catch block because the redis client throws an error if connection cannot be made.
   try {
-    connect(m_redis_server, m_redis_port, m_connect_callback, m_connect_timeout_msecs, m_max_reconnects, m_reconnect_interval_msecs);
+    connect(m_redis_server, m_redis_port, m_connect_callback, m_connect_timeout_msecs, m_max_reconnects, m_reconnect_interval_msecs, m_connection_options);
   }
   catch (...) {
   }
@@ -995,7 +2705,7 @@ client::georadius(const std::string& key, double longitude, double latitude, dou
 
 client&
 client::georadius(const std::string& key, double longitude, double latitude, double radius, geo_unit unit, bool with_coord, bool with_dist, bool with_hash, bool asc_order, std::size_t count, const std::string& store_key, const std::string& storedist_key, const reply_callback_t& reply_callback) {
-  std::vector<std::string> cmd = {"GEORADIUS", key, std::to_string(longitude), std::to_string(latitude), std::to_string(radius), geo_unit_to_string(unit)};
+  std::vector<std::string> cmd = {"GEORADIUS", key, to_redis_string(longitude), to_redis_string(latitude), to_redis_string(radius), geo_unit_to_string(unit)};
 
   //! with_coord (optional)
   if (with_coord) {
@@ -1064,7 +2774,7 @@ client::georadiusbymember(const std::string& key, const std::string& member, dou
 
 client&
 client::georadiusbymember(const std::string& key, const std::string& member, double radius, geo_unit unit, bool with_coord, bool with_dist, bool with_hash, bool asc_order, std::size_t count, const std::string& store_key, const std::string& storedist_key, const reply_callback_t& reply_callback) {
-  std::vector<std::string> cmd = {"GEORADIUSBYMEMBER", key, member, std::to_string(radius), geo_unit_to_string(unit)};
+  std::vector<std::string> cmd = {"GEORADIUSBYMEMBER", key, member, to_redis_string(radius), geo_unit_to_string(unit)};
 
   //! with_coord (optional)
   if (with_coord) {
@@ -1163,8 +2873,8 @@ client::hincrby(const std::string& key, const std::string& field, int incr, cons
 }
 
 client&
-client::hincrbyfloat(const std::string& key, const std::string& field, float incr, const reply_callback_t& reply_callback) {
-  send({"HINCRBYFLOAT", key, field, std::to_string(incr)}, reply_callback);
+client::hincrbyfloat(const std::string& key, const std::string& field, double incr, const reply_callback_t& reply_callback) {
+  send({"HINCRBYFLOAT", key, field, to_redis_string(incr)}, reply_callback);
   return *this;
 }
 
@@ -1269,8 +2979,8 @@ client::incrby(const std::string& key, int incr, const reply_callback_t& reply_c
 }
 
 client&
-client::incrbyfloat(const std::string& key, float incr, const reply_callback_t& reply_callback) {
-  send({"INCRBYFLOAT", key, std::to_string(incr)}, reply_callback);
+client::incrbyfloat(const std::string& key, double incr, const reply_callback_t& reply_callback) {
+  send({"INCRBYFLOAT", key, to_redis_string(incr)}, reply_callback);
   return *this;
 }
 
@@ -1698,6 +3408,15 @@ client::sdiffstore(const std::string& destination, const std::vector<std::string
 
 client&
 client::select(int index, const reply_callback_t& reply_callback) {
+  //! SELECT does not go through send(): the near cache and the key filter describe the previous database
+  if (m_near_cache) {
+    m_near_cache->clear();
+  }
+
+  if (m_key_filter) {
+    m_key_filter->set_ready(false);
+  }
+
   std::lock_guard<std::mutex> lock(m_callbacks_mutex);
 
   unprotected_select(index, reply_callback);
@@ -2102,7 +3821,7 @@ client::zincrby(const std::string& key, int incr, const std::string& member, con
 
 client&
 client::zincrby(const std::string& key, double incr, const std::string& member, const reply_callback_t& reply_callback) {
-  send({"ZINCRBY", key, std::to_string(incr), member}, reply_callback);
+  send({"ZINCRBY", key, to_redis_string(incr), member}, reply_callback);
   return *this;
 }
 
@@ -3126,7 +4845,7 @@ client::hincrby(const std::string& key, const std::string& field, int incr) {
 }
 
 std::future<reply>
-client::hincrbyfloat(const std::string& key, const std::string& field, float incr) {
+client::hincrbyfloat(const std::string& key, const std::string& field, double incr) {
   return exec_cmd([=](const reply_callback_t& cb) -> client& { return hincrbyfloat(key, field, incr, cb); });
 }
 
@@ -3201,7 +4920,7 @@ client::incrby(const std::string& key, int incr) {
 }
 
 std::future<reply>
-client::incrbyfloat(const std::string& key, float incr) {
+client::incrbyfloat(const std::string& key, double incr) {
   return exec_cmd([=](const reply_callback_t& cb) -> client& { return incrbyfloat(key, incr, cb); });
 }
 
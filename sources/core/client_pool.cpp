@@ -0,0 +1,325 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/client_pool.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+#include <limits>
+
+namespace cpp_redis {
+
+#ifndef __CPP_REDIS_USE_CUSTOM_TCP_CLIENT
+client_pool::client_pool(std::size_t nb_connections, routing_policy policy)
+: m_policy(policy)
+, m_next_client(0) {
+  if (!nb_connections) {
+    throw redis_error("cpp_redis::client_pool needs at least one connection");
+  }
+
+  for (std::size_t i = 0; i < nb_connections; ++i) {
+    m_clients.push_back(std::unique_ptr<client>(new client));
+  }
+
+  m_uncommitted.resize(nb_connections, false);
+  __CPP_REDIS_LOG(debug, "cpp_redis::client_pool created");
+}
+#endif /* __CPP_REDIS_USE_CUSTOM_TCP_CLIENT */
+
+client_pool::client_pool(std::size_t nb_connections, const std::function<std::shared_ptr<network::tcp_client_iface>(void)>& tcp_client_factory, routing_policy policy)
+: m_policy(policy)
+, m_next_client(0) {
+  if (!nb_connections) {
+    throw redis_error("cpp_redis::client_pool needs at least one connection");
+  }
+
+  for (std::size_t i = 0; i < nb_connections; ++i) {
+    m_clients.push_back(std::unique_ptr<client>(new client(tcp_client_factory())));
+  }
+
+  m_uncommitted.resize(nb_connections, false);
+  __CPP_REDIS_LOG(debug, "cpp_redis::client_pool created");
+}
+
+void
+client_pool::connect(
+  const std::string& host, std::size_t port,
+  const client::connect_callback_t& connect_callback,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::client_pool attempts to connect");
+
+  for (const auto& client : m_clients) {
+    client->connect(host, port, connect_callback, timeout_msecs, max_reconnects, reconnect_interval_msecs, options);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::client_pool connected");
+}
+
+bool
+client_pool::is_connected(void) const {
+  for (const auto& client : m_clients) {
+    if (!client->is_connected()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+client_pool::disconnect(bool wait_for_removal) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::client_pool attempts to disconnect");
+
+  for (const auto& client : m_clients) {
+    client->disconnect(wait_for_removal);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::client_pool disconnected");
+}
+
+void
+client_pool::cancel_reconnect(void) {
+  for (const auto& client : m_clients) {
+    client->cancel_reconnect();
+  }
+}
+
+void
+client_pool::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  for (const auto& client : m_clients) {
+    client->set_executor(executor);
+  }
+}
+
+std::size_t
+client_pool::size(void) const {
+  return m_clients.size();
+}
+
+void
+client_pool::set_hedging(double percentile, std::chrono::microseconds min_delay) {
+  //! the clients measure their own latency percentiles: they have no replica to hedge to themselves
+  for (const auto& client : m_clients) {
+    client->set_hedging(percentile, min_delay);
+  }
+
+  m_hedging = percentile > 0 && percentile < 100 && m_clients.size() > 1;
+}
+
+std::size_t
+client_pool::select_client(void) {
+  std::size_t nb_clients = m_clients.size();
+  std::size_t index      = m_next_client++ % nb_clients;
+
+  if (m_policy == routing_policy::least_inflight) {
+    //! start from the round robin position so that ties are spread over the pool
+    std::size_t best_count = std::numeric_limits<std::size_t>::max();
+    std::size_t start      = index;
+
+    for (std::size_t i = 0; i < nb_clients; ++i) {
+      std::size_t candidate = (start + i) % nb_clients;
+      client& c             = *m_clients[candidate];
+
+      //! clients being reconnected are only used if no other client is available
+      std::size_t count = c.get_pending_commands_count();
+      if (!c.is_connected() || c.is_reconnecting()) {
+        count = std::numeric_limits<std::size_t>::max() - 1;
+      }
+
+      if (count < best_count) {
+        best_count = count;
+        index      = candidate;
+      }
+
+      if (!best_count) {
+        break;
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+  m_uncommitted[index] = true;
+
+  return index;
+}
+
+client&
+client_pool::get_client(void) {
+  return *m_clients[select_client()];
+}
+
+client&
+client_pool::get_client(std::size_t index) {
+  if (index >= m_clients.size()) {
+    throw redis_error("cpp_redis::client_pool::get_client() index out of range");
+  }
+
+  std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+  m_uncommitted[index] = true;
+
+  return *m_clients[index];
+}
+
+client_pool&
+client_pool::send(const std::vector<std::string>& redis_cmd, const client::reply_callback_t& callback) {
+  if (m_hedging && is_read_only_command(redis_cmd)) {
+    hedged_send(select_client(), redis_cmd, callback);
+  }
+  else {
+    get_client().send(redis_cmd, callback);
+  }
+
+  return *this;
+}
+
+std::future<reply>
+client_pool::send(const std::vector<std::string>& redis_cmd) {
+  auto prms = std::make_shared<std::promise<reply>>();
+
+  send(redis_cmd, [prms](reply& reply) {
+    prms->set_value(reply);
+  });
+
+  return prms->get_future();
+}
+
+void
+client_pool::hedged_send(std::size_t index, const std::vector<std::string>& redis_cmd, const client::reply_callback_t& callback) {
+  auto done = std::make_shared<std::atomic_bool>(false);
+
+  client::reply_callback_t first_reply = [done, callback](reply& reply) {
+    //! the loser reply is dropped
+    if (!done->exchange(true) && callback) {
+      callback(reply);
+    }
+  };
+
+  client& primary = *m_clients[index];
+  primary.send(redis_cmd, first_reply);
+
+  //! no hedge until enough replies were received to know what a slow reply is
+  std::chrono::microseconds delay = primary.get_hedge_delay();
+
+  if (!delay.count()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_hedge_mutex);
+
+  if (!m_hedge_timer) {
+    m_hedge_timer = std::unique_ptr<timer_executor>(new timer_executor);
+  }
+
+  m_hedge_timer->execute_after(delay, [this, index, redis_cmd, done, first_reply]() {
+    if (*done) {
+      return;
+    }
+
+    //! least loaded other client that can take the command right away
+    std::size_t best_count = std::numeric_limits<std::size_t>::max();
+    client* target         = nullptr;
+
+    for (std::size_t i = 0; i < m_clients.size(); ++i) {
+      client& c = *m_clients[i];
+
+      if (i == index || !c.is_connected() || c.is_reconnecting()) {
+        continue;
+      }
+
+      std::size_t count = c.get_pending_commands_count();
+
+      if (count < best_count) {
+        best_count = count;
+        target     = &c;
+      }
+    }
+
+    if (!target) {
+      return;
+    }
+
+    __CPP_REDIS_LOG(debug, "cpp_redis::client_pool sends hedged read");
+    target->send(redis_cmd, first_reply);
+
+    //! a failed commit flushes the callbacks with an error reply
+    try {
+      target->commit();
+    }
+    catch (const redis_error&) {
+    }
+  });
+}
+
+client_pool&
+client_pool::commit(void) {
+  std::vector<bool> uncommitted(m_clients.size(), false);
+
+  {
+    std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+    std::swap(uncommitted, m_uncommitted);
+  }
+
+  //! a client failing to commit must not prevent the others from sending their commands
+  bool failed = false;
+  std::string error;
+
+  for (std::size_t i = 0; i < m_clients.size(); ++i) {
+    if (!uncommitted[i]) {
+      continue;
+    }
+
+    try {
+      m_clients[i]->commit();
+    }
+    catch (const redis_error& e) {
+      if (!failed) {
+        failed = true;
+        error  = e.what();
+      }
+    }
+  }
+
+  if (failed) {
+    __CPP_REDIS_LOG(error, "cpp_redis::client_pool could not send pipelined commands");
+    throw redis_error(error);
+  }
+
+  return *this;
+}
+
+client_pool&
+client_pool::sync_commit(void) {
+  commit();
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::client_pool waiting for callbacks to complete");
+  for (const auto& client : m_clients) {
+    client->sync_commit();
+  }
+  __CPP_REDIS_LOG(debug, "cpp_redis::client_pool finished waiting for callback completion");
+
+  return *this;
+}
+
+} // namespace cpp_redis
@@ -0,0 +1,643 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/cluster_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace cpp_redis {
+
+//!
+//! split a host:port address
+//!
+static void
+split_address(const std::string& addr, std::string& host, std::size_t& port) {
+  std::size_t pos = addr.rfind(':');
+
+  if (pos == std::string::npos) {
+    throw redis_error("cpp_redis::cluster_client invalid node address " + addr);
+  }
+
+  host = addr.substr(0, pos);
+  port = std::stoul(addr.substr(pos + 1));
+}
+
+cluster_client::cluster_client(void)
+: m_nb_moved_slots(0)
+, m_refreshing(false)
+, m_stopping(false)
+, m_pending(0) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client created");
+}
+
+cluster_client::~cluster_client(void) {
+  m_stopping = true;
+
+  //! disconnecting flushes the callbacks of the commands still in flight
+  disconnect(true);
+
+  std::unique_lock<std::mutex> lock(m_pending_mutex);
+  m_pending_condvar.wait(lock, [=] { return m_pending == 0 && !m_refreshing; });
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client destroyed");
+}
+
+void
+cluster_client::connect(
+  const std::string& host, std::size_t port,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client attempts to connect");
+
+  m_connect_timeout_msecs    = timeout_msecs;
+  m_max_reconnects           = max_reconnects;
+  m_reconnect_interval_msecs = reconnect_interval_msecs;
+  m_connection_options       = options;
+  m_seed_node                = host + ":" + std::to_string(port);
+
+  refresh_slots();
+
+  __CPP_REDIS_LOG(info, "cpp_redis::cluster_client connected");
+}
+
+bool
+cluster_client::is_connected(void) {
+  std::lock_guard<std::mutex> lock(m_nodes_mutex);
+
+  for (const auto& node : m_nodes) {
+    if (node.second->client->is_connected()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+cluster_client::disconnect(bool wait_for_removal) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client attempts to disconnect");
+
+  std::vector<client*> clients;
+
+  {
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+
+    for (const auto& node : m_nodes) {
+      node.second->client->cancel_reconnect();
+      clients.push_back(node.second->client.get());
+    }
+  }
+
+  //! nodes are never removed from m_nodes: the clients can be used without the lock
+  for (auto client : clients) {
+    client->disconnect(wait_for_removal);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::cluster_client disconnected");
+}
+
+void
+cluster_client::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  std::lock_guard<std::mutex> lock(m_nodes_mutex);
+  m_executor = executor;
+
+  for (const auto& node : m_nodes) {
+    node.second->client->set_executor(executor);
+  }
+}
+
+void
+cluster_client::set_get_batching(std::size_t max_keys, std::chrono::microseconds window) {
+  std::lock_guard<std::mutex> lock(m_nodes_mutex);
+  m_get_batch_max_keys = max_keys;
+  m_get_batch_window   = window;
+
+  for (const auto& node : m_nodes) {
+    node.second->client->set_get_batching(max_keys, window, true);
+  }
+}
+
+void
+cluster_client::set_write_combining(std::size_t max_elements, std::chrono::microseconds window) {
+  std::lock_guard<std::mutex> lock(m_nodes_mutex);
+  m_write_combining_max_elements = max_elements;
+  m_write_combining_window       = window;
+
+  for (const auto& node : m_nodes) {
+    node.second->client->set_write_combining(max_elements, window);
+  }
+}
+
+std::string
+cluster_client::get_node_for_slot(std::uint16_t slot) const {
+  if (m_nb_moved_slots) {
+    std::lock_guard<std::mutex> lock(m_moved_slots_mutex);
+    auto it = m_moved_slots.find(slot);
+
+    if (it != m_moved_slots.end()) {
+      return it->second;
+    }
+  }
+
+  std::shared_ptr<const slot_map_t> slots = std::atomic_load(&m_slots);
+
+  if (slots) {
+    const std::string& addr = (*slots)[slot];
+
+    if (!addr.empty()) {
+      return addr;
+    }
+  }
+
+  return m_seed_node;
+}
+
+std::string
+cluster_client::get_node_for_key(const std::string& key) const {
+  return get_node_for_slot(hash_slot(key));
+}
+
+std::string
+cluster_client::get_node_for_command(const std::vector<std::string>& redis_cmd) const {
+  std::string key;
+
+  if (!get_command_key(redis_cmd, key)) {
+    return m_seed_node;
+  }
+
+  return get_node_for_key(key);
+}
+
+cluster_client::node&
+cluster_client::get_node(const std::string& addr) {
+  std::shared_ptr<executor_iface> executor;
+  std::size_t get_batch_max_keys;
+  std::chrono::microseconds get_batch_window;
+  std::size_t write_combining_max_elements;
+  std::chrono::microseconds write_combining_window;
+
+  {
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+
+    auto it = m_nodes.find(addr);
+    if (it != m_nodes.end()) {
+      return *it->second;
+    }
+
+    executor                     = m_executor;
+    get_batch_max_keys           = m_get_batch_max_keys;
+    get_batch_window             = m_get_batch_window;
+    write_combining_max_elements = m_write_combining_max_elements;
+    write_combining_window       = m_write_combining_window;
+  }
+
+  std::unique_ptr<node> new_node(new node);
+  new_node->client = std::unique_ptr<client>(new client);
+  new_node->client->set_executor(executor);
+  new_node->client->set_get_batching(get_batch_max_keys, get_batch_window, true);
+  new_node->client->set_write_combining(write_combining_max_elements, write_combining_window);
+
+  std::string host;
+  std::size_t port;
+  split_address(addr, host, port);
+
+  //! connecting blocks: do it without the lock so that the traffic to the other nodes keeps flowing
+  __CPP_REDIS_LOG(info, "cpp_redis::cluster_client connects to node " + addr);
+  new_node->client->connect(host, port, nullptr, m_connect_timeout_msecs, m_max_reconnects, m_reconnect_interval_msecs, m_connection_options);
+
+  std::lock_guard<std::mutex> lock(m_nodes_mutex);
+
+  //! another thread may have connected to the same node meanwhile: keep its connection, ours is closed once the lock is released
+  auto it = m_nodes.find(addr);
+  if (it == m_nodes.end()) {
+    it = m_nodes.emplace(addr, std::move(new_node)).first;
+  }
+
+  return *it->second;
+}
+
+client&
+cluster_client::get_client_for_key(const std::string& key) {
+  std::string addr = get_node_for_key(key);
+  node& n          = get_node(addr);
+
+  std::lock_guard<std::mutex> lock(m_nodes_mutex);
+  m_uncommitted_nodes.insert(addr);
+
+  return *n.client;
+}
+
+cluster_client&
+cluster_client::send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  {
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    ++m_pending;
+  }
+
+  try {
+    if (!scatter_send(redis_cmd, callback)) {
+      send_to_node(get_node_for_command(redis_cmd), redis_cmd, callback, 0, false, false);
+    }
+  }
+  catch (const redis_error&) {
+    command_done();
+    throw;
+  }
+
+  return *this;
+}
+
+std::future<reply>
+cluster_client::send(const std::vector<std::string>& redis_cmd) {
+  auto prms = std::make_shared<std::promise<reply>>();
+
+  send(redis_cmd, [prms](reply& reply) {
+    prms->set_value(reply);
+  });
+
+  return prms->get_future();
+}
+
+void
+cluster_client::send_to_node(const std::string& addr, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, unsigned int nb_redirections, bool asking, bool commit) {
+  node& n = get_node(addr);
+
+  auto redirect_callback = [this, addr, redis_cmd, callback, nb_redirections](reply& reply) {
+    if (reply.is_error() && nb_redirections < __CPP_REDIS_CLUSTER_MAX_REDIRECTIONS && !m_stopping) {
+      //! MOVED <slot> <host>:<port> or ASK <slot> <host>:<port>
+      std::istringstream error(reply.error());
+      std::string type;
+      std::size_t slot = __CPP_REDIS_CLUSTER_SLOTS;
+      std::string target;
+      error >> type >> slot >> target;
+
+      if ((type == "MOVED" || type == "ASK") && slot < __CPP_REDIS_CLUSTER_SLOTS && !target.empty()) {
+        //! an empty host means the host of the node that replied
+        if (target[0] == ':') {
+          target = addr.substr(0, addr.rfind(':')) + target;
+        }
+
+        __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client follows " + type + " redirection to " + target);
+
+        if (type == "MOVED") {
+          update_slot(static_cast<std::uint16_t>(slot), target);
+          async_refresh_slots();
+        }
+
+        bool asking = type == "ASK";
+        std::shared_ptr<executor_iface> executor;
+
+        {
+          std::lock_guard<std::mutex> lock(m_nodes_mutex);
+
+          if (!m_nodes.count(target)) {
+            executor = m_executor ? m_executor : get_background_executor();
+          }
+        }
+
+        if (!executor) {
+          if (follow_redirection(target, redis_cmd, callback, nb_redirections + 1, asking)) {
+            return;
+          }
+        }
+        else {
+          //! connecting to a new node blocks: do not stall the thread delivering the replies of this node
+          executor->execute([=]() mutable {
+            if (m_stopping || !follow_redirection(target, redis_cmd, callback, nb_redirections + 1, asking)) {
+              if (callback) {
+                run_task([&] { callback(reply); });
+              }
+
+              command_done();
+            }
+          });
+          return;
+        }
+      }
+    }
+
+    //! a throwing callback must not leave the command pending: sync_commit() and the dtor would wait forever
+    if (callback) {
+      run_task([&] { callback(reply); });
+    }
+
+    command_done();
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(n.send_mutex);
+
+    if (asking) {
+      n.client->send({"ASKING"}, nullptr);
+    }
+
+    n.client->send(redis_cmd, redirect_callback);
+  }
+
+  if (!commit) {
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+    m_uncommitted_nodes.insert(addr);
+    return;
+  }
+
+  //! a failed commit flushes the callbacks with an error reply, nothing more to do here
+  try {
+    n.client->commit();
+  }
+  catch (const redis_error&) {
+    __CPP_REDIS_LOG(error, "cpp_redis::cluster_client could not send redirected command to " + addr);
+  }
+}
+
+bool
+cluster_client::follow_redirection(const std::string& addr, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback, unsigned int nb_redirections, bool asking) {
+  try {
+    send_to_node(addr, redis_cmd, callback, nb_redirections, asking, true);
+    return true;
+  }
+  catch (const std::exception&) {
+    __CPP_REDIS_LOG(error, "cpp_redis::cluster_client could not follow redirection to " + addr);
+    return false;
+  }
+}
+
+bool
+cluster_client::scatter_send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  auto parts = split_multi_key_command(redis_cmd, [](const std::string& key) -> std::size_t { return hash_slot(key); });
+
+  if (parts.size() < 2) {
+    return false;
+  }
+
+  auto merger = std::make_shared<multi_key_reply_merger>(redis_cmd, parts.size(), callback);
+
+  //! the whole command is already counted as pending: count the additional parts
+  {
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    m_pending += parts.size() - 1;
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client splits " + redis_cmd[0] + " over " + std::to_string(parts.size()) + " slots");
+
+  for (const auto& slot : parts) {
+    auto part          = std::make_shared<multi_key_command_part>(slot.second);
+    auto part_callback = [merger, part](reply& reply) { merger->add_reply(*part, reply); };
+
+    try {
+      send_to_node(get_node_for_slot(static_cast<std::uint16_t>(slot.first)), part->command, part_callback, 0, false, false);
+    }
+    catch (const std::exception& e) {
+      //! the other parts are already queued: report the failure through the merged reply
+      reply error(e.what(), reply::string_type::error);
+      run_task([&] { part_callback(error); });
+      command_done();
+    }
+  }
+
+  return true;
+}
+
+cluster_client&
+cluster_client::commit(void) {
+  std::set<std::string> uncommitted;
+  std::vector<client*> clients;
+
+  {
+    std::lock_guard<std::mutex> lock(m_nodes_mutex);
+    std::swap(uncommitted, m_uncommitted_nodes);
+
+    for (const auto& addr : uncommitted) {
+      clients.push_back(m_nodes[addr]->client.get());
+    }
+  }
+
+  //! a node failing to commit must not prevent the others from sending their commands
+  bool failed = false;
+  std::string error;
+
+  for (auto client : clients) {
+    try {
+      client->commit();
+    }
+    catch (const redis_error& e) {
+      if (!failed) {
+        failed = true;
+        error  = e.what();
+      }
+    }
+  }
+
+  if (failed) {
+    __CPP_REDIS_LOG(error, "cpp_redis::cluster_client could not send pipelined commands");
+    throw redis_error(error);
+  }
+
+  return *this;
+}
+
+cluster_client&
+cluster_client::sync_commit(void) {
+  commit();
+
+  std::unique_lock<std::mutex> lock(m_pending_mutex);
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client waiting for callbacks to complete");
+  m_pending_condvar.wait(lock, [=] { return m_pending == 0; });
+  __CPP_REDIS_LOG(debug, "cpp_redis::cluster_client finished waiting for callback completion");
+
+  return *this;
+}
+
+void
+cluster_client::command_done(void) {
+  std::lock_guard<std::mutex> lock(m_pending_mutex);
+  --m_pending;
+  m_pending_condvar.notify_all();
+}
+
+std::shared_ptr<const cluster_client::slot_map_t>
+cluster_client::parse_slots(const reply& reply, const std::string& default_host) {
+  if (!reply.is_array()) {
+    return nullptr;
+  }
+
+  std::shared_ptr<slot_map_t> slots = std::make_shared<slot_map_t>(__CPP_REDIS_CLUSTER_SLOTS);
+
+  //! each entry: start slot, end slot, master [host, port, id], replicas...
+  for (const auto& range : reply.as_array()) {
+    if (!range.is_array() || range.as_array().size() < 3) {
+      return nullptr;
+    }
+
+    const auto& fields = range.as_array();
+    if (!fields[0].is_integer() || !fields[1].is_integer() || !fields[2].is_array() || fields[2].as_array().size() < 2) {
+      return nullptr;
+    }
+
+    const auto& master = fields[2].as_array();
+    if (!master[0].is_string() || !master[1].is_integer()) {
+      return nullptr;
+    }
+
+    std::string host = master[0].as_string().empty() ? default_host : master[0].as_string();
+    std::string addr = host + ":" + std::to_string(master[1].as_integer());
+
+    int64_t start = std::max<int64_t>(fields[0].as_integer(), 0);
+    int64_t end   = std::min<int64_t>(fields[1].as_integer(), __CPP_REDIS_CLUSTER_SLOTS - 1);
+
+    for (int64_t slot = start; slot <= end; ++slot) {
+      (*slots)[static_cast<std::size_t>(slot)] = addr;
+    }
+  }
+
+  return slots;
+}
+
+void
+cluster_client::refresh_slots(void) {
+  std::string host;
+  std::size_t port;
+  split_address(m_seed_node, host, port);
+
+  client& seed = *get_node(m_seed_node).client;
+  auto future  = seed.cluster_slots();
+  seed.sync_commit();
+
+  reply slots_reply = future.get();
+  if (slots_reply.is_error()) {
+    throw redis_error("cpp_redis::cluster_client could not load slot map: " + slots_reply.error());
+  }
+
+  auto slots = parse_slots(slots_reply, host);
+  if (!slots) {
+    throw redis_error("cpp_redis::cluster_client could not load slot map: invalid CLUSTER SLOTS reply");
+  }
+
+  set_slots(slots);
+  __CPP_REDIS_LOG(info, "cpp_redis::cluster_client loaded slot map");
+}
+
+void
+cluster_client::async_refresh_slots(void) {
+  if (m_refreshing.exchange(true)) {
+    return;
+  }
+
+  //! run from the background executor: we may be called from a reply callback, on a network thread
+  get_background_executor()->execute([this]() {
+    if (m_stopping) {
+      refresh_done();
+      return;
+    }
+
+    //! ask the first connected node, starting with the one we connected through
+    std::string addr;
+    client* node_client = nullptr;
+
+    {
+      std::lock_guard<std::mutex> lock(m_nodes_mutex);
+      auto seed = m_nodes.find(m_seed_node);
+
+      if (seed != m_nodes.end() && seed->second->client->is_connected()) {
+        addr        = seed->first;
+        node_client = seed->second->client.get();
+      }
+
+      for (auto it = m_nodes.begin(); !node_client && it != m_nodes.end(); ++it) {
+        if (it->second->client->is_connected()) {
+          addr        = it->first;
+          node_client = it->second->client.get();
+        }
+      }
+    }
+
+    if (!node_client) {
+      __CPP_REDIS_LOG(warn, "cpp_redis::cluster_client can not refresh slot map: no node connected");
+      refresh_done();
+      return;
+    }
+
+    std::string host = addr.substr(0, addr.rfind(':'));
+
+    //! the reply may arrive before commit() returns: the refresh is only done once both completed, the dtor could otherwise destroy the node while we are still committing
+    auto remaining = std::make_shared<std::atomic<int>>(2);
+
+    try {
+      node_client->cluster_slots([this, host, remaining](reply& reply) {
+        auto slots = parse_slots(reply, host);
+
+        if (slots) {
+          set_slots(slots);
+          __CPP_REDIS_LOG(info, "cpp_redis::cluster_client refreshed slot map");
+        }
+        else {
+          __CPP_REDIS_LOG(warn, "cpp_redis::cluster_client could not refresh slot map");
+        }
+
+        if (--*remaining == 0) {
+          refresh_done();
+        }
+      });
+      node_client->commit();
+    }
+    catch (const redis_error&) {
+      //! the failed commit flushed the callback with an error reply
+      __CPP_REDIS_LOG(warn, "cpp_redis::cluster_client could not refresh slot map");
+    }
+
+    if (--*remaining == 0) {
+      refresh_done();
+    }
+  });
+}
+
+void
+cluster_client::refresh_done(void) {
+  std::lock_guard<std::mutex> lock(m_pending_mutex);
+  m_refreshing = false;
+  m_pending_condvar.notify_all();
+}
+
+void
+cluster_client::update_slot(std::uint16_t slot, const std::string& addr) {
+  std::lock_guard<std::mutex> lock(m_moved_slots_mutex);
+  m_moved_slots[slot] = addr;
+  m_nb_moved_slots    = m_moved_slots.size();
+}
+
+void
+cluster_client::set_slots(const std::shared_ptr<const slot_map_t>& slots) {
+  std::atomic_store(&m_slots, slots);
+
+  //! a MOVED received while the refresh was in flight may be dropped here: it costs one more redirection at worst
+  std::lock_guard<std::mutex> lock(m_moved_slots_mutex);
+  m_moved_slots.clear();
+  m_nb_moved_slots = 0;
+}
+
+} // namespace cpp_redis
@@ -0,0 +1,247 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/counter_aggregator.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+#include <functional>
+#include <thread>
+
+namespace cpp_redis {
+
+counter_aggregator::counter_aggregator(
+  const std::shared_ptr<client>& connection,
+  std::chrono::milliseconds flush_interval,
+  std::size_t max_pending_keys,
+  std::size_t nb_shards)
+: m_connection(connection)
+, m_flush_interval(flush_interval)
+, m_max_pending_keys(max_pending_keys)
+, m_pending_keys(0)
+, m_flush_requested(false)
+, m_stopping(false)
+, m_increments(0)
+, m_flushed_commands(0)
+, m_failed_commands(std::make_shared<std::atomic<std::uint64_t>>(0)) {
+  if (!m_connection) {
+    throw redis_error("cpp_redis::counter_aggregator requires a client");
+  }
+
+  if (!nb_shards) {
+    nb_shards = std::thread::hardware_concurrency();
+  }
+
+  for (std::size_t i = 0; i < (nb_shards ? nb_shards : 1); ++i) {
+    m_shards.push_back(std::unique_ptr<shard>(new shard));
+  }
+
+  m_timer = std::unique_ptr<timer_executor>(new timer_executor);
+  schedule_periodic_flush(m_timer.get());
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::counter_aggregator created");
+}
+
+counter_aggregator::~counter_aggregator(void) {
+  //! stop the flushes of the timer (waits for a flush in progress) before the last one
+  m_stopping = true;
+  m_timer    = nullptr;
+
+  try {
+    sync_flush();
+  }
+  catch (const redis_error&) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::counter_aggregator could not flush its pending increments on destruction");
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::counter_aggregator destroyed");
+}
+
+void
+counter_aggregator::incr(const std::string& key) {
+  incrby(key, 1);
+}
+
+void
+counter_aggregator::incrby(const std::string& key, std::int64_t increment) {
+  shard& shard = get_shard();
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto result = shard.counters.emplace(key, 0);
+    result.first->second += increment;
+
+    if (result.second) {
+      ++m_pending_keys;
+    }
+  }
+
+  ++m_increments;
+
+  if (m_pending_keys >= m_max_pending_keys) {
+    request_flush();
+  }
+}
+
+void
+counter_aggregator::hincrby(const std::string& key, const std::string& field, std::int64_t increment) {
+  shard& shard = get_shard();
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto result = shard.hash_counters[key].emplace(field, 0);
+    result.first->second += increment;
+
+    if (result.second) {
+      ++m_pending_keys;
+    }
+  }
+
+  ++m_increments;
+
+  if (m_pending_keys >= m_max_pending_keys) {
+    request_flush();
+  }
+}
+
+void
+counter_aggregator::flush(void) {
+  if (!send_pending()) {
+    return;
+  }
+
+  //! a failed commit flushes the callbacks with an error reply, counted as failures
+  try {
+    m_connection->commit();
+  }
+  catch (const redis_error&) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::counter_aggregator could not send its increments");
+  }
+}
+
+void
+counter_aggregator::sync_flush(void) {
+  send_pending();
+  m_connection->sync_commit();
+}
+
+counter_aggregator::aggregator_stats
+counter_aggregator::get_stats(void) const {
+  return {m_increments, m_flushed_commands, *m_failed_commands, m_pending_keys};
+}
+
+counter_aggregator::shard&
+counter_aggregator::get_shard(void) {
+  return *m_shards[std::hash<std::thread::id>()(std::this_thread::get_id()) % m_shards.size()];
+}
+
+void
+counter_aggregator::request_flush(void) {
+  if (m_flush_requested.exchange(true)) {
+    return;
+  }
+
+  m_timer->execute([this]() {
+    m_flush_requested = false;
+    flush();
+  });
+}
+
+void
+counter_aggregator::schedule_periodic_flush(timer_executor* timer) {
+  //! the timer is given explicitly: m_timer is reset while the last flush may still run
+  timer->execute_after(m_flush_interval, [this, timer]() {
+    if (m_stopping) {
+      return;
+    }
+
+    flush();
+    schedule_periodic_flush(timer);
+  });
+}
+
+std::size_t
+counter_aggregator::send_pending(void) {
+  std::unordered_map<std::string, std::int64_t> counters;
+  std::unordered_map<std::string, std::unordered_map<std::string, std::int64_t>> hash_counters;
+
+  //! merge the shards, so that a counter incremented from several threads is sent once
+  for (const auto& shard : m_shards) {
+    std::unordered_map<std::string, std::int64_t> shard_counters;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::int64_t>> shard_hash_counters;
+
+    {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard_counters.swap(shard->counters);
+      shard_hash_counters.swap(shard->hash_counters);
+    }
+
+    for (const auto& counter : shard_counters) {
+      counters[counter.first] += counter.second;
+    }
+
+    for (const auto& hash : shard_hash_counters) {
+      auto& fields = hash_counters[hash.first];
+
+      for (const auto& field : hash.second) {
+        fields[field.first] += field.second;
+      }
+
+      m_pending_keys -= hash.second.size();
+    }
+
+    m_pending_keys -= shard_counters.size();
+  }
+
+  std::shared_ptr<std::atomic<std::uint64_t>> failed_commands = m_failed_commands;
+  auto callback = [failed_commands](reply& reply) {
+    if (reply.is_error()) {
+      ++*failed_commands;
+    }
+  };
+
+  std::size_t nb_commands = 0;
+
+  for (const auto& counter : counters) {
+    if (counter.second) {
+      m_connection->send({"INCRBY", counter.first, std::to_string(counter.second)}, callback);
+      ++nb_commands;
+    }
+  }
+
+  for (const auto& hash : hash_counters) {
+    for (const auto& field : hash.second) {
+      if (field.second) {
+        m_connection->send({"HINCRBY", hash.first, field.first, std::to_string(field.second)}, callback);
+        ++nb_commands;
+      }
+    }
+  }
+
+  m_flushed_commands += nb_commands;
+
+  return nb_commands;
+}
+
+} // namespace cpp_redis
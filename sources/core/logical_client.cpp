@@ -0,0 +1,156 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/logical_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+namespace cpp_redis {
+
+logical_client::logical_client(const std::shared_ptr<client>& connection)
+: m_connection(connection)
+, m_state(std::make_shared<state>()) {
+  if (!m_connection) {
+    throw redis_error("cpp_redis::logical_client needs a client");
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::logical_client created");
+}
+
+logical_client::~logical_client(void) {
+  //! commands of a disconnected client are flushed with an error reply: this never waits forever
+  std::unique_lock<std::mutex> lock(m_state->mutex);
+  m_state->condvar.wait(lock, [=] { return m_state->pending == 0; });
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::logical_client destroyed");
+}
+
+void
+logical_client::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+
+  if (!executor || dynamic_cast<inline_executor*>(executor.get())) {
+    m_state->executor = nullptr;
+  }
+  else {
+    m_state->executor = std::make_shared<serial_executor>(executor);
+  }
+}
+
+const std::shared_ptr<client>&
+logical_client::get_connection(void) const {
+  return m_connection;
+}
+
+bool
+logical_client::is_connected(void) const {
+  return m_connection->is_connected();
+}
+
+std::size_t
+logical_client::get_pending_commands_count(void) {
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+  return m_state->pending;
+}
+
+logical_client&
+logical_client::send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  if (is_connection_state_command(redis_cmd)) {
+    throw redis_error("cpp_redis::logical_client can not send " + redis_cmd[0] + " over a shared connection");
+  }
+
+  std::shared_ptr<serial_executor> executor;
+
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    ++m_state->pending;
+    executor = m_state->executor;
+  }
+
+  //! the callback keeps the state alive, not the handle
+  std::shared_ptr<state> handle_state = m_state;
+
+  if (!executor) {
+    m_connection->send(redis_cmd, [handle_state, callback](reply& reply) {
+      //! a throwing callback must not leave the command pending: sync_commit() and the dtor would wait forever
+      if (callback) {
+        run_task([&] { callback(reply); });
+      }
+
+      command_done(handle_state);
+    });
+
+    return *this;
+  }
+
+  m_connection->send(redis_cmd, [handle_state, executor, callback](reply& reply) {
+    executor->execute([handle_state, callback, reply]() mutable {
+      if (callback) {
+        run_task([&] { callback(reply); });
+      }
+
+      command_done(handle_state);
+    });
+  });
+
+  return *this;
+}
+
+std::future<reply>
+logical_client::send(const std::vector<std::string>& redis_cmd) {
+  auto prms = std::make_shared<std::promise<reply>>();
+
+  send(redis_cmd, [prms](reply& reply) {
+    prms->set_value(reply);
+  });
+
+  return prms->get_future();
+}
+
+logical_client&
+logical_client::commit(void) {
+  m_connection->commit();
+
+  return *this;
+}
+
+logical_client&
+logical_client::sync_commit(void) {
+  commit();
+
+  std::unique_lock<std::mutex> lock(m_state->mutex);
+  __CPP_REDIS_LOG(debug, "cpp_redis::logical_client waiting for callbacks to complete");
+  m_state->condvar.wait(lock, [=] { return m_state->pending == 0; });
+  __CPP_REDIS_LOG(debug, "cpp_redis::logical_client finished waiting for callback completion");
+
+  return *this;
+}
+
+void
+logical_client::command_done(const std::shared_ptr<state>& state) {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  --state->pending;
+  state->condvar.notify_all();
+}
+
+} // namespace cpp_redis
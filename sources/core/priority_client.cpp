@@ -0,0 +1,217 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/priority_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+namespace cpp_redis {
+
+//!
+//! number of priority classes
+//!
+static const std::size_t nb_lanes = 3;
+
+#ifndef __CPP_REDIS_USE_CUSTOM_TCP_CLIENT
+priority_client::priority_client(void)
+: m_connection_options(nb_lanes)
+, m_uncommitted(nb_lanes, false) {
+  for (std::size_t i = 0; i < nb_lanes; ++i) {
+    m_clients.push_back(std::unique_ptr<client>(new client));
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::priority_client created");
+}
+#endif /* __CPP_REDIS_USE_CUSTOM_TCP_CLIENT */
+
+priority_client::priority_client(const std::function<std::shared_ptr<network::tcp_client_iface>(void)>& tcp_client_factory)
+: m_connection_options(nb_lanes)
+, m_uncommitted(nb_lanes, false) {
+  for (std::size_t i = 0; i < nb_lanes; ++i) {
+    m_clients.push_back(std::unique_ptr<client>(new client(tcp_client_factory())));
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::priority_client created");
+}
+
+std::size_t
+priority_client::lane_index(priority lane) {
+  switch (lane) {
+  case priority::interactive: return 0;
+  case priority::normal: return 1;
+  case priority::bulk: return 2;
+  default: return 1;
+  }
+}
+
+void
+priority_client::set_connection_options(priority lane, const network::connection_options& options) {
+  m_connection_options[lane_index(lane)] = std::unique_ptr<network::connection_options>(new network::connection_options(options));
+}
+
+void
+priority_client::connect(
+  const std::string& host, std::size_t port,
+  const client::connect_callback_t& connect_callback,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::priority_client attempts to connect");
+
+  for (std::size_t i = 0; i < nb_lanes; ++i) {
+    const network::connection_options& lane_options = m_connection_options[i] ? *m_connection_options[i] : options;
+    m_clients[i]->connect(host, port, connect_callback, timeout_msecs, max_reconnects, reconnect_interval_msecs, lane_options);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::priority_client connected");
+}
+
+bool
+priority_client::is_connected(void) const {
+  for (const auto& client : m_clients) {
+    if (!client->is_connected()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+priority_client::disconnect(bool wait_for_removal) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::priority_client attempts to disconnect");
+
+  for (const auto& client : m_clients) {
+    client->disconnect(wait_for_removal);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::priority_client disconnected");
+}
+
+void
+priority_client::cancel_reconnect(void) {
+  for (const auto& client : m_clients) {
+    client->cancel_reconnect();
+  }
+}
+
+void
+priority_client::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  for (const auto& client : m_clients) {
+    client->set_executor(executor);
+  }
+}
+
+client&
+priority_client::use_lane(priority lane) {
+  std::size_t index = lane_index(lane);
+
+  std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+  m_uncommitted[index] = true;
+
+  return *m_clients[index];
+}
+
+client&
+priority_client::get_client(priority lane) {
+  return use_lane(lane);
+}
+
+priority_client&
+priority_client::send(const std::vector<std::string>& redis_cmd, const client::reply_callback_t& callback, priority lane) {
+  use_lane(lane).send(redis_cmd, callback);
+
+  return *this;
+}
+
+std::future<reply>
+priority_client::send(const std::vector<std::string>& redis_cmd, priority lane) {
+  return use_lane(lane).send(redis_cmd);
+}
+
+priority_client&
+priority_client::commit(void) {
+  std::vector<bool> uncommitted(nb_lanes, false);
+
+  {
+    std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+    std::swap(uncommitted, m_uncommitted);
+  }
+
+  //! lanes are ordered by priority: interactive commands hit the network first
+  //! a lane failing to commit must not prevent the others from sending their commands
+  bool failed = false;
+  std::string error;
+
+  for (std::size_t i = 0; i < nb_lanes; ++i) {
+    if (!uncommitted[i]) {
+      continue;
+    }
+
+    try {
+      m_clients[i]->commit();
+    }
+    catch (const redis_error& e) {
+      if (!failed) {
+        failed = true;
+        error  = e.what();
+      }
+    }
+  }
+
+  if (failed) {
+    __CPP_REDIS_LOG(error, "cpp_redis::priority_client could not send pipelined commands");
+    throw redis_error(error);
+  }
+
+  return *this;
+}
+
+priority_client&
+priority_client::sync_commit(void) {
+  commit();
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::priority_client waiting for callbacks to complete");
+  for (const auto& client : m_clients) {
+    client->sync_commit();
+  }
+  __CPP_REDIS_LOG(debug, "cpp_redis::priority_client finished waiting for callback completion");
+
+  return *this;
+}
+
+priority_client&
+priority_client::sync_commit(priority lane) {
+  std::size_t index = lane_index(lane);
+
+  {
+    std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+    m_uncommitted[index] = false;
+  }
+
+  m_clients[index]->sync_commit();
+
+  return *this;
+}
+
+} // namespace cpp_redis
@@ -44,6 +44,11 @@ sentinel::~sentinel(void) {
   m_sentinels.clear();
   if (m_client.is_connected())
     m_client.disconnect(true);
+
+  //! wait for the callbacks still queued on the executor
+  std::unique_lock<std::mutex> lock_callback(m_callbacks_mutex);
+  m_sync_condvar.wait(lock_callback, [=] { return m_callbacks_running == 0; });
+
   __CPP_REDIS_LOG(debug, "cpp_redis::sentinel destroyed");
 }
 
@@ -108,6 +113,84 @@ sentinel::get_master_addr_by_name(const std::string& name, std::string& host, st
   return port != 0;
 }
 
+bool
+sentinel::get_replicas_addr_by_name(const std::string& name, std::vector<std::pair<std::string, std::size_t>>& replicas, bool autoconnect) {
+  replicas.clear();
+
+  if (autoconnect && m_sentinels.size() == 0) {
+    throw redis_error("No sentinels available. Call add_sentinel() before get_replicas_addr_by_name()");
+  }
+
+  if (!autoconnect && !is_connected()) {
+    throw redis_error("No sentinel connected. Call connect() first or enable autoconnect.");
+  }
+
+  if (autoconnect) {
+    try {
+      connect_sentinel(nullptr);
+    }
+    catch (const redis_error&) {
+    }
+
+    if (!is_connected()) {
+      return false;
+    }
+  }
+
+  bool answered = false;
+
+  //! each replica is described by a flat list of field / value pairs
+  slaves(name, [&](cpp_redis::reply& reply) {
+    if (!reply.is_array()) {
+      return;
+    }
+
+    answered = true;
+
+    for (const auto& replica : reply.as_array()) {
+      if (!replica.is_array()) {
+        continue;
+      }
+
+      std::string host;
+      std::size_t port = 0;
+      std::string flags;
+      const auto& fields = replica.as_array();
+
+      for (std::size_t i = 0; i + 1 < fields.size(); i += 2) {
+        if (!fields[i].is_string() || !fields[i + 1].is_string()) {
+          continue;
+        }
+
+        const std::string& field = fields[i].as_string();
+
+        if (field == "ip") {
+          host = fields[i + 1].as_string();
+        }
+        else if (field == "port") {
+          port = std::stoi(fields[i + 1].as_string(), nullptr, 10);
+        }
+        else if (field == "flags") {
+          flags = fields[i + 1].as_string();
+        }
+      }
+
+      if (host.empty() || !port || flags.find("down") != std::string::npos || flags.find("disconnected") != std::string::npos) {
+        continue;
+      }
+
+      replicas.push_back({host, port});
+    }
+  });
+  sync_commit();
+
+  if (autoconnect) {
+    disconnect(true);
+  }
+
+  return answered;
+}
+
 void
 sentinel::connect_sentinel(const sentinel_disconnect_handler_t& sentinel_disconnect_handler) {
   if (m_sentinels.size() == 0) {
@@ -180,16 +263,23 @@ sentinel::connection_receive_handler(network::redis_connection&, reply& reply) {
     }
   }
 
-  if (callback) {
-    __CPP_REDIS_LOG(debug, "cpp_redis::sentinel executes reply callback");
-    callback(reply);
-  }
+  auto run_callback = [this, callback](cpp_redis::reply& reply) {
+    if (callback) {
+      __CPP_REDIS_LOG(debug, "cpp_redis::sentinel executes reply callback");
+      run_task([&] { callback(reply); });
+    }
 
-  {
     std::lock_guard<std::mutex> lock(m_callbacks_mutex);
     m_callbacks_running -= 1;
     m_sync_condvar.notify_all();
+  };
+
+  if (!m_callbacks_executor) {
+    run_callback(reply);
+    return;
   }
+
+  m_callbacks_executor->execute([run_callback, reply]() mutable { run_callback(reply); });
 }
 
 void
@@ -229,6 +319,16 @@ sentinel::is_connected(void) {
   return m_client.is_connected();
 }
 
+void
+sentinel::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  if (!executor || dynamic_cast<inline_executor*>(executor.get())) {
+    m_callbacks_executor = nullptr;
+  }
+  else {
+    m_callbacks_executor = std::make_shared<serial_executor>(executor);
+  }
+}
+
 const std::vector<sentinel::sentinel_def>&
 sentinel::get_sentinels(void) const {
   return m_sentinels;
@@ -0,0 +1,340 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/sharded_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+#include <map>
+
+namespace cpp_redis {
+
+sharded_client::sharded_client(std::size_t nb_virtual_nodes)
+: m_state(std::make_shared<ring_state>(ring_state{hash_ring(nb_virtual_nodes), {}}))
+, m_pending(0) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::sharded_client created");
+}
+
+sharded_client::~sharded_client(void) {
+  //! disconnecting flushes the callbacks of the commands still in flight
+  disconnect(true);
+
+  std::unique_lock<std::mutex> lock(m_pending_mutex);
+  m_pending_condvar.wait(lock, [=] { return m_pending == 0; });
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::sharded_client destroyed");
+}
+
+void
+sharded_client::add_node(
+  const std::string& host,
+  std::size_t port,
+  std::size_t weight,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  std::string addr = host + ":" + std::to_string(port);
+
+  std::lock_guard<std::mutex> lock(m_update_mutex);
+  std::shared_ptr<const ring_state> state = std::atomic_load(&m_state);
+
+  for (const auto& node : state->ring.get_nodes()) {
+    if (node == addr) {
+      return;
+    }
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::sharded_client connects to node " + addr);
+
+  auto new_client = std::make_shared<client>();
+  new_client->set_executor(m_executor);
+  new_client->connect(host, port, nullptr, timeout_msecs, max_reconnects, reconnect_interval_msecs, options);
+
+  auto new_state = std::make_shared<ring_state>(*state);
+  new_state->ring.add_node(addr, weight);
+  new_state->clients.push_back(new_client);
+
+  std::atomic_store(&m_state, std::shared_ptr<const ring_state>(new_state));
+}
+
+void
+sharded_client::remove_node(const std::string& host, std::size_t port) {
+  std::string addr = host + ":" + std::to_string(port);
+  std::shared_ptr<client> removed;
+
+  {
+    std::lock_guard<std::mutex> lock(m_update_mutex);
+    std::shared_ptr<const ring_state> state = std::atomic_load(&m_state);
+    const std::vector<std::string>& nodes   = state->ring.get_nodes();
+
+    auto new_state = std::make_shared<ring_state>(ring_state{state->ring, {}});
+    new_state->ring.remove_node(addr);
+
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      if (nodes[i] == addr) {
+        removed = state->clients[i];
+      }
+      else {
+        new_state->clients.push_back(state->clients[i]);
+      }
+    }
+
+    if (!removed) {
+      return;
+    }
+
+    std::atomic_store(&m_state, std::shared_ptr<const ring_state>(new_state));
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::sharded_client removes node " + addr);
+
+  {
+    std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+    m_uncommitted_nodes.erase(removed);
+  }
+
+  //! let the commands already routed to the node complete, a failure flushes their callbacks with an error reply
+  try {
+    removed->sync_commit();
+  }
+  catch (const redis_error&) {
+    __CPP_REDIS_LOG(error, "cpp_redis::sharded_client could not send pipelined commands to removed node " + addr);
+  }
+
+  removed->cancel_reconnect();
+  removed->disconnect(true);
+}
+
+std::vector<std::string>
+sharded_client::get_nodes(void) const {
+  return std::atomic_load(&m_state)->ring.get_nodes();
+}
+
+bool
+sharded_client::is_connected(void) const {
+  std::shared_ptr<const ring_state> state = std::atomic_load(&m_state);
+
+  if (state->clients.empty()) {
+    return false;
+  }
+
+  for (const auto& node : state->clients) {
+    if (!node->is_connected()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+sharded_client::disconnect(bool wait_for_removal) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::sharded_client attempts to disconnect");
+
+  std::shared_ptr<const ring_state> state = std::atomic_load(&m_state);
+
+  for (const auto& node : state->clients) {
+    node->cancel_reconnect();
+    node->disconnect(wait_for_removal);
+  }
+
+  __CPP_REDIS_LOG(info, "cpp_redis::sharded_client disconnected");
+}
+
+void
+sharded_client::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  std::lock_guard<std::mutex> lock(m_update_mutex);
+  m_executor = executor;
+
+  for (const auto& node : std::atomic_load(&m_state)->clients) {
+    node->set_executor(executor);
+  }
+}
+
+const std::shared_ptr<client>&
+sharded_client::get_node_client(const ring_state& state, const std::string& key) {
+  return state.clients[state.ring.get_node_index(key)];
+}
+
+std::string
+sharded_client::get_node_for_key(const std::string& key) const {
+  return std::atomic_load(&m_state)->ring.get_node(key);
+}
+
+client&
+sharded_client::get_client_for_key(const std::string& key) {
+  //! clients are kept alive by the states still referencing them: only removed nodes may be released
+  std::shared_ptr<client> node = get_node_client(*std::atomic_load(&m_state), key);
+
+  std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+  m_uncommitted_nodes.insert(node);
+
+  return *node;
+}
+
+client&
+sharded_client::get_client(const std::string& host, std::size_t port) {
+  std::string addr                        = host + ":" + std::to_string(port);
+  std::shared_ptr<const ring_state> state = std::atomic_load(&m_state);
+  const std::vector<std::string>& nodes   = state->ring.get_nodes();
+
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i] == addr) {
+      return *state->clients[i];
+    }
+  }
+
+  throw redis_error("cpp_redis::sharded_client unknown node " + addr);
+}
+
+sharded_client&
+sharded_client::send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  std::string key;
+
+  if (!get_command_key(redis_cmd, key)) {
+    throw redis_error("cpp_redis::sharded_client can not route a command without key");
+  }
+
+  //! a single snapshot of the ring is used for the whole command, even if a node is added concurrently
+  std::shared_ptr<const ring_state> state = std::atomic_load(&m_state);
+  const std::shared_ptr<client>& node     = get_node_client(*state, key);
+
+  {
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    ++m_pending;
+  }
+
+  if (!scatter_send(*state, redis_cmd, callback)) {
+    send_to_node(node, redis_cmd, callback);
+  }
+
+  return *this;
+}
+
+std::future<reply>
+sharded_client::send(const std::vector<std::string>& redis_cmd) {
+  auto prms = std::make_shared<std::promise<reply>>();
+
+  send(redis_cmd, [prms](reply& reply) {
+    prms->set_value(reply);
+  });
+
+  return prms->get_future();
+}
+
+void
+sharded_client::send_to_node(const std::shared_ptr<client>& node, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  node->send(redis_cmd, [this, callback](reply& reply) {
+    //! a throwing callback must not leave the command in flight: sync_commit() and the dtor would wait forever
+    if (callback) {
+      run_task([&] { callback(reply); });
+    }
+
+    command_done();
+  });
+
+  std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+  m_uncommitted_nodes.insert(node);
+}
+
+bool
+sharded_client::scatter_send(const ring_state& state, const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  auto parts = split_multi_key_command(redis_cmd, [&](const std::string& key) { return state.ring.get_node_index(key); });
+
+  if (parts.size() < 2) {
+    return false;
+  }
+
+  auto merger = std::make_shared<multi_key_reply_merger>(redis_cmd, parts.size(), callback);
+
+  //! the whole command is already counted as pending: count the additional parts
+  {
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    m_pending += parts.size() - 1;
+  }
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::sharded_client splits " + redis_cmd[0] + " over " + std::to_string(parts.size()) + " nodes");
+
+  for (const auto& node : parts) {
+    auto part = std::make_shared<multi_key_command_part>(node.second);
+
+    send_to_node(state.clients[node.first], part->command, [merger, part](reply& reply) { merger->add_reply(*part, reply); });
+  }
+
+  return true;
+}
+
+sharded_client&
+sharded_client::commit(void) {
+  std::set<std::shared_ptr<client>> uncommitted;
+
+  {
+    std::lock_guard<std::mutex> lock(m_uncommitted_mutex);
+    std::swap(uncommitted, m_uncommitted_nodes);
+  }
+
+  //! a node failing to commit must not prevent the others from sending their commands
+  bool failed = false;
+  std::string error;
+
+  for (const auto& node : uncommitted) {
+    try {
+      node->commit();
+    }
+    catch (const redis_error& e) {
+      if (!failed) {
+        failed = true;
+        error  = e.what();
+      }
+    }
+  }
+
+  if (failed) {
+    __CPP_REDIS_LOG(error, "cpp_redis::sharded_client could not send pipelined commands");
+    throw redis_error(error);
+  }
+
+  return *this;
+}
+
+sharded_client&
+sharded_client::sync_commit(void) {
+  commit();
+
+  std::unique_lock<std::mutex> lock(m_pending_mutex);
+  __CPP_REDIS_LOG(debug, "cpp_redis::sharded_client waiting for callbacks to complete");
+  m_pending_condvar.wait(lock, [=] { return m_pending == 0; });
+  __CPP_REDIS_LOG(debug, "cpp_redis::sharded_client finished waiting for callback completion");
+
+  return *this;
+}
+
+void
+sharded_client::command_done(void) {
+  std::lock_guard<std::mutex> lock(m_pending_mutex);
+  --m_pending;
+  m_pending_condvar.notify_all();
+}
+
+} // namespace cpp_redis
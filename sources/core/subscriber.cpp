@@ -62,6 +62,11 @@ subscriber::~subscriber(void) {
     m_client.disconnect(true);
   }
 
+  //! wait for the callbacks still queued on the executor
+  if (m_callbacks_executor) {
+    m_callbacks_executor->wait();
+  }
+
   __CPP_REDIS_LOG(debug, "cpp_redis::subscriber destroyed");
 }
 
@@ -72,13 +77,14 @@ subscriber::connect(
   const connect_callback_t& connect_callback,
   std::uint32_t timeout_msecs,
   std::int32_t max_reconnects,
-  std::uint32_t reconnect_interval_msecs) {
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
   //! Save for auto reconnects
   m_master_name = name;
 
   //! We rely on the sentinel to tell us which redis server is currently the master.
   if (m_sentinel.get_master_addr_by_name(name, m_redis_server, m_redis_port, true)) {
-    connect(m_redis_server, m_redis_port, connect_callback, timeout_msecs, max_reconnects, reconnect_interval_msecs);
+    connect(m_redis_server, m_redis_port, connect_callback, timeout_msecs, max_reconnects, reconnect_interval_msecs, options);
   }
   else {
     throw redis_error("cpp_redis::subscriber::connect() could not find master for name " + name);
@@ -92,7 +98,8 @@ subscriber::connect(
   const connect_callback_t& connect_callback,
   std::uint32_t timeout_msecs,
   std::int32_t max_reconnects,
-  std::uint32_t reconnect_interval_msecs) {
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
   __CPP_REDIS_LOG(debug, "cpp_redis::subscriber attempts to connect");
 
   //! Save for auto reconnects
@@ -101,6 +108,7 @@ subscriber::connect(
   m_connect_callback         = connect_callback;
   m_max_reconnects           = max_reconnects;
   m_reconnect_interval_msecs = reconnect_interval_msecs;
+  m_connection_options       = options;
 
   //! notify start
   if (m_connect_callback) {
@@ -109,7 +117,7 @@ subscriber::connect(
 
   auto disconnection_handler = std::bind(&subscriber::connection_disconnection_handler, this, std::placeholders::_1);
   auto receive_handler       = std::bind(&subscriber::connection_receive_handler, this, std::placeholders::_1, std::placeholders::_2);
-  m_client.connect(host, port, disconnection_handler, receive_handler, timeout_msecs);
+  m_client.connect(host, port, disconnection_handler, receive_handler, timeout_msecs, options);
 
   //! notify end
   if (m_connect_callback) {
@@ -144,6 +152,16 @@ subscriber::cancel_reconnect(void) {
   m_cancel = true;
 }
 
+void
+subscriber::set_executor(const std::shared_ptr<executor_iface>& executor) {
+  if (!executor || dynamic_cast<inline_executor*>(executor.get())) {
+    m_callbacks_executor = nullptr;
+  }
+  else {
+    m_callbacks_executor = std::make_shared<serial_executor>(executor);
+  }
+}
+
 subscriber&
 subscriber::auth(const std::string& password, const reply_callback_t& reply_callback) {
   __CPP_REDIS_LOG(debug, "cpp_redis::subscriber attempts to authenticate");
@@ -158,6 +176,19 @@ subscriber::auth(const std::string& password, const reply_callback_t& reply_call
   return *this;
 }
 
+subscriber&
+subscriber::client_id(const client_id_callback_t& callback) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::subscriber requests its connection id");
+
+  m_client_id_callback = callback;
+
+  m_client.send({"CLIENT", "ID"});
+
+  __CPP_REDIS_LOG(info, "cpp_redis::subscriber CLIENT ID command sent");
+
+  return *this;
+}
+
 void
 subscriber::disconnect(bool wait_for_removal) {
   __CPP_REDIS_LOG(debug, "cpp_redis::subscriber attempts to disconnect");
@@ -188,7 +219,7 @@ subscriber::subscribe(const std::string& channel, const subscribe_callback_t& ca
 
 void
 subscriber::unprotected_subscribe(const std::string& channel, const subscribe_callback_t& callback, const acknowledgement_callback_t& acknowledgement_callback) {
-  m_subscribed_channels[channel] = {callback, acknowledgement_callback};
+  m_subscribed_channels[channel] = {callback, acknowledgement_callback, nullptr};
   m_client.send({"SUBSCRIBE", channel});
 }
 
@@ -205,10 +236,42 @@ subscriber::psubscribe(const std::string& pattern, const subscribe_callback_t& c
 
 void
 subscriber::unprotected_psubscribe(const std::string& pattern, const subscribe_callback_t& callback, const acknowledgement_callback_t& acknowledgement_callback) {
-  m_psubscribed_channels[pattern] = {callback, acknowledgement_callback};
+  m_psubscribed_channels[pattern] = {callback, acknowledgement_callback, nullptr};
   m_client.send({"PSUBSCRIBE", pattern});
 }
 
+subscriber&
+subscriber::subscribe_invalidations(const invalidation_callback_t& callback, const acknowledgement_callback_t& acknowledgement_callback) {
+  std::lock_guard<std::mutex> lock(m_subscribed_channels_mutex);
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::subscriber attempts to subscribe to invalidations");
+  unprotected_subscribe("__redis__:invalidate", nullptr, acknowledgement_callback);
+  m_subscribed_channels["__redis__:invalidate"].invalidation_callback = callback;
+  __CPP_REDIS_LOG(info, "cpp_redis::subscriber subscribed to invalidations");
+
+  return *this;
+}
+
+subscriber&
+subscriber::subscribe_key_events(const std::shared_ptr<key_filter>& filter, int db, const acknowledgement_callback_t& acknowledgement_callback) {
+  if (!filter) {
+    throw redis_error("cpp_redis::subscriber::subscribe_key_events() requires a filter");
+  }
+
+  auto callback = [filter](const std::string& channel, const std::string& key) {
+    std::string event = channel.substr(channel.find("__:") + 3);
+
+    //! events of keys that no longer exist would only fill the filter
+    if (event == "del" || event == "unlink" || event == "expired" || event == "evicted" || event == "rename_from") {
+      return;
+    }
+
+    filter->add(key);
+  };
+
+  return psubscribe("__keyevent@" + std::to_string(db) + "__:*", callback, acknowledgement_callback);
+}
+
 subscriber&
 subscriber::unsubscribe(const std::string& channel) {
   std::lock_guard<std::mutex> lock(m_subscribed_channels_mutex);
@@ -304,8 +367,7 @@ subscriber::handle_subscribe_reply(const std::vector<reply>& reply) {
   const auto& message = reply[2];
 
   if (!title.is_string()
-      || !channel.is_string()
-      || !message.is_string())
+      || !channel.is_string())
     return;
 
   if (title.as_string() != "message")
@@ -317,6 +379,28 @@ subscriber::handle_subscribe_reply(const std::vector<reply>& reply) {
   if (it == m_subscribed_channels.end())
     return;
 
+  //! invalidation messages carry an array of keys, or a null array when the whole keyspace is flushed
+  if (it->second.invalidation_callback) {
+    std::vector<std::string> keys;
+
+    if (message.is_array()) {
+      for (const auto& key : message.as_array()) {
+        if (key.is_string())
+          keys.push_back(key.as_string());
+      }
+    }
+    else if (message.is_string()) {
+      keys.push_back(message.as_string());
+    }
+
+    __CPP_REDIS_LOG(debug, "cpp_redis::subscriber executes invalidation callback");
+    it->second.invalidation_callback(keys);
+    return;
+  }
+
+  if (!message.is_string() || !it->second.subscribe_callback)
+    return;
+
   __CPP_REDIS_LOG(debug, "cpp_redis::subscriber executes subscribe callback for channel " + channel.as_string());
   it->second.subscribe_callback(channel.as_string(), message.as_string());
 }
@@ -354,11 +438,26 @@ void
 subscriber::connection_receive_handler(network::redis_connection&, reply& reply) {
   __CPP_REDIS_LOG(info, "cpp_redis::subscriber received reply");
 
+  if (!m_callbacks_executor) {
+    handle_reply(reply);
+    return;
+  }
+
+  m_callbacks_executor->execute([this, reply]() mutable { handle_reply(reply); });
+}
+
+void
+subscriber::handle_reply(reply& reply) {
   //! always return an array
-  //! otherwise, if auth was defined, this should be the AUTH reply
+  //! otherwise, this should be the CLIENT ID reply (integer) or, if auth was defined, the AUTH reply
   //! any other replies from the server are considered as unexpected
   if (!reply.is_array()) {
-    if (m_auth_reply_callback) {
+    if (reply.is_integer() && m_client_id_callback) {
+      __CPP_REDIS_LOG(debug, "cpp_redis::subscriber executes client id callback");
+
+      m_client_id_callback(reply.as_integer());
+    }
+    else if (m_auth_reply_callback) {
       __CPP_REDIS_LOG(debug, "cpp_redis::subscriber executes auth callback");
 
       m_auth_reply_callback(reply);
@@ -370,13 +469,13 @@ subscriber::connection_receive_handler(network::redis_connection&, reply& reply)
 
   auto& array = reply.as_array();
 
-  //! Array size of 3 -> SUBSCRIBE if array[2] is a string
+  //! Array size of 3 -> SUBSCRIBE if array[2] is a string (or an array / null for invalidations)
   //! Array size of 3 -> AKNOWLEDGEMENT if array[2] is an integer
   //! Array size of 4 -> PSUBSCRIBE
   //! Otherwise -> unexpected reply
   if (array.size() == 3 && array[2].is_integer())
     handle_acknowledgement_reply(array);
-  else if (array.size() == 3 && array[2].is_string())
+  else if (array.size() == 3)
     handle_subscribe_reply(array);
   else if (array.size() == 4)
     handle_psubscribe_reply(array);
@@ -460,7 +559,7 @@ subscriber::reconnect(void) {
 
   //! Try catch block because the redis subscriber throws an error if connection cannot be made.
   try {
-    connect(m_redis_server, m_redis_port, m_connect_callback, m_connect_timeout_msecs, m_max_reconnects, m_reconnect_interval_msecs);
+    connect(m_redis_server, m_redis_port, m_connect_callback, m_connect_timeout_msecs, m_max_reconnects, m_reconnect_interval_msecs, m_connection_options);
   }
   catch (...) {
   }
@@ -480,6 +579,7 @@ subscriber::reconnect(void) {
   __CPP_REDIS_LOG(info, "client reconnected ok");
 
   re_auth();
+  re_client_id();
   re_subscribe();
   commit();
 }
@@ -489,6 +589,7 @@ subscriber::re_subscribe(void) {
   std::map<std::string, callback_holder> sub_chans = std::move(m_subscribed_channels);
   for (const auto& chan : sub_chans) {
     unprotected_subscribe(chan.first, chan.second.subscribe_callback, chan.second.acknowledgement_callback);
+    m_subscribed_channels[chan.first].invalidation_callback = chan.second.invalidation_callback;
   }
 
   std::map<std::string, callback_holder> psub_chans = std::move(m_psubscribed_channels);
@@ -514,4 +615,13 @@ subscriber::re_auth(void) {
   });
 }
 
+void
+subscriber::re_client_id(void) {
+  if (!m_client_id_callback) {
+    return;
+  }
+
+  m_client.send({"CLIENT", "ID"});
+}
+
 } // namespace cpp_redis
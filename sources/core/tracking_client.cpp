@@ -0,0 +1,485 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/core/tracking_client.hpp>
+#include <cpp_redis/misc/command_traits.hpp>
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/logger.hpp>
+#include <cpp_redis/misc/near_cache.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+namespace cpp_redis {
+
+tracking_client::tracking_client(std::size_t max_bytes)
+: m_max_bytes(max_bytes)
+, m_epoch(0)
+, m_redirect_id(-1)
+, m_pending_redirect_id(-1)
+, m_tracking_enabled(false)
+, m_tracking_rejected(false)
+, m_in_transaction(false)
+, m_hits(0)
+, m_misses(0)
+, m_invalidations(0)
+, m_evictions(0) {
+  __CPP_REDIS_LOG(debug, "cpp_redis::tracking_client created");
+}
+
+tracking_client::~tracking_client(void) {
+  //! stop the invalidations first: the client may still complete reads, filling the cache
+  m_subscriber.disconnect(true);
+  m_client.disconnect(true);
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::tracking_client destroyed");
+}
+
+void
+tracking_client::set_bcast_prefixes(const std::vector<std::string>& prefixes) {
+  m_bcast_prefixes = prefixes;
+}
+
+void
+tracking_client::set_password(const std::string& password) {
+  m_password = password;
+}
+
+void
+tracking_client::connect(
+  const std::string& host, std::size_t port,
+  const client::connect_callback_t& connect_callback,
+  std::uint32_t timeout_msecs,
+  std::int32_t max_reconnects,
+  std::uint32_t reconnect_interval_msecs,
+  const network::connection_options& options) {
+  m_redirect_id       = -1;
+  m_tracking_rejected = false;
+  m_in_transaction    = false;
+  reset_tracking();
+
+  //! invalidations are lost while the connection is down: stop caching until it is subscribed again
+  m_subscriber.connect(host, port, [this](const std::string&, std::size_t, subscriber::connect_state status) {
+    if (status == subscriber::connect_state::dropped) {
+      m_redirect_id = -1;
+      reset_tracking();
+    }
+  },
+    timeout_msecs, max_reconnects, reconnect_interval_msecs, options);
+
+  if (!m_password.empty()) {
+    m_subscriber.auth(m_password);
+  }
+
+  //! the id changes on each reconnection of the subscriber, and is only published once the invalidations are subscribed
+  m_subscriber.client_id([this](int64_t id) { m_pending_redirect_id = id; });
+  m_subscriber.subscribe_invalidations(std::bind(&tracking_client::on_invalidation, this, std::placeholders::_1), [this](int64_t) {
+    m_redirect_id = m_pending_redirect_id.load();
+    reset_tracking();
+  });
+  m_subscriber.commit();
+
+  //! tracking is bound to the client connection: a new connection is not tracked anymore
+  try {
+    m_client.connect(host, port, [this, connect_callback](const std::string& host, std::size_t port, client::connect_state status) {
+      if (status == client::connect_state::dropped || status == client::connect_state::ok) {
+        m_in_transaction = false;
+        reset_tracking();
+      }
+
+      if (connect_callback) {
+        connect_callback(host, port, status);
+      }
+    },
+      timeout_msecs, max_reconnects, reconnect_interval_msecs, options);
+  }
+  catch (const redis_error&) {
+    m_subscriber.disconnect();
+    throw;
+  }
+
+  if (!m_password.empty()) {
+    m_client.auth(m_password);
+  }
+}
+
+bool
+tracking_client::is_connected(void) const {
+  return m_client.is_connected() && m_subscriber.is_connected();
+}
+
+void
+tracking_client::disconnect(bool wait_for_removal) {
+  m_subscriber.disconnect(wait_for_removal);
+  m_client.disconnect(wait_for_removal);
+
+  m_redirect_id = -1;
+  reset_tracking();
+}
+
+client&
+tracking_client::get_client(void) {
+  return m_client;
+}
+
+bool
+tracking_client::get_cacheable_read(const std::vector<std::string>& redis_cmd, std::string& key, std::string& signature) {
+  if (redis_cmd.size() < 2) {
+    return false;
+  }
+
+  std::string name = redis_cmd.front();
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  if ((name == "GET" || name == "HGETALL") && redis_cmd.size() == 2) {
+    signature = name;
+  }
+  else if (name == "HGET" && redis_cmd.size() == 3) {
+    signature = "HGET " + redis_cmd[2];
+  }
+  else {
+    return false;
+  }
+
+  key = redis_cmd[1];
+
+  return true;
+}
+
+bool
+tracking_client::is_cacheable_key(const std::string& key) const {
+  if (m_tracking_rejected || m_in_transaction || m_redirect_id < 0 || !m_client.is_connected()) {
+    return false;
+  }
+
+  if (m_bcast_prefixes.empty()) {
+    return true;
+  }
+
+  //! in broadcasting mode, keys out of the prefixes are never invalidated
+  for (const auto& prefix : m_bcast_prefixes) {
+    if (key.compare(0, prefix.size(), prefix) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+tracking_client&
+tracking_client::send(const std::vector<std::string>& redis_cmd, const reply_callback_t& callback) {
+  std::string key;
+  std::string signature;
+
+  if (!get_cacheable_read(redis_cmd, key, signature) || !is_cacheable_key(key)) {
+    std::string name = redis_cmd.empty() ? "" : redis_cmd.front();
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+    if (name == "MULTI") {
+      m_in_transaction = true;
+    }
+    else if (name == "EXEC" || name == "DISCARD") {
+      m_in_transaction = false;
+    }
+
+    //! keys are cached for the selected database only
+    if (name == "SELECT" || name == "SWAPDB" || name == "FLUSHDB" || name == "FLUSHALL") {
+      clear();
+    }
+    else if (!is_read_only_command(redis_cmd)) {
+      evict_command_keys(redis_cmd);
+    }
+
+    m_client.send(redis_cmd, callback);
+    return *this;
+  }
+
+  reply value;
+  std::uint64_t fill_id;
+
+  if (lookup(key, signature, value, fill_id)) {
+    ++m_hits;
+
+    if (callback) {
+      callback(value);
+    }
+
+    return *this;
+  }
+
+  ++m_misses;
+
+  //! CLIENT TRACKING must reach the connection before the read, and the epoch must be read before checking whether tracking is enabled
+  std::lock_guard<std::mutex> lock(m_tracking_mutex);
+  std::uint64_t epoch      = m_epoch;
+  std::int64_t redirect_id = m_redirect_id;
+  bool tracked             = redirect_id >= 0;
+
+  if (tracked) {
+    unprotected_enable_tracking(redirect_id);
+  }
+
+  m_client.send(redis_cmd, [=](reply& reply) {
+    fill(key, signature, fill_id, epoch, tracked, reply);
+
+    if (callback) {
+      callback(reply);
+    }
+  });
+
+  return *this;
+}
+
+std::future<reply>
+tracking_client::send(const std::vector<std::string>& redis_cmd) {
+  auto prms = std::make_shared<std::promise<reply>>();
+
+  send(redis_cmd, [prms](reply& reply) { prms->set_value(reply); });
+
+  return prms->get_future();
+}
+
+tracking_client&
+tracking_client::get(const std::string& key, const reply_callback_t& reply_callback) {
+  return send({"GET", key}, reply_callback);
+}
+
+std::future<reply>
+tracking_client::get(const std::string& key) {
+  return send({"GET", key});
+}
+
+tracking_client&
+tracking_client::hget(const std::string& key, const std::string& field, const reply_callback_t& reply_callback) {
+  return send({"HGET", key, field}, reply_callback);
+}
+
+std::future<reply>
+tracking_client::hget(const std::string& key, const std::string& field) {
+  return send({"HGET", key, field});
+}
+
+tracking_client&
+tracking_client::hgetall(const std::string& key, const reply_callback_t& reply_callback) {
+  return send({"HGETALL", key}, reply_callback);
+}
+
+std::future<reply>
+tracking_client::hgetall(const std::string& key) {
+  return send({"HGETALL", key});
+}
+
+tracking_client&
+tracking_client::commit(void) {
+  m_client.commit();
+
+  return *this;
+}
+
+tracking_client&
+tracking_client::sync_commit(void) {
+  m_client.sync_commit();
+
+  return *this;
+}
+
+tracking_client::cache_stats
+tracking_client::get_stats(void) {
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+  return {m_hits, m_misses, m_invalidations, m_evictions, m_entries.size(), m_bytes};
+}
+
+void
+tracking_client::clear(void) {
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+  m_entries.clear();
+  m_lru.clear();
+  m_bytes = 0;
+}
+
+bool
+tracking_client::lookup(const std::string& key, const std::string& signature, reply& value, std::uint64_t& fill_id) {
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+  auto it = m_entries.find(key);
+
+  if (it == m_entries.end()) {
+    m_lru.push_front(key);
+    it                      = m_entries.emplace(key, cache_entry()).first;
+    it->second.lru_position = m_lru.begin();
+  }
+  else {
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+  }
+
+  cached_reply& cached = it->second.replies[signature];
+
+  if (cached.filled) {
+    value = cached.value;
+    return true;
+  }
+
+  //! a read already in flight loses its placeholder: only the most recent read fills the entry
+  fill_id        = ++m_next_fill_id;
+  cached.fill_id = fill_id;
+  cached.filled  = false;
+  cached.bytes   = 0;
+
+  return false;
+}
+
+void
+tracking_client::fill(const std::string& key, const std::string& signature, std::uint64_t fill_id, std::uint64_t epoch, bool tracked, const reply& value) {
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+  //! the placeholder is gone if the key has been invalidated or evicted while the read was in flight
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) {
+    return;
+  }
+
+  auto reply_it = it->second.replies.find(signature);
+  if (reply_it == it->second.replies.end() || reply_it->second.filled || reply_it->second.fill_id != fill_id) {
+    return;
+  }
+
+  std::size_t bytes = sizeof(cached_reply) + key.size() + signature.size() + approximate_reply_size(value);
+
+  if (!tracked || value.is_error() || epoch != m_epoch || bytes > m_max_bytes) {
+    it->second.replies.erase(reply_it);
+
+    if (it->second.replies.empty()) {
+      m_lru.erase(it->second.lru_position);
+      m_entries.erase(it);
+    }
+
+    return;
+  }
+
+  reply_it->second.value  = value;
+  reply_it->second.filled = true;
+  reply_it->second.bytes  = bytes;
+  m_bytes += bytes;
+
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+
+  while (m_bytes > m_max_bytes && !m_lru.empty()) {
+    unprotected_evict(m_lru.back());
+    ++m_evictions;
+  }
+}
+
+bool
+tracking_client::unprotected_evict(const std::string& key) {
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) {
+    return false;
+  }
+
+  for (const auto& cached : it->second.replies) {
+    m_bytes -= cached.second.bytes;
+  }
+
+  m_lru.erase(it->second.lru_position);
+  m_entries.erase(it);
+
+  return true;
+}
+
+void
+tracking_client::evict_command_keys(const std::vector<std::string>& redis_cmd) {
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+  //! arguments are not all keys, but evicting a few more keys than needed is harmless
+  for (std::size_t i = 1; i < redis_cmd.size(); ++i) {
+    if (unprotected_evict(redis_cmd[i])) {
+      ++m_invalidations;
+    }
+  }
+}
+
+void
+tracking_client::on_invalidation(const std::vector<std::string>& keys) {
+  //! the whole keyspace has been flushed
+  if (keys.empty()) {
+    __CPP_REDIS_LOG(debug, "cpp_redis::tracking_client flushes its cache on server flush");
+    clear();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+
+  for (const auto& key : keys) {
+    if (unprotected_evict(key)) {
+      ++m_invalidations;
+    }
+  }
+}
+
+void
+tracking_client::reset_tracking(void) {
+  m_tracking_enabled = false;
+  ++m_epoch;
+  clear();
+}
+
+void
+tracking_client::unprotected_enable_tracking(std::int64_t redirect_id) {
+  if (m_tracking_enabled) {
+    return;
+  }
+
+  m_tracking_enabled = true;
+
+  std::vector<std::string> tracking_cmd = {"CLIENT", "TRACKING", "ON", "REDIRECT", std::to_string(redirect_id)};
+
+  if (!m_bcast_prefixes.empty()) {
+    tracking_cmd.push_back("BCAST");
+
+    for (const auto& prefix : m_bcast_prefixes) {
+      tracking_cmd.push_back("PREFIX");
+      tracking_cmd.push_back(prefix);
+    }
+  }
+
+  //! switch tracking off first: changing the options of an enabled tracking is not always allowed
+  m_client.send({"CLIENT", "TRACKING", "OFF"}, nullptr);
+  m_client.send(tracking_cmd, [this](reply& reply) {
+    if (!reply.is_error()) {
+      return;
+    }
+
+    //! server errors (redis < 6, invalid prefixes, ...) disable the cache, network failures only require tracking to be enabled again
+    if (reply.as_string().compare(0, 3, "ERR") == 0) {
+      __CPP_REDIS_LOG(warn, "cpp_redis::tracking_client disables its cache, CLIENT TRACKING rejected: " + reply.as_string());
+      m_tracking_rejected = true;
+    }
+
+    reset_tracking();
+  });
+
+  __CPP_REDIS_LOG(debug, "cpp_redis::tracking_client enables tracking with redirection to " + std::to_string(redirect_id));
+}
+
+} // namespace cpp_redis
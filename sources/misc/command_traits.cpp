@@ -0,0 +1,177 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/command_traits.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <set>
+#include <unordered_set>
+
+namespace cpp_redis {
+
+bool
+is_read_only_command(const std::string& command_name) {
+  static const std::unordered_set<std::string> read_only_commands = {
+    "BITCOUNT", "BITPOS", "DBSIZE", "DUMP", "EXISTS", "GEODIST", "GEOHASH", "GEOPOS",
+    "GEORADIUS_RO", "GEORADIUSBYMEMBER_RO", "GET", "GETBIT", "GETRANGE", "HEXISTS", "HGET", "HGETALL",
+    "HKEYS", "HLEN", "HMGET", "HSCAN", "HSTRLEN", "HVALS", "KEYS", "LINDEX",
+    "LLEN", "LRANGE", "MGET", "PTTL", "RANDOMKEY", "SCAN", "SCARD", "SDIFF",
+    "SINTER", "SISMEMBER", "SMEMBERS", "SRANDMEMBER", "SSCAN", "STRLEN", "SUBSTR", "SUNION",
+    "TTL", "TYPE", "XLEN", "XRANGE", "XREVRANGE", "ZCARD", "ZCOUNT", "ZLEXCOUNT",
+    "ZRANGE", "ZRANGEBYLEX", "ZRANGEBYSCORE", "ZRANK", "ZREVRANGE", "ZREVRANGEBYLEX", "ZREVRANGEBYSCORE", "ZREVRANK",
+    "ZSCAN", "ZSCORE"};
+
+  std::string name = command_name;
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  return read_only_commands.count(name) > 0;
+}
+
+bool
+is_read_only_command(const std::vector<std::string>& redis_cmd) {
+  return !redis_cmd.empty() && is_read_only_command(redis_cmd[0]);
+}
+
+bool
+is_blocking_command(const std::vector<std::string>& redis_cmd) {
+  static const std::unordered_set<std::string> blocking_commands = {"BLPOP", "BRPOP", "BRPOPLPUSH", "BZPOPMIN", "BZPOPMAX"};
+
+  if (redis_cmd.empty()) {
+    return false;
+  }
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  if (blocking_commands.count(name)) {
+    return true;
+  }
+
+  if (name != "XREAD" && name != "XREADGROUP") {
+    return false;
+  }
+
+  //! options come before STREAMS, keys and ids could be named BLOCK
+  for (std::size_t i = 1; i < redis_cmd.size(); ++i) {
+    std::string arg = redis_cmd[i];
+    std::transform(arg.begin(), arg.end(), arg.begin(), ::toupper);
+
+    if (arg == "STREAMS") {
+      return false;
+    }
+
+    if (arg == "BLOCK") {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool
+is_connection_state_command(const std::vector<std::string>& redis_cmd) {
+  static const std::unordered_set<std::string> state_commands = {
+    "ASKING", "AUTH", "DISCARD", "EXEC", "HELLO", "MONITOR", "MULTI", "PSUBSCRIBE", "PUNSUBSCRIBE", "QUIT",
+    "READONLY", "READWRITE", "RESET", "SELECT", "SUBSCRIBE", "UNSUBSCRIBE", "UNWATCH", "WATCH"};
+
+  //! CLIENT subcommands changing the connection
+  static const std::unordered_set<std::string> state_client_subcommands = {"REPLY", "SETNAME", "TRACKING"};
+
+  if (redis_cmd.empty()) {
+    return false;
+  }
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  if (name == "CLIENT" && redis_cmd.size() > 1) {
+    std::string subcommand = redis_cmd[1];
+    std::transform(subcommand.begin(), subcommand.end(), subcommand.begin(), ::toupper);
+
+    return state_client_subcommands.count(subcommand) > 0;
+  }
+
+  return state_commands.count(name) > 0;
+}
+
+bool
+get_command_key(const std::vector<std::string>& redis_cmd, std::string& key) {
+  if (redis_cmd.size() < 2) {
+    return false;
+  }
+
+  std::string name = redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  //! commands without key
+  static const std::set<std::string> keyless_commands = {
+    "AUTH", "BGREWRITEAOF", "BGSAVE", "CLIENT", "CLUSTER", "COMMAND", "CONFIG", "DBSIZE", "DEBUG", "ECHO",
+    "FLUSHALL", "FLUSHDB", "INFO", "KEYS", "LASTSAVE", "MONITOR", "PING", "PUBLISH", "PUBSUB", "RANDOMKEY",
+    "READONLY", "READWRITE", "ROLE", "SAVE", "SCAN", "SCRIPT", "SELECT", "SHUTDOWN", "SLAVEOF", "SLOWLOG",
+    "SWAPDB", "SYNC", "TIME", "WAIT"};
+
+  //! commands whose first key comes after a subcommand or an operation name
+  static const std::set<std::string> second_arg_key_commands = {"BITOP", "MEMORY", "OBJECT", "XGROUP", "XINFO"};
+
+  if (keyless_commands.count(name)) {
+    return false;
+  }
+
+  if (name == "EVAL" || name == "EVALSHA") {
+    if (redis_cmd.size() < 4 || std::strtol(redis_cmd[2].c_str(), nullptr, 10) <= 0) {
+      return false;
+    }
+
+    key = redis_cmd[3];
+    return true;
+  }
+
+  if (name == "XREAD" || name == "XREADGROUP") {
+    for (std::size_t i = 1; i + 1 < redis_cmd.size(); ++i) {
+      std::string arg = redis_cmd[i];
+      std::transform(arg.begin(), arg.end(), arg.begin(), ::toupper);
+
+      if (arg == "STREAMS") {
+        key = redis_cmd[i + 1];
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  if (second_arg_key_commands.count(name)) {
+    if (redis_cmd.size() < 3) {
+      return false;
+    }
+
+    key = redis_cmd[2];
+    return true;
+  }
+
+  key = redis_cmd[1];
+  return true;
+}
+
+} // namespace cpp_redis
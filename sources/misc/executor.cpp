@@ -0,0 +1,213 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/executor.hpp>
+#include <cpp_redis/misc/logger.hpp>
+
+#include <exception>
+
+namespace cpp_redis {
+
+void
+run_task(const executor_iface::task_t& task) {
+  try {
+    task();
+  }
+  catch (const std::exception& e) {
+    __CPP_REDIS_LOG(error, std::string("cpp_redis task threw an exception: ") + e.what());
+    (void) e;
+  }
+  catch (...) {
+    __CPP_REDIS_LOG(error, "cpp_redis task threw an exception");
+  }
+}
+
+void
+inline_executor::execute(const task_t& task) {
+  task();
+}
+
+thread_pool_executor::thread_pool_executor(std::size_t nb_threads)
+: m_stop(false) {
+  for (std::size_t i = 0; i < nb_threads; ++i) {
+    m_threads.push_back(std::thread(&thread_pool_executor::run, this));
+  }
+}
+
+thread_pool_executor::~thread_pool_executor(void) {
+  {
+    std::lock_guard<std::mutex> lock(m_tasks_mutex);
+    m_stop = true;
+  }
+
+  m_tasks_condvar.notify_all();
+
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void
+thread_pool_executor::execute(const task_t& task) {
+  {
+    std::lock_guard<std::mutex> lock(m_tasks_mutex);
+    m_tasks.push(task);
+  }
+
+  m_tasks_condvar.notify_one();
+}
+
+void
+thread_pool_executor::run(void) {
+  while (true) {
+    task_t task;
+
+    {
+      std::unique_lock<std::mutex> lock(m_tasks_mutex);
+      m_tasks_condvar.wait(lock, [&] { return m_stop || !m_tasks.empty(); });
+
+      //! remaining tasks are still executed on stop
+      if (m_tasks.empty()) {
+        return;
+      }
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+
+    run_task(task);
+  }
+}
+
+timer_executor::timer_executor(void)
+: m_sequence(0)
+, m_stop(false)
+, m_thread(&timer_executor::run, this) {}
+
+timer_executor::~timer_executor(void) {
+  {
+    std::lock_guard<std::mutex> lock(m_tasks_mutex);
+    m_stop = true;
+  }
+
+  m_tasks_condvar.notify_all();
+  m_thread.join();
+}
+
+void
+timer_executor::execute(const task_t& task) {
+  execute_after(std::chrono::steady_clock::duration::zero(), task);
+}
+
+void
+timer_executor::execute_after(std::chrono::steady_clock::duration delay, const task_t& task) {
+  {
+    std::lock_guard<std::mutex> lock(m_tasks_mutex);
+    m_tasks.push({std::chrono::steady_clock::now() + delay, m_sequence++, task});
+  }
+
+  m_tasks_condvar.notify_one();
+}
+
+void
+timer_executor::run(void) {
+  std::unique_lock<std::mutex> lock(m_tasks_mutex);
+
+  while (!m_stop) {
+    if (m_tasks.empty()) {
+      m_tasks_condvar.wait(lock);
+      continue;
+    }
+
+    auto deadline = m_tasks.top().deadline;
+
+    if (std::chrono::steady_clock::now() < deadline) {
+      m_tasks_condvar.wait_until(lock, deadline);
+      continue;
+    }
+
+    task_t task = std::move(const_cast<timed_task&>(m_tasks.top()).task);
+    m_tasks.pop();
+
+    lock.unlock();
+    run_task(task);
+    lock.lock();
+  }
+}
+
+serial_executor::serial_executor(const std::shared_ptr<executor_iface>& executor)
+: m_executor(executor)
+, m_state(std::make_shared<state>()) {}
+
+void
+serial_executor::execute(const task_t& task) {
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->tasks.push(task);
+
+    //! a drain is already scheduled and will pick up this task
+    if (m_state->running) {
+      return;
+    }
+
+    m_state->running = true;
+  }
+
+  std::shared_ptr<state> shared_state = m_state;
+  m_executor->execute([shared_state]() { drain(shared_state); });
+}
+
+void
+serial_executor::wait(void) {
+  std::unique_lock<std::mutex> lock(m_state->mutex);
+  m_state->condvar.wait(lock, [&] { return !m_state->running; });
+}
+
+void
+serial_executor::drain(const std::shared_ptr<state>& state) {
+  while (true) {
+    task_t task;
+
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+
+      if (state->tasks.empty()) {
+        state->running = false;
+        state->condvar.notify_all();
+        return;
+      }
+
+      task = std::move(state->tasks.front());
+      state->tasks.pop();
+    }
+
+    run_task(task);
+  }
+}
+
+const std::shared_ptr<executor_iface>&
+get_background_executor(void) {
+  static std::shared_ptr<executor_iface> background_executor = std::make_shared<thread_pool_executor>(1);
+  return background_executor;
+}
+
+} // namespace cpp_redis
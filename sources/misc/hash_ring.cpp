@@ -0,0 +1,121 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/hash_ring.hpp>
+
+#include <algorithm>
+
+namespace cpp_redis {
+
+hash_ring::hash_ring(std::size_t nb_virtual_nodes)
+: m_nb_virtual_nodes(nb_virtual_nodes ? nb_virtual_nodes : 1) {}
+
+std::uint64_t
+hash_ring::hash(const char* buffer, std::size_t size) {
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+
+  for (std::size_t i = 0; i < size; ++i) {
+    h ^= static_cast<std::uint8_t>(buffer[i]);
+    h *= 0x100000001b3ULL;
+  }
+
+  //! FNV-1a alone spreads short and similar strings (node#1, node#2, ...) poorly over the ring
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+
+  return h;
+}
+
+void
+hash_ring::add_node(const std::string& node, std::size_t weight) {
+  if (std::find(m_nodes.begin(), m_nodes.end(), node) != m_nodes.end()) {
+    return;
+  }
+
+  m_nodes.push_back(node);
+  m_weights.push_back(weight ? weight : 1);
+  build();
+}
+
+void
+hash_ring::remove_node(const std::string& node) {
+  auto it = std::find(m_nodes.begin(), m_nodes.end(), node);
+
+  if (it == m_nodes.end()) {
+    return;
+  }
+
+  m_weights.erase(m_weights.begin() + (it - m_nodes.begin()));
+  m_nodes.erase(it);
+  build();
+}
+
+void
+hash_ring::build(void) {
+  m_points.clear();
+
+  for (std::size_t i = 0; i < m_nodes.size(); ++i) {
+    std::size_t nb_points = m_nb_virtual_nodes * m_weights[i];
+
+    //! points only depend on the node name: the other nodes keep their points when a node is added or removed
+    for (std::size_t point = 0; point < nb_points; ++point) {
+      std::string name = m_nodes[i] + "#" + std::to_string(point);
+      m_points.push_back({hash(name.data(), name.size()), i});
+    }
+  }
+
+  std::sort(m_points.begin(), m_points.end());
+}
+
+std::size_t
+hash_ring::get_node_index(const std::string& key) const {
+  if (m_points.empty()) {
+    throw redis_error("cpp_redis::hash_ring is empty");
+  }
+
+  std::uint64_t key_hash = hash(key.data(), key.size());
+
+  auto it = std::lower_bound(m_points.begin(), m_points.end(), key_hash, [](const std::pair<std::uint64_t, std::size_t>& point, std::uint64_t value) { return point.first < value; });
+
+  //! wrap around the ring
+  if (it == m_points.end()) {
+    it = m_points.begin();
+  }
+
+  return it->second;
+}
+
+const std::string&
+hash_ring::get_node(const std::string& key) const {
+  return m_nodes[get_node_index(key)];
+}
+
+const std::vector<std::string>&
+hash_ring::get_nodes(void) const {
+  return m_nodes;
+}
+
+} // namespace cpp_redis
@@ -0,0 +1,192 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/hash_ring.hpp>
+#include <cpp_redis/misc/key_filter.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace cpp_redis {
+
+//!
+//! a block is a 64 bytes cache line
+//!
+static const std::size_t words_per_block  = 8;
+static const std::uint32_t bits_per_block = 512;
+static const std::size_t max_nb_hashes    = 16;
+
+//!
+//! false positive rate of a blocked bloom filter: the number of keys of a block follows a Poisson distribution, and each block behaves as a small bloom filter
+//!
+static double
+blocked_false_positive_rate(double keys_per_block, std::size_t nb_hashes) {
+  double rate        = 0;
+  double probability = std::exp(-keys_per_block);
+  std::size_t bound  = static_cast<std::size_t>(keys_per_block + 20 * std::sqrt(keys_per_block) + 20);
+
+  for (std::size_t i = 0; i < bound; ++i) {
+    double bit_set = 1 - std::pow(1 - 1.0 / bits_per_block, static_cast<double>(nb_hashes * i));
+    rate += probability * std::pow(bit_set, static_cast<double>(nb_hashes));
+    probability *= keys_per_block / static_cast<double>(i + 1);
+  }
+
+  return rate;
+}
+
+//!
+//! splitmix64 finalizer
+//!
+static std::uint64_t
+remix(std::uint64_t hash) {
+  hash += 0x9E3779B97F4A7C15ULL;
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+
+  return hash ^ (hash >> 31);
+}
+
+//!
+//! position in its block of the i-th bit of a key: 7 positions of 9 bits are taken from each hash, which is remixed once they are used
+//! (double hashing within such a small block would make the false positive rate several times worse)
+//!
+static std::uint32_t
+bit_position(std::uint64_t& bits, std::size_t i) {
+  if (i && i % 7 == 0) {
+    bits = remix(bits);
+  }
+
+  return static_cast<std::uint32_t>(bits >> (9 * (i % 7))) % bits_per_block;
+}
+
+key_filter::key_filter(std::size_t max_bytes, double false_positive_rate)
+: m_nb_blocks(std::max<std::size_t>(max_bytes / (words_per_block * sizeof(std::uint64_t)), 1))
+, m_ready(false)
+, m_additions(0)
+, m_positives(0)
+, m_negatives(0) {
+  if (!(false_positive_rate > 0 && false_positive_rate < 1)) {
+    throw redis_error("cpp_redis::key_filter false positive rate must be within ]0, 1[");
+  }
+
+  //! optimal number of bits set per key: log2(1 / p)
+  double nb_hashes = std::round(-std::log2(false_positive_rate));
+  m_nb_hashes      = std::min(std::max(static_cast<std::size_t>(nb_hashes), static_cast<std::size_t>(1)), max_nb_hashes);
+
+  //! blocks unevenly loaded make the rate worse than for a plain bloom filter of the same size: look for the load matching the target rate
+  double min_keys_per_block = 0;
+  double max_keys_per_block = bits_per_block;
+
+  for (int i = 0; i < 32; ++i) {
+    double keys_per_block = (min_keys_per_block + max_keys_per_block) / 2;
+
+    if (blocked_false_positive_rate(keys_per_block, m_nb_hashes) > false_positive_rate) {
+      max_keys_per_block = keys_per_block;
+    }
+    else {
+      min_keys_per_block = keys_per_block;
+    }
+  }
+
+  m_capacity = static_cast<std::size_t>(min_keys_per_block * static_cast<double>(m_nb_blocks));
+
+  m_words = std::unique_ptr<std::atomic<std::uint64_t>[]>(new std::atomic<std::uint64_t>[m_nb_blocks * words_per_block]);
+
+  for (std::size_t i = 0; i < m_nb_blocks * words_per_block; ++i) {
+    m_words[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void
+key_filter::add(const std::string& key) {
+  std::uint64_t bits;
+  std::size_t block = locate(key, bits);
+
+  for (std::size_t i = 0; i < m_nb_hashes; ++i) {
+    std::uint32_t bit = bit_position(bits, i);
+    m_words[block + bit / 64].fetch_or(static_cast<std::uint64_t>(1) << (bit % 64), std::memory_order_relaxed);
+  }
+
+  ++m_additions;
+}
+
+bool
+key_filter::may_exist(const std::string& key) {
+  if (!m_ready) {
+    ++m_positives;
+    return true;
+  }
+
+  std::uint64_t bits;
+  std::size_t block = locate(key, bits);
+
+  for (std::size_t i = 0; i < m_nb_hashes; ++i) {
+    std::uint32_t bit = bit_position(bits, i);
+
+    if (!(m_words[block + bit / 64].load(std::memory_order_relaxed) & (static_cast<std::uint64_t>(1) << (bit % 64)))) {
+      ++m_negatives;
+      return false;
+    }
+  }
+
+  ++m_positives;
+  return true;
+}
+
+void
+key_filter::clear(void) {
+  //! lookups must not rely on the bits being cleared
+  m_ready = false;
+
+  for (std::size_t i = 0; i < m_nb_blocks * words_per_block; ++i) {
+    m_words[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void
+key_filter::set_ready(bool ready) {
+  m_ready = ready;
+}
+
+bool
+key_filter::is_ready(void) const {
+  return m_ready;
+}
+
+key_filter::filter_stats
+key_filter::get_stats(void) const {
+  return {m_additions, m_positives, m_negatives, m_capacity, m_nb_blocks * words_per_block * sizeof(std::uint64_t)};
+}
+
+std::size_t
+key_filter::locate(const std::string& key, std::uint64_t& bits) const {
+  std::uint64_t hash = hash_ring::hash(key.data(), key.size());
+
+  //! the high bits pick the block (multiply-shift range reduction), a remix of the hash the bits within the block
+  std::size_t block = static_cast<std::size_t>(((hash >> 32) * m_nb_blocks) >> 32);
+  bits              = remix(hash);
+
+  return block * words_per_block;
+}
+
+} // namespace cpp_redis
@@ -0,0 +1,276 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/lz4_codec.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace cpp_redis {
+
+//!
+//! block format constraints: matches are at least 4 bytes long and within 64KB, the last 5 bytes are literals and the last match starts 12 bytes before the end at least
+//!
+static const std::size_t min_match       = 4;
+static const std::size_t last_literals   = 5;
+static const std::size_t match_limit     = 12;
+static const std::size_t max_distance    = 65535;
+static const unsigned int hash_log       = 12;
+static const unsigned int skip_trigger   = 6;
+static const std::size_t max_compression = 255;
+
+static std::uint32_t
+read32(const unsigned char* buffer) {
+  std::uint32_t value;
+  std::memcpy(&value, buffer, sizeof(value));
+
+  return value;
+}
+
+static std::uint32_t
+hash_sequence(std::uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - hash_log);
+}
+
+//!
+//! append a length beyond the 15 of its token: a run of 255 ended by a smaller byte
+//!
+static void
+write_length(std::string& output, std::size_t length) {
+  for (; length >= 255; length -= 255) {
+    output.push_back(static_cast<char>(255));
+  }
+
+  output.push_back(static_cast<char>(length));
+}
+
+//!
+//! append a sequence: token, literals and, unless this is the last sequence, the offset and length of the match
+//!
+static void
+write_sequence(std::string& output, const unsigned char* literals, std::size_t nb_literals, std::size_t offset, std::size_t match_length) {
+  std::size_t token_index = output.size();
+  unsigned char token     = static_cast<unsigned char>((nb_literals < 15 ? nb_literals : 15) << 4);
+
+  output.push_back(0);
+
+  if (nb_literals >= 15) {
+    write_length(output, nb_literals - 15);
+  }
+
+  output.append(reinterpret_cast<const char*>(literals), nb_literals);
+
+  if (match_length) {
+    std::size_t length = match_length - min_match;
+
+    output.push_back(static_cast<char>(offset & 0xff));
+    output.push_back(static_cast<char>(offset >> 8));
+    token = static_cast<unsigned char>(token | (length < 15 ? length : 15));
+
+    if (length >= 15) {
+      write_length(output, length - 15);
+    }
+  }
+
+  output[token_index] = static_cast<char>(token);
+}
+
+//!
+//! read a length beyond the 15 of its token
+//!
+static std::size_t
+read_length(const unsigned char*& input, const unsigned char* end) {
+  std::size_t length = 0;
+  unsigned char byte;
+
+  do {
+    if (input == end) {
+      throw redis_error("cpp_redis::lz4_codec truncated length");
+    }
+
+    byte = *input++;
+    length += byte;
+  } while (byte == 255);
+
+  return length;
+}
+
+const std::string&
+lz4_codec::get_magic(void) const {
+  static const std::string magic("\0LZ4", 4);
+  return magic;
+}
+
+void
+lz4_codec::compress(const std::string& input, std::string& output) const {
+  const unsigned char* src = reinterpret_cast<const unsigned char*>(input.data());
+  std::size_t size         = input.size();
+
+  output.clear();
+  output.reserve(size + size / 255 + 16);
+
+  //! size of the value
+  std::size_t value_size = size;
+
+  for (; value_size >= 0x80; value_size >>= 7) {
+    output.push_back(static_cast<char>((value_size & 0x7f) | 0x80));
+  }
+
+  output.push_back(static_cast<char>(value_size));
+
+  std::size_t anchor = 0;
+
+  if (size > match_limit) {
+    //! last position of the sequences starting with a given hash (the first byte is always a literal, so that 0 never matches itself)
+    std::vector<std::uint32_t> table(static_cast<std::size_t>(1) << hash_log, 0);
+    std::size_t last_match_start = size - match_limit;
+    std::size_t match_end_limit  = size - last_literals;
+    std::size_t pos              = 1;
+
+    while (pos <= last_match_start) {
+      std::uint32_t sequence = read32(src + pos);
+      std::uint32_t& entry   = table[hash_sequence(sequence)];
+      std::size_t candidate  = entry;
+      entry                  = static_cast<std::uint32_t>(pos);
+
+      if (pos - candidate > max_distance || read32(src + candidate) != sequence) {
+        //! the longer no match is found, the larger the steps
+        pos += 1 + ((pos - anchor) >> skip_trigger);
+        continue;
+      }
+
+      //! extend the match backward over the pending literals, then forward
+      while (pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1]) {
+        --pos;
+        --candidate;
+      }
+
+      std::size_t length = min_match;
+      while (pos + length < match_end_limit && src[candidate + length] == src[pos + length]) {
+        ++length;
+      }
+
+      write_sequence(output, src + anchor, pos - anchor, pos - candidate, length);
+
+      pos += length;
+      anchor = pos;
+
+      //! keep the position before the end of the match, which often starts the next one
+      if (pos - 2 <= last_match_start) {
+        table[hash_sequence(read32(src + pos - 2))] = static_cast<std::uint32_t>(pos - 2);
+      }
+    }
+  }
+
+  write_sequence(output, src + anchor, size - anchor, 0, 0);
+}
+
+void
+lz4_codec::decompress(const char* input, std::size_t size, std::string& output) const {
+  const unsigned char* in  = reinterpret_cast<const unsigned char*>(input);
+  const unsigned char* end = in + size;
+
+  //! size of the value
+  std::size_t value_size = 0;
+  unsigned int shift     = 0;
+
+  for (;; shift += 7) {
+    if (in == end || shift >= 8 * sizeof(std::size_t)) {
+      throw redis_error("cpp_redis::lz4_codec invalid size");
+    }
+
+    value_size |= static_cast<std::size_t>(*in & 0x7f) << shift;
+
+    if (!(*in++ & 0x80)) {
+      break;
+    }
+  }
+
+  //! reject corrupted sizes before allocating
+  if (value_size / max_compression > static_cast<std::size_t>(end - in)) {
+    throw redis_error("cpp_redis::lz4_codec invalid size");
+  }
+
+  output.resize(value_size);
+  char* out         = &output[0];
+  std::size_t index = 0;
+
+  while (in < end) {
+    unsigned char token     = *in++;
+    std::size_t nb_literals = token >> 4;
+
+    if (nb_literals == 15) {
+      nb_literals += read_length(in, end);
+    }
+
+    if (nb_literals > static_cast<std::size_t>(end - in) || nb_literals > value_size - index) {
+      throw redis_error("cpp_redis::lz4_codec literals out of bounds");
+    }
+
+    std::memcpy(out + index, in, nb_literals);
+    in += nb_literals;
+    index += nb_literals;
+
+    //! the last sequence has no match
+    if (in == end) {
+      break;
+    }
+
+    if (end - in < 2) {
+      throw redis_error("cpp_redis::lz4_codec truncated offset");
+    }
+
+    std::size_t offset = static_cast<std::size_t>(in[0]) | (static_cast<std::size_t>(in[1]) << 8);
+    in += 2;
+
+    std::size_t length = token & 0x0f;
+
+    if (length == 15) {
+      length += read_length(in, end);
+    }
+
+    length += min_match;
+
+    if (!offset || offset > index || length > value_size - index) {
+      throw redis_error("cpp_redis::lz4_codec match out of bounds");
+    }
+
+    //! overlapping matches repeat the last offset bytes
+    if (offset >= length) {
+      std::memcpy(out + index, out + index - offset, length);
+      index += length;
+    }
+    else {
+      for (std::size_t i = 0; i < length; ++i, ++index) {
+        out[index] = out[index - offset];
+      }
+    }
+  }
+
+  if (index != value_size) {
+    throw redis_error("cpp_redis::lz4_codec truncated data");
+  }
+}
+
+} // namespace cpp_redis
@@ -0,0 +1,142 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/multi_key_command.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+namespace cpp_redis {
+
+//!
+//! \return number of arguments per key (2 for MSET key value pairs), 0 if the command is not a supported multi-key command
+//!
+static std::size_t
+get_key_step(const std::string& command_name) {
+  std::string name = command_name;
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  if (name == "MSET") {
+    return 2;
+  }
+
+  if (name == "DEL" || name == "EXISTS" || name == "MGET" || name == "TOUCH" || name == "UNLINK") {
+    return 1;
+  }
+
+  return 0;
+}
+
+std::map<std::size_t, multi_key_command_part>
+split_multi_key_command(const std::vector<std::string>& redis_cmd, const std::function<std::size_t(const std::string&)>& get_group) {
+  std::map<std::size_t, multi_key_command_part> parts;
+
+  if (redis_cmd.size() < 2) {
+    return parts;
+  }
+
+  std::size_t step = get_key_step(redis_cmd[0]);
+  if (!step || (redis_cmd.size() - 1) % step) {
+    return parts;
+  }
+
+  std::size_t nb_keys = (redis_cmd.size() - 1) / step;
+
+  for (std::size_t i = 0; i < nb_keys; ++i) {
+    auto first = redis_cmd.begin() + 1 + i * step;
+    auto& part = parts[get_group(*first)];
+
+    if (part.command.empty()) {
+      part.command.push_back(redis_cmd[0]);
+    }
+
+    part.command.insert(part.command.end(), first, first + step);
+    part.indexes.push_back(i);
+  }
+
+  return parts;
+}
+
+multi_key_reply_merger::multi_key_reply_merger(const std::vector<std::string>& redis_cmd, std::size_t nb_parts, const std::function<void(reply&)>& callback)
+: m_is_mget(false)
+, m_is_mset(false)
+, m_remaining(nb_parts)
+, m_count(0)
+, m_callback(callback) {
+  std::string name = redis_cmd.empty() ? "" : redis_cmd[0];
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+  m_is_mget = name == "MGET";
+  m_is_mset = name == "MSET";
+
+  if (m_is_mget) {
+    m_values.resize(redis_cmd.size() - 1);
+  }
+}
+
+void
+multi_key_reply_merger::add_reply(const multi_key_command_part& part, reply& reply) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (reply.is_error()) {
+      if (m_error.empty()) {
+        m_error = reply.error();
+      }
+    }
+    else if (m_is_mget && reply.is_array() && reply.as_array().size() == part.indexes.size()) {
+      for (std::size_t i = 0; i < part.indexes.size(); ++i) {
+        m_values[part.indexes[i]] = reply.as_array()[i];
+      }
+    }
+    else if (reply.is_integer()) {
+      m_count += reply.as_integer();
+    }
+
+    if (--m_remaining) {
+      return;
+    }
+  }
+
+  if (!m_callback) {
+    return;
+  }
+
+  cpp_redis::reply merged;
+
+  if (!m_error.empty()) {
+    merged.set(m_error, reply::string_type::error);
+  }
+  else if (m_is_mget) {
+    merged.set(m_values);
+  }
+  else if (m_is_mset) {
+    merged.set("OK", reply::string_type::simple_string);
+  }
+  else {
+    merged.set(m_count);
+  }
+
+  m_callback(merged);
+}
+
+} // namespace cpp_redis
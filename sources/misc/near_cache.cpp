@@ -0,0 +1,392 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/hash_ring.hpp>
+#include <cpp_redis/misc/near_cache.hpp>
+
+namespace cpp_redis {
+
+//!
+//! special values of the hashes of the slots
+//!
+static const std::uint64_t empty_slot   = 0;
+static const std::uint64_t deleted_slot = 1;
+
+//!
+//! capacity of a shard table on first insertion (power of 2)
+//!
+static const std::size_t initial_capacity = 16;
+
+static const std::size_t npos = static_cast<std::size_t>(-1);
+
+std::size_t
+approximate_reply_size(const reply& value) {
+  std::size_t size = sizeof(reply);
+
+  if (value.is_array()) {
+    for (const auto& row : value.as_array()) {
+      size += approximate_reply_size(row);
+    }
+  }
+  else if (value.is_string() || value.is_error()) {
+    size += value.as_string().size();
+  }
+
+  return size;
+}
+
+near_cache::near_cache(std::size_t max_bytes, const std::chrono::milliseconds& ttl, std::size_t nb_shards, const ttl_policy_t& ttl_policy)
+: m_max_bytes_per_shard(max_bytes / (nb_shards ? nb_shards : 1))
+, m_ttl(ttl)
+, m_ttl_policy(ttl_policy)
+, m_next_ticket(0)
+, m_hits(0)
+, m_misses(0)
+, m_expirations(0)
+, m_invalidations(0)
+, m_evictions(0) {
+  for (std::size_t i = 0; i < (nb_shards ? nb_shards : 1); ++i) {
+    m_shards.push_back(std::unique_ptr<shard>(new shard));
+  }
+}
+
+bool
+near_cache::lookup(const std::string& key, const std::string& signature, reply& value, std::uint64_t& ticket) {
+  std::uint64_t hash = hash_key(key);
+  shard& shard       = get_shard(hash);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  std::size_t slot = find(shard, key, hash);
+  if (slot == npos) {
+    slot = insert(shard, key, hash);
+  }
+
+  entry& entry     = shard.entries[slot];
+  entry.referenced = true;
+
+  cached_reply* cached = nullptr;
+  for (auto& candidate : entry.replies) {
+    if (candidate.signature == signature) {
+      cached = &candidate;
+      break;
+    }
+  }
+
+  if (cached && cached->filled) {
+    if (std::chrono::steady_clock::now() < cached->expires_at) {
+      value = cached->value;
+      ++m_hits;
+      return true;
+    }
+
+    //! expired: the reply becomes a placeholder again
+    std::size_t reply_bytes = cached->bytes - sizeof(cached_reply) - signature.size();
+    cached->value = reply();
+    cached->bytes -= reply_bytes;
+    entry.bytes -= reply_bytes;
+    shard.bytes -= reply_bytes;
+    ++m_expirations;
+  }
+  else if (!cached) {
+    std::size_t bytes = sizeof(cached_reply) + signature.size();
+    entry.replies.push_back({signature, reply(), 0, false, bytes, std::chrono::steady_clock::time_point()});
+    entry.bytes += bytes;
+    shard.bytes += bytes;
+    cached = &entry.replies.back();
+  }
+
+  //! a read already in flight loses its placeholder: only the most recent read fills the entry
+  ticket         = ++m_next_ticket;
+  cached->ticket = ticket;
+  cached->filled = false;
+  ++m_misses;
+
+  evict(shard);
+
+  return false;
+}
+
+void
+near_cache::fill(const std::string& key, const std::string& signature, std::uint64_t ticket, const reply& value) {
+  if (value.is_error()) {
+    cancel(key, signature, ticket);
+    return;
+  }
+
+  std::chrono::milliseconds ttl = m_ttl_policy ? m_ttl_policy(key) : m_ttl;
+  std::size_t reply_bytes       = approximate_reply_size(value);
+  std::uint64_t hash            = hash_key(key);
+  shard& shard                  = get_shard(hash);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  //! the placeholder is gone if the key has been invalidated or evicted while the read was in flight
+  std::size_t slot = find(shard, key, hash);
+  if (slot == npos) {
+    return;
+  }
+
+  entry& entry = shard.entries[slot];
+
+  for (std::size_t i = 0; i < entry.replies.size(); ++i) {
+    cached_reply& cached = entry.replies[i];
+
+    if (cached.signature != signature) {
+      continue;
+    }
+
+    if (cached.filled || cached.ticket != ticket) {
+      return;
+    }
+
+    if (ttl <= std::chrono::milliseconds(0) || entry.bytes + reply_bytes > m_max_bytes_per_shard) {
+      drop_reply(shard, slot, i);
+      return;
+    }
+
+    cached.value      = value;
+    cached.filled     = true;
+    cached.expires_at = std::chrono::steady_clock::now() + ttl;
+    cached.bytes += reply_bytes;
+    entry.bytes += reply_bytes;
+    shard.bytes += reply_bytes;
+    entry.referenced = true;
+
+    evict(shard);
+    return;
+  }
+}
+
+void
+near_cache::cancel(const std::string& key, const std::string& signature, std::uint64_t ticket) {
+  std::uint64_t hash = hash_key(key);
+  shard& shard       = get_shard(hash);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  std::size_t slot = find(shard, key, hash);
+  if (slot == npos) {
+    return;
+  }
+
+  const entry& entry = shard.entries[slot];
+
+  for (std::size_t i = 0; i < entry.replies.size(); ++i) {
+    const cached_reply& cached = entry.replies[i];
+
+    if (cached.signature == signature) {
+      if (!cached.filled && cached.ticket == ticket) {
+        drop_reply(shard, slot, i);
+      }
+
+      return;
+    }
+  }
+}
+
+void
+near_cache::invalidate(const std::string& key) {
+  std::uint64_t hash = hash_key(key);
+  shard& shard       = get_shard(hash);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  std::size_t slot = find(shard, key, hash);
+  if (slot == npos) {
+    return;
+  }
+
+  erase(shard, slot);
+  ++m_invalidations;
+}
+
+void
+near_cache::clear(void) {
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+
+    std::vector<std::uint64_t>().swap(shard->hashes);
+    std::vector<entry>().swap(shard->entries);
+    shard->size    = 0;
+    shard->deleted = 0;
+    shard->bytes   = 0;
+    shard->hand    = 0;
+  }
+}
+
+near_cache::cache_stats
+near_cache::get_stats(void) const {
+  cache_stats stats = {m_hits, m_misses, m_expirations, m_invalidations, m_evictions, 0, 0};
+
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+
+    stats.keys += shard->size;
+    stats.bytes += shard->bytes;
+  }
+
+  return stats;
+}
+
+std::uint64_t
+near_cache::hash_key(const std::string& key) {
+  std::uint64_t hash = hash_ring::hash(key.data(), key.size());
+
+  return hash > deleted_slot ? hash : hash + 2;
+}
+
+near_cache::shard&
+near_cache::get_shard(std::uint64_t hash) {
+  //! the low bits pick the slot within the shard
+  return *m_shards[(hash >> 32) % m_shards.size()];
+}
+
+std::size_t
+near_cache::find(const shard& shard, const std::string& key, std::uint64_t hash) {
+  if (shard.hashes.empty()) {
+    return npos;
+  }
+
+  std::size_t mask = shard.hashes.size() - 1;
+
+  //! the load factor keeps empty slots in the table, ending the probe sequence
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    std::uint64_t slot_hash = shard.hashes[slot];
+
+    if (slot_hash == empty_slot) {
+      return npos;
+    }
+
+    if (slot_hash == hash && shard.entries[slot].key == key) {
+      return slot;
+    }
+  }
+}
+
+std::size_t
+near_cache::insert(shard& shard, const std::string& key, std::uint64_t hash) {
+  if (shard.hashes.empty()) {
+    rehash(shard, initial_capacity);
+  }
+  else if ((shard.size + shard.deleted + 1) * 4 > shard.hashes.size() * 3) {
+    //! grow when mostly full of live keys, otherwise only drop the deleted slots
+    rehash(shard, (shard.size + 1) * 2 > shard.hashes.size() ? shard.hashes.size() * 2 : shard.hashes.size());
+  }
+
+  std::size_t mask = shard.hashes.size() - 1;
+  std::size_t slot = hash & mask;
+
+  while (shard.hashes[slot] != empty_slot && shard.hashes[slot] != deleted_slot) {
+    slot = (slot + 1) & mask;
+  }
+
+  if (shard.hashes[slot] == deleted_slot) {
+    --shard.deleted;
+  }
+
+  entry& entry     = shard.entries[slot];
+  entry.key        = key;
+  entry.referenced = true;
+  entry.bytes      = sizeof(near_cache::entry) + key.size();
+
+  shard.hashes[slot] = hash;
+  shard.bytes += entry.bytes;
+  ++shard.size;
+
+  return slot;
+}
+
+void
+near_cache::erase(shard& shard, std::size_t slot) {
+  shard.bytes -= shard.entries[slot].bytes;
+  shard.entries[slot] = entry();
+  shard.hashes[slot]  = deleted_slot;
+  --shard.size;
+  ++shard.deleted;
+}
+
+void
+near_cache::rehash(shard& shard, std::size_t capacity) {
+  std::vector<std::uint64_t> hashes(capacity, empty_slot);
+  std::vector<entry> entries(capacity);
+  std::size_t mask = capacity - 1;
+
+  for (std::size_t i = 0; i < shard.hashes.size(); ++i) {
+    if (shard.hashes[i] == empty_slot || shard.hashes[i] == deleted_slot) {
+      continue;
+    }
+
+    std::size_t slot = shard.hashes[i] & mask;
+    while (hashes[slot] != empty_slot) {
+      slot = (slot + 1) & mask;
+    }
+
+    hashes[slot]  = shard.hashes[i];
+    entries[slot] = std::move(shard.entries[i]);
+  }
+
+  shard.hashes.swap(hashes);
+  shard.entries.swap(entries);
+  shard.deleted = 0;
+  shard.hand    = 0;
+}
+
+void
+near_cache::evict(shard& shard) {
+  std::size_t mask = shard.hashes.size() - 1;
+
+  //! CLOCK: referenced keys get a second chance, terminates within two rounds
+  while (shard.bytes > m_max_bytes_per_shard && shard.size) {
+    std::size_t slot = shard.hand;
+    shard.hand       = (shard.hand + 1) & mask;
+
+    if (shard.hashes[slot] == empty_slot || shard.hashes[slot] == deleted_slot) {
+      continue;
+    }
+
+    entry& entry = shard.entries[slot];
+
+    if (entry.referenced) {
+      entry.referenced = false;
+      continue;
+    }
+
+    erase(shard, slot);
+    ++m_evictions;
+  }
+}
+
+void
+near_cache::drop_reply(shard& shard, std::size_t slot, std::size_t reply_index) {
+  entry& entry = shard.entries[slot];
+
+  entry.bytes -= entry.replies[reply_index].bytes;
+  shard.bytes -= entry.replies[reply_index].bytes;
+  entry.replies.erase(entry.replies.begin() + reply_index);
+
+  if (entry.replies.empty()) {
+    erase(shard, slot);
+  }
+}
+
+} // namespace cpp_redis
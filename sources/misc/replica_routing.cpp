@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/replica_routing.hpp>
+
+namespace cpp_redis {
+
+latency_ewma::latency_ewma(double weight)
+: m_weight(0.2)
+, m_value(0) {
+  set_weight(weight);
+}
+
+void
+latency_ewma::set_weight(double weight) {
+  if (weight > 0 && weight <= 1) {
+    m_weight = weight;
+  }
+}
+
+void
+latency_ewma::seed(std::chrono::microseconds rtt) {
+  if (!m_value) {
+    m_value = static_cast<double>(rtt.count());
+  }
+}
+
+void
+latency_ewma::add_sample(double usecs) {
+  m_value = m_value ? m_value + m_weight * (usecs - m_value) : usecs;
+}
+
+double
+latency_ewma::get(void) const {
+  return m_value;
+}
+
+double
+routing_score(double latency_usecs, std::size_t nb_pending) {
+  return latency_usecs * static_cast<double>(nb_pending + 1);
+}
+
+std::size_t
+select_by_routing_score(const std::vector<double>& scores, std::size_t decision, double probe_rate) {
+  std::size_t nb_candidates = scores.size();
+  std::size_t probe_period  = probe_rate > 0 ? static_cast<std::size_t>(1 / probe_rate) : 0;
+
+  if (probe_period && decision % probe_period == 0) {
+    return (decision / probe_period) % nb_candidates;
+  }
+
+  std::size_t selected = 0;
+  double best_score    = 0;
+
+  for (std::size_t i = 0; i < nb_candidates; ++i) {
+    std::size_t index = (decision + i) % nb_candidates;
+
+    if (i == 0 || scores[index] < best_score) {
+      best_score = scores[index];
+      selected   = index;
+    }
+  }
+
+  return selected;
+}
+
+} // namespace cpp_redis
@@ -0,0 +1,184 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/value_traits.hpp>
+
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace cpp_redis {
+
+std::size_t
+format_number(uint64_t value, char* buffer) {
+  //! digits are produced from the least significant one: fill a scratch buffer from its end
+  char digits[20];
+  char* first = digits + sizeof(digits);
+
+  do {
+    *--first = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  std::size_t length = static_cast<std::size_t>(digits + sizeof(digits) - first);
+  std::memcpy(buffer, first, length);
+
+  return length;
+}
+
+std::size_t
+format_number(int64_t value, char* buffer) {
+  if (value >= 0) {
+    return format_number(static_cast<uint64_t>(value), buffer);
+  }
+
+  //! negate in unsigned arithmetic so that INT64_MIN does not overflow
+  *buffer = '-';
+  return format_number(0 - static_cast<uint64_t>(value), buffer + 1) + 1;
+}
+
+//!
+//! %g with the smallest precision that parses back to value
+//! any decimal number of at most min_precision significant digits round trips through T, so %.<min_precision>g already is the shortest representation when there is one within these digits
+//!
+template <typename T>
+static std::size_t
+format_shortest(T value, char* buffer, int min_precision, int max_precision, T (*parse)(const char*, char**)) {
+  if (std::isnan(value)) {
+    std::memcpy(buffer, "nan", 3);
+    return 3;
+  }
+
+  if (std::isinf(value)) {
+    //! spelling accepted by redis for infinite scores and increments
+    std::memcpy(buffer, value < 0 ? "-inf" : "inf", value < 0 ? 4 : 3);
+    return value < 0 ? 4 : 3;
+  }
+
+  int length = 0;
+
+  for (int precision = min_precision; precision <= max_precision; ++precision) {
+    length = std::snprintf(buffer, max_number_length, "%.*g", precision, static_cast<double>(value));
+
+    if (parse(buffer, nullptr) == value) {
+      break;
+    }
+  }
+
+  return static_cast<std::size_t>(length);
+}
+
+std::size_t
+format_number(double value, char* buffer) {
+  return format_shortest<double>(value, buffer, DBL_DIG, 17, std::strtod);
+}
+
+std::size_t
+format_number(float value, char* buffer) {
+  return format_shortest<float>(value, buffer, FLT_DIG, 9, std::strtof);
+}
+
+bool
+parse_number(const char* first, const char* last, uint64_t& value) {
+  if (first == last) {
+    return false;
+  }
+
+  uint64_t result = 0;
+
+  for (; first != last; ++first) {
+    if (*first < '0' || *first > '9') {
+      return false;
+    }
+
+    unsigned int digit = static_cast<unsigned int>(*first - '0');
+
+    if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+      return false;
+    }
+
+    result = result * 10 + digit;
+  }
+
+  value = result;
+  return true;
+}
+
+bool
+parse_number(const char* first, const char* last, int64_t& value) {
+  bool negative = first != last && *first == '-';
+  uint64_t magnitude;
+
+  if (!parse_number(negative ? first + 1 : first, last, magnitude)) {
+    return false;
+  }
+
+  if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0)) {
+    return false;
+  }
+
+  value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+  return true;
+}
+
+//!
+//! strto* need a null terminated string: numbers sent by redis are short, copy them on the stack
+//!
+template <typename T>
+static bool
+parse_floating_point(const char* first, const char* last, T& value, T (*parse)(const char*, char**)) {
+  char buffer[128];
+  std::size_t length = static_cast<std::size_t>(last - first);
+
+  //! strto* skip leading spaces and accept hexadecimal numbers, redis never sends any
+  if (length == 0 || length >= sizeof(buffer) || std::isspace(static_cast<unsigned char>(*first)) || std::memchr(first, 'x', length) || std::memchr(first, 'X', length)) {
+    return false;
+  }
+
+  std::memcpy(buffer, first, length);
+  buffer[length] = '\0';
+
+  char* end;
+  T result = parse(buffer, &end);
+
+  if (end != buffer + length) {
+    return false;
+  }
+
+  value = result;
+  return true;
+}
+
+bool
+parse_number(const char* first, const char* last, double& value) {
+  return parse_floating_point<double>(first, last, value, std::strtod);
+}
+
+bool
+parse_number(const char* first, const char* last, float& value) {
+  return parse_floating_point<float>(first, last, value, std::strtof);
+}
+
+} // namespace cpp_redis
@@ -41,6 +41,7 @@ redis_connection::redis_connection(void)
 redis_connection::redis_connection(const std::shared_ptr<tcp_client_iface>& client)
 : m_client(client)
 , m_reply_callback(nullptr)
+, m_replies_callback(nullptr)
 , m_disconnection_handler(nullptr) {
   __CPP_REDIS_LOG(debug, "cpp_redis::network::redis_connection created");
 }
@@ -54,12 +55,22 @@ void
 redis_connection::connect(const std::string& host, std::size_t port,
   const disconnection_handler_t& client_disconnection_handler,
   const reply_callback_t& client_reply_callback,
-  std::uint32_t timeout_msecs) {
+  std::uint32_t timeout_msecs,
+  const connection_options& options) {
   try {
     __CPP_REDIS_LOG(debug, "cpp_redis::network::redis_connection attempts to connect");
 
     //! connect client
-    m_client->connect(host, (uint32_t) port, timeout_msecs);
+    //! unix://<path> addresses a unix domain socket, which tcp_client_iface expects as <path> with port 0
+    if (is_unix_socket_uri(host)) {
+      m_client->connect(host.substr(sizeof(__CPP_REDIS_UNIX_SOCKET_URI_PREFIX) - 1), 0, timeout_msecs);
+    }
+    else {
+      m_client->connect(host, (uint32_t) port, timeout_msecs);
+    }
+
+    //! tune the underlying socket
+    m_client->set_connection_options(options);
     m_client->set_on_disconnection_handler(std::bind(&redis_connection::tcp_client_disconnection_handler, this));
 
     //! start to read asynchronously
@@ -77,6 +88,11 @@ redis_connection::connect(const std::string& host, std::size_t port,
   m_disconnection_handler = client_disconnection_handler;
 }
 
+void
+redis_connection::set_replies_callback(const replies_callback_t& replies_callback) {
+  m_replies_callback = replies_callback;
+}
+
 void
 redis_connection::disconnect(bool wait_for_removal) {
   __CPP_REDIS_LOG(debug, "cpp_redis::network::redis_connection attempts to disconnect");
@@ -97,6 +113,11 @@ redis_connection::is_connected(void) const {
   return m_client->is_connected();
 }
 
+bool
+redis_connection::is_unix_socket_uri(const std::string& host) {
+  return host.compare(0, sizeof(__CPP_REDIS_UNIX_SOCKET_URI_PREFIX) - 1, __CPP_REDIS_UNIX_SOCKET_URI_PREFIX) == 0;
+}
+
 std::string
 redis_connection::build_command(const std::vector<std::string>& redis_cmd) {
   std::string cmd = "*" + std::to_string(redis_cmd.size()) + "\r\n";
@@ -162,13 +183,23 @@ redis_connection::tcp_client_receive_handler(const tcp_client_iface::read_result
     return;
   }
 
+  std::vector<reply> replies;
+
   while (m_builder.reply_available()) {
     __CPP_REDIS_LOG(debug, "cpp_redis::network::redis_connection reply fully built");
 
-    auto reply = m_builder.get_front();
+    replies.push_back(m_builder.get_front());
     m_builder.pop_front();
+  }
 
-    if (m_reply_callback) {
+  if (m_replies_callback) {
+    if (!replies.empty()) {
+      __CPP_REDIS_LOG(debug, "cpp_redis::network::redis_connection executes replies callback");
+      m_replies_callback(*this, replies);
+    }
+  }
+  else if (m_reply_callback) {
+    for (auto& reply : replies) {
       __CPP_REDIS_LOG(debug, "cpp_redis::network::redis_connection executes reply callback");
       m_reply_callback(*this, reply);
     }
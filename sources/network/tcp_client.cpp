@@ -20,65 +20,352 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <cpp_redis/misc/logger.hpp>
 #include <cpp_redis/misc/macro.hpp>
 #include <cpp_redis/network/tcp_client.hpp>
 
+#include <functional>
+#include <mutex>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#else
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif /* _WIN32 */
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif /* __linux__ */
+
 namespace cpp_redis {
 
 namespace network {
 
+//!
+//! io service dedicated to a subset of the connections in sharded reactor mode
+//!
+struct io_shard {
+  std::shared_ptr<tacopie::io_service> io_service;
+  int cpu;
+};
+
+static std::mutex io_shards_mutex;
+static std::vector<io_shard> io_shards;
+static std::size_t next_io_shard = 0;
+
+static void
+pin_current_thread(int cpu) {
+  //! io shards run a single worker: pin it the first time it runs one of our callbacks
+  static thread_local int pinned_cpu = -1;
+
+  if (cpu < 0 || pinned_cpu == cpu) {
+    return;
+  }
+
+  pinned_cpu = cpu;
+
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::network::tcp_client could not pin io worker to cpu " + std::to_string(cpu));
+  }
+#elif defined(_WIN32)
+  if (!SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu)) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::network::tcp_client could not pin io worker to cpu " + std::to_string(cpu));
+  }
+#endif /* __linux__ */
+}
+
+static void
+set_socket_option(tacopie::fd_t fd, int level, int option, int value, const char* option_name) {
+#ifdef _WIN32
+  int ret = setsockopt(fd, level, option, reinterpret_cast<const char*>(&value), sizeof(value));
+#else
+  int ret = setsockopt(fd, level, option, &value, sizeof(value));
+#endif /* _WIN32 */
+
+  if (ret != 0) {
+    __CPP_REDIS_LOG(warn, std::string("cpp_redis::network::tcp_client could not set socket option ") + option_name);
+  }
+
+  (void) option_name;
+}
+
+tcp_client::tcp_client(void)
+: m_io_service(tacopie::get_default_io_service())
+, m_is_connected(false) {
+  std::lock_guard<std::mutex> lock(io_shards_mutex);
+
+  if (io_shards.empty()) {
+    return;
+  }
+
+  const io_shard& shard = io_shards[next_io_shard++ % io_shards.size()];
+  m_io_service          = shard.io_service;
+  m_cpu                 = shard.cpu;
+  m_is_sharded          = true;
+}
+
+tcp_client::~tcp_client(void) {
+  disconnect(true);
+}
+
 void
 tcp_client::connect(const std::string& addr, std::uint32_t port, std::uint32_t timeout_msecs) {
-  m_client.connect(addr, port, timeout_msecs);
-}
+  if (m_is_connected) {
+    throw redis_error("cpp_redis::network::tcp_client is already connected");
+  }
+
+  try {
+    m_socket.connect(addr, port, timeout_msecs);
+    m_io_service->track(m_socket);
+  }
+  catch (const tacopie::tacopie_error&) {
+    m_socket.close();
+    throw;
+  }
 
+  m_is_unix_socket = port == 0;
+  m_is_connected   = true;
+}
 
 void
 tcp_client::disconnect(bool wait_for_removal) {
-  m_client.disconnect(wait_for_removal);
+  if (!m_is_connected.exchange(false)) {
+    return;
+  }
+
+  clear_read_requests();
+  clear_write_requests();
+
+  m_io_service->untrack(m_socket);
+
+  if (wait_for_removal) {
+    m_io_service->wait_for_removal(m_socket);
+  }
+
+  m_socket.close();
 }
 
 bool
 tcp_client::is_connected(void) const {
-  return m_client.is_connected();
+  return m_is_connected;
+}
+
+void
+tcp_client::set_connection_options(const connection_options& options) {
+  tacopie::fd_t fd = m_socket.get_fd();
+
+  if (options.send_buffer_size) {
+    set_socket_option(fd, SOL_SOCKET, SO_SNDBUF, static_cast<int>(options.send_buffer_size), "SO_SNDBUF");
+  }
+
+  if (options.receive_buffer_size) {
+    set_socket_option(fd, SOL_SOCKET, SO_RCVBUF, static_cast<int>(options.receive_buffer_size), "SO_RCVBUF");
+  }
+
+#ifdef SO_BUSY_POLL
+  if (options.busy_poll_usecs) {
+    set_socket_option(fd, SOL_SOCKET, SO_BUSY_POLL, static_cast<int>(options.busy_poll_usecs), "SO_BUSY_POLL");
+  }
+#endif /* SO_BUSY_POLL */
+
+  //! the remaining options only make sense for TCP
+  if (m_is_unix_socket) {
+    return;
+  }
+
+  if (options.tcp_nodelay) {
+    set_socket_option(fd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+  }
+
+  if (options.keepalive) {
+    set_socket_option(fd, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE");
+
+#if defined(TCP_KEEPIDLE)
+    if (options.keepalive_idle_secs) {
+      set_socket_option(fd, IPPROTO_TCP, TCP_KEEPIDLE, static_cast<int>(options.keepalive_idle_secs), "TCP_KEEPIDLE");
+    }
+#elif defined(TCP_KEEPALIVE)
+    if (options.keepalive_idle_secs) {
+      set_socket_option(fd, IPPROTO_TCP, TCP_KEEPALIVE, static_cast<int>(options.keepalive_idle_secs), "TCP_KEEPALIVE");
+    }
+#endif /* TCP_KEEPIDLE */
+
+#ifdef TCP_KEEPINTVL
+    if (options.keepalive_interval_secs) {
+      set_socket_option(fd, IPPROTO_TCP, TCP_KEEPINTVL, static_cast<int>(options.keepalive_interval_secs), "TCP_KEEPINTVL");
+    }
+#endif /* TCP_KEEPINTVL */
+
+#ifdef TCP_KEEPCNT
+    if (options.keepalive_count) {
+      set_socket_option(fd, IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(options.keepalive_count), "TCP_KEEPCNT");
+    }
+#endif /* TCP_KEEPCNT */
+  }
 }
 
 void
 tcp_client::set_nb_workers(std::size_t nb_threads) {
-  m_client.get_io_service()->set_nb_workers(nb_threads);
+  //! more workers would run the callbacks of the shard connections concurrently and break the pinning
+  if (m_is_sharded) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::network::tcp_client ignores set_nb_workers() on a connection attached to an io shard");
+    return;
+  }
+
+  m_io_service->set_nb_workers(nb_threads);
 }
 
 void
 tcp_client::async_read(read_request& request) {
-  auto callback = std::move(request.async_read_callback);
+  std::lock_guard<std::mutex> lock(m_read_requests_mutex);
 
-  m_client.async_read({request.size, [=](tacopie::tcp_client::read_result& result) {
-                         if (!callback) {
-                           return;
-                         }
+  if (!is_connected()) {
+    throw redis_error("cpp_redis::network::tcp_client is disconnected");
+  }
 
-                         read_result converted_result = {result.success, std::move(result.buffer)};
-                         callback(converted_result);
-                       }});
+  m_io_service->set_rd_callback(m_socket, std::bind(&tcp_client::on_read_available, this, std::placeholders::_1));
+  m_read_requests.push(std::move(request));
 }
 
 void
 tcp_client::async_write(write_request& request) {
-  auto callback = std::move(request.async_write_callback);
+  std::lock_guard<std::mutex> lock(m_write_requests_mutex);
+
+  if (!is_connected()) {
+    throw redis_error("cpp_redis::network::tcp_client is disconnected");
+  }
 
-  m_client.async_write({std::move(request.buffer), [=](tacopie::tcp_client::write_result& result) {
-                          if (!callback) {
-                            return;
-                          }
+  m_io_service->set_wr_callback(m_socket, std::bind(&tcp_client::on_write_available, this, std::placeholders::_1));
+  m_write_requests.push(std::move(request));
+}
+
+void
+tcp_client::on_read_available(tacopie::fd_t) {
+  pin_current_thread(m_cpu);
+
+  read_result result = {true, {}};
+  auto callback      = process_read(result);
+
+  if (!result.success) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::network::tcp_client read operation failure");
+    disconnect();
+  }
+
+  if (callback) {
+    callback(result);
+  }
+
+  if (!result.success && m_disconnection_handler) {
+    m_disconnection_handler();
+  }
+}
+
+void
+tcp_client::on_write_available(tacopie::fd_t) {
+  pin_current_thread(m_cpu);
+
+  write_result result = {true, 0};
+  auto callback       = process_write(result);
+
+  if (!result.success) {
+    __CPP_REDIS_LOG(warn, "cpp_redis::network::tcp_client write operation failure");
+    disconnect();
+  }
+
+  if (callback) {
+    callback(result);
+  }
+
+  if (!result.success && m_disconnection_handler) {
+    m_disconnection_handler();
+  }
+}
+
+tcp_client::async_read_callback_t
+tcp_client::process_read(read_result& result) {
+  std::lock_guard<std::mutex> lock(m_read_requests_mutex);
+
+  if (m_read_requests.empty()) {
+    return nullptr;
+  }
+
+  const auto& request = m_read_requests.front();
+  auto callback       = request.async_read_callback;
+
+  try {
+    result.buffer  = m_socket.recv(request.size);
+    result.success = true;
+  }
+  catch (const tacopie::tacopie_error&) {
+    result.success = false;
+  }
+
+  m_read_requests.pop();
+
+  //! stop monitoring reads until the next request
+  if (m_read_requests.empty() && result.success) {
+    m_io_service->set_rd_callback(m_socket, nullptr);
+  }
 
-                          write_result converted_result = {result.success, result.size};
-                          callback(converted_result);
-                        }});
+  return callback;
+}
+
+tcp_client::async_write_callback_t
+tcp_client::process_write(write_result& result) {
+  std::lock_guard<std::mutex> lock(m_write_requests_mutex);
+
+  if (m_write_requests.empty()) {
+    return nullptr;
+  }
+
+  const auto& request = m_write_requests.front();
+  auto callback       = request.async_write_callback;
+
+  try {
+    result.size    = m_socket.send(request.buffer, request.buffer.size());
+    result.success = true;
+  }
+  catch (const tacopie::tacopie_error&) {
+    result.success = false;
+  }
+
+  m_write_requests.pop();
+
+  //! stop monitoring writes until the next request
+  if (m_write_requests.empty() && result.success) {
+    m_io_service->set_wr_callback(m_socket, nullptr);
+  }
+
+  return callback;
+}
+
+void
+tcp_client::clear_read_requests(void) {
+  std::lock_guard<std::mutex> lock(m_read_requests_mutex);
+
+  std::queue<read_request> empty;
+  std::swap(m_read_requests, empty);
+}
+
+void
+tcp_client::clear_write_requests(void) {
+  std::lock_guard<std::mutex> lock(m_write_requests_mutex);
+
+  std::queue<write_request> empty;
+  std::swap(m_write_requests, empty);
 }
 
 void
 tcp_client::set_on_disconnection_handler(const disconnection_handler_t& disconnection_handler) {
-  m_client.set_on_disconnection_handler(disconnection_handler);
+  m_disconnection_handler = disconnection_handler;
 }
 
 void
@@ -86,6 +373,22 @@ set_default_nb_workers(std::size_t nb_threads) {
   tacopie::get_default_io_service()->set_nb_workers(__CPP_REDIS_LENGTH(nb_threads));
 }
 
+void
+set_io_shards(std::size_t nb_shards, const std::vector<int>& cpus) {
+  std::vector<io_shard> shards;
+
+  for (std::size_t i = 0; i < nb_shards; ++i) {
+    auto io_service = std::make_shared<tacopie::io_service>();
+    io_service->set_nb_workers(1);
+    shards.push_back({io_service, cpus.empty() ? -1 : cpus[i % cpus.size()]});
+  }
+
+  std::lock_guard<std::mutex> lock(io_shards_mutex);
+  //! connections already attached to the previous shards keep them alive through their io service pointer
+  io_shards     = std::move(shards);
+  next_io_shard = 0;
+}
+
 } // namespace network
 
 } // namespace cpp_redis
@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/command_traits.hpp>
+#include <gtest/gtest.h>
+
+TEST(CommandTraits, ReadOnlyCommands) {
+  EXPECT_TRUE(cpp_redis::is_read_only_command("GET"));
+  EXPECT_TRUE(cpp_redis::is_read_only_command("get"));
+  EXPECT_TRUE(cpp_redis::is_read_only_command("ZRangeByScore"));
+  EXPECT_TRUE(cpp_redis::is_read_only_command(std::vector<std::string>{"HGETALL", "key"}));
+}
+
+TEST(CommandTraits, WriteCommands) {
+  EXPECT_FALSE(cpp_redis::is_read_only_command("SET"));
+  EXPECT_FALSE(cpp_redis::is_read_only_command("INCR"));
+  EXPECT_FALSE(cpp_redis::is_read_only_command("EVAL"));
+  EXPECT_FALSE(cpp_redis::is_read_only_command(std::vector<std::string>{}));
+}
+
+TEST(CommandTraits, BlockingCommands) {
+  EXPECT_TRUE(cpp_redis::is_blocking_command({"BLPOP", "list", "0"}));
+  EXPECT_TRUE(cpp_redis::is_blocking_command({"brpoplpush", "src", "dst", "30"}));
+  EXPECT_TRUE(cpp_redis::is_blocking_command({"XREAD", "COUNT", "10", "BLOCK", "100", "STREAMS", "stream", "$"}));
+  EXPECT_FALSE(cpp_redis::is_blocking_command({"XREAD", "STREAMS", "block", "0"}));
+  EXPECT_FALSE(cpp_redis::is_blocking_command({"WAIT", "1", "0"}));
+  EXPECT_FALSE(cpp_redis::is_blocking_command({"LPOP", "list"}));
+  EXPECT_FALSE(cpp_redis::is_blocking_command({}));
+}
+
+TEST(CommandTraits, ConnectionStateCommands) {
+  EXPECT_TRUE(cpp_redis::is_connection_state_command({"SELECT", "1"}));
+  EXPECT_TRUE(cpp_redis::is_connection_state_command({"multi"}));
+  EXPECT_TRUE(cpp_redis::is_connection_state_command({"CLIENT", "reply", "OFF"}));
+  EXPECT_FALSE(cpp_redis::is_connection_state_command({"CLIENT", "LIST"}));
+  EXPECT_FALSE(cpp_redis::is_connection_state_command({"GET", "key"}));
+  EXPECT_FALSE(cpp_redis::is_connection_state_command({}));
+}
@@ -0,0 +1,121 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/executor.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+TEST(Executor, InlineExecutorRunsRightAway) {
+  cpp_redis::inline_executor executor;
+  bool ran = false;
+
+  executor.execute([&] { ran = true; });
+
+  EXPECT_TRUE(ran);
+}
+
+TEST(Executor, ThreadPoolExecutorRunsAllTasks) {
+  std::atomic<int> count(0);
+
+  {
+    cpp_redis::thread_pool_executor executor(4);
+
+    for (int i = 0; i < 1000; ++i)
+      executor.execute([&] { ++count; });
+  }
+
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(Executor, SerialExecutorKeepsOrder) {
+  auto pool = std::make_shared<cpp_redis::thread_pool_executor>(4);
+  cpp_redis::serial_executor executor(pool);
+  std::vector<int> order;
+
+  for (int i = 0; i < 1000; ++i)
+    executor.execute([&order, i] { order.push_back(i); });
+
+  executor.wait();
+
+  ASSERT_EQ(order.size(), 1000U);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(order[i], i);
+}
+
+TEST(Executor, SerialExecutorSurvivesThrowingTask) {
+  auto pool = std::make_shared<cpp_redis::thread_pool_executor>(1);
+  cpp_redis::serial_executor executor(pool);
+  bool ran = false;
+
+  executor.execute([] { throw std::runtime_error("failure"); });
+  executor.execute([&] { ran = true; });
+  executor.wait();
+
+  EXPECT_TRUE(ran);
+}
+
+TEST(Executor, TimerExecutorRunsTasksByDeadline) {
+  cpp_redis::timer_executor executor;
+  std::vector<int> order;
+  std::mutex order_mutex;
+  std::promise<void> done;
+
+  executor.execute_after(std::chrono::milliseconds(50), [&] {
+    std::lock_guard<std::mutex> lock(order_mutex);
+    order.push_back(2);
+    done.set_value();
+  });
+  executor.execute_after(std::chrono::milliseconds(10), [&] {
+    std::lock_guard<std::mutex> lock(order_mutex);
+    order.push_back(1);
+  });
+  executor.execute([&] {
+    std::lock_guard<std::mutex> lock(order_mutex);
+    order.push_back(0);
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  done.get_future().wait();
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+  std::lock_guard<std::mutex> lock(order_mutex);
+  ASSERT_EQ(order.size(), 3U);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(order[i], i);
+}
+
+TEST(Executor, TimerExecutorDiscardsPendingTasks) {
+  std::atomic<bool> ran(false);
+
+  {
+    cpp_redis::timer_executor executor;
+    executor.execute_after(std::chrono::seconds(10), [&] { ran = true; });
+  }
+
+  EXPECT_FALSE(ran);
+}
@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/hash_ring.hpp>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+TEST(HashRing, EmptyRing) {
+  cpp_redis::hash_ring ring;
+
+  EXPECT_THROW(ring.get_node("key"), cpp_redis::redis_error);
+}
+
+TEST(HashRing, SingleNode) {
+  cpp_redis::hash_ring ring;
+  ring.add_node("127.0.0.1:6379");
+
+  EXPECT_EQ(ring.get_node("a"), "127.0.0.1:6379");
+  EXPECT_EQ(ring.get_node("b"), "127.0.0.1:6379");
+}
+
+TEST(HashRing, Deterministic) {
+  cpp_redis::hash_ring ring1;
+  cpp_redis::hash_ring ring2;
+
+  ring1.add_node("node1");
+  ring1.add_node("node2");
+  ring1.add_node("node3");
+
+  //! insertion order does not matter
+  ring2.add_node("node3");
+  ring2.add_node("node1");
+  ring2.add_node("node2");
+
+  for (int i = 0; i < 1000; ++i) {
+    std::string key = "key:" + std::to_string(i);
+    EXPECT_EQ(ring1.get_node(key), ring2.get_node(key));
+  }
+}
+
+TEST(HashRing, Distribution) {
+  cpp_redis::hash_ring ring;
+  std::map<std::string, int> counts;
+
+  for (int i = 0; i < 4; ++i)
+    ring.add_node("10.0.0." + std::to_string(i) + ":6379");
+
+  for (int i = 0; i < 100000; ++i)
+    ++counts[ring.get_node("key:" + std::to_string(i))];
+
+  ASSERT_EQ(counts.size(), 4U);
+  for (const auto& count : counts) {
+    EXPECT_GT(count.second, 20000);
+    EXPECT_LT(count.second, 30000);
+  }
+}
+
+TEST(HashRing, AddNodeRemapsOneNth) {
+  cpp_redis::hash_ring ring;
+
+  for (int i = 0; i < 4; ++i)
+    ring.add_node("10.0.0." + std::to_string(i) + ":6379");
+
+  std::map<std::string, std::string> before;
+  for (int i = 0; i < 100000; ++i) {
+    std::string key = "key:" + std::to_string(i);
+    before[key]     = ring.get_node(key);
+  }
+
+  ring.add_node("10.0.0.4:6379");
+
+  int moved = 0;
+  for (const auto& entry : before) {
+    const std::string& node = ring.get_node(entry.first);
+
+    if (node != entry.second) {
+      //! keys only move to the new node
+      EXPECT_EQ(node, "10.0.0.4:6379");
+      ++moved;
+    }
+  }
+
+  //! about 1/5 of the keys
+  EXPECT_GT(moved, 15000);
+  EXPECT_LT(moved, 25000);
+}
+
+TEST(HashRing, RemoveNode) {
+  cpp_redis::hash_ring ring;
+
+  ring.add_node("node1");
+  ring.add_node("node2");
+  ring.add_node("node3");
+
+  std::map<std::string, std::string> before;
+  for (int i = 0; i < 10000; ++i) {
+    std::string key = "key:" + std::to_string(i);
+    before[key]     = ring.get_node(key);
+  }
+
+  ring.remove_node("node2");
+
+  for (const auto& entry : before) {
+    //! only the keys of the removed node move
+    if (entry.second != "node2")
+      EXPECT_EQ(ring.get_node(entry.first), entry.second);
+    else
+      EXPECT_NE(ring.get_node(entry.first), "node2");
+  }
+}
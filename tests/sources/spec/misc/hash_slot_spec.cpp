@@ -0,0 +1,48 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/hash_slot.hpp>
+#include <gtest/gtest.h>
+
+TEST(HashSlot, Crc16) {
+  //! reference value from the redis cluster specification
+  EXPECT_EQ(cpp_redis::crc16("123456789", 9), 0x31c3);
+}
+
+TEST(HashSlot, Key) {
+  EXPECT_EQ(cpp_redis::hash_slot(""), 0);
+  EXPECT_EQ(cpp_redis::hash_slot("foo"), 12182);
+  EXPECT_EQ(cpp_redis::hash_slot("bar"), 5061);
+  EXPECT_EQ(cpp_redis::hash_slot("hello"), 866);
+}
+
+TEST(HashSlot, HashTag) {
+  EXPECT_EQ(cpp_redis::hash_slot("{user1000}.following"), cpp_redis::hash_slot("user1000"));
+  EXPECT_EQ(cpp_redis::hash_slot("{user1000}.followers"), cpp_redis::hash_slot("{user1000}.following"));
+  EXPECT_EQ(cpp_redis::hash_slot("foo{bar}{zap}"), cpp_redis::hash_slot("bar"));
+}
+
+TEST(HashSlot, EmptyOrUnterminatedHashTag) {
+  EXPECT_EQ(cpp_redis::hash_slot("foo{}{bar}"), cpp_redis::crc16("foo{}{bar}", 10) & 16383);
+  EXPECT_EQ(cpp_redis::hash_slot("{}"), cpp_redis::crc16("{}", 2) & 16383);
+  EXPECT_EQ(cpp_redis::hash_slot("foo{bar"), cpp_redis::crc16("foo{bar", 7) & 16383);
+}
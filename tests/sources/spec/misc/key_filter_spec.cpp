@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string>
+
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/key_filter.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(KeyFilter, NotReadyUntilPopulated) {
+  cpp_redis::key_filter filter(4096);
+
+  EXPECT_FALSE(filter.is_ready());
+  EXPECT_TRUE(filter.may_exist("missing"));
+
+  filter.set_ready(true);
+  EXPECT_FALSE(filter.may_exist("missing"));
+
+  filter.clear();
+  EXPECT_TRUE(filter.may_exist("missing"));
+}
+
+TEST(KeyFilter, NoFalseNegatives) {
+  cpp_redis::key_filter filter(64 * 1024, 0.01);
+  filter.set_ready(true);
+
+  auto stats = filter.get_stats();
+  EXPECT_EQ(stats.bytes, 64U * 1024U);
+
+  for (std::size_t i = 0; i < stats.capacity; ++i) {
+    filter.add("key:" + std::to_string(i));
+  }
+
+  for (std::size_t i = 0; i < stats.capacity; ++i) {
+    EXPECT_TRUE(filter.may_exist("key:" + std::to_string(i)));
+  }
+}
+
+TEST(KeyFilter, FalsePositiveRate) {
+  cpp_redis::key_filter filter(64 * 1024, 0.01);
+  filter.set_ready(true);
+
+  std::size_t capacity = filter.get_stats().capacity;
+
+  for (std::size_t i = 0; i < capacity; ++i) {
+    filter.add("key:" + std::to_string(i));
+  }
+
+  std::size_t false_positives = 0;
+  for (std::size_t i = 0; i < 100000; ++i) {
+    false_positives += filter.may_exist("other:" + std::to_string(i));
+  }
+
+  //! the capacity accounts for the uneven load of the blocks: 1% target, plus some slack
+  EXPECT_LT(false_positives, 1300U);
+}
+
+TEST(KeyFilter, InvalidRate) {
+  EXPECT_THROW(cpp_redis::key_filter filter(4096, 0), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::key_filter filter(4096, 1), cpp_redis::redis_error);
+}
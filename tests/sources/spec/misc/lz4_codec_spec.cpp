@@ -0,0 +1,85 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdlib>
+#include <string>
+
+#include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/lz4_codec.hpp>
+
+#include <gtest/gtest.h>
+
+static std::string
+round_trip(const std::string& value) {
+  cpp_redis::lz4_codec codec;
+  std::string compressed;
+  std::string decompressed;
+
+  codec.compress(value, compressed);
+  codec.decompress(compressed.data(), compressed.size(), decompressed);
+
+  return decompressed;
+}
+
+TEST(Lz4Codec, RoundTrip) {
+  std::string json;
+  for (int i = 0; i < 1000; ++i) {
+    json += "{\"id\":" + std::to_string(i) + ",\"name\":\"user" + std::to_string(i) + "\",\"active\":true},";
+  }
+
+  std::string random;
+  std::srand(42);
+  for (int i = 0; i < 100000; ++i) {
+    random.push_back(static_cast<char>(std::rand()));
+  }
+
+  EXPECT_EQ(round_trip(""), "");
+  EXPECT_EQ(round_trip("a"), "a");
+  EXPECT_EQ(round_trip("hello hello hello"), "hello hello hello");
+  EXPECT_EQ(round_trip(std::string(100000, 'x')), std::string(100000, 'x'));
+  EXPECT_EQ(round_trip(json), json);
+  EXPECT_EQ(round_trip(random), random);
+  EXPECT_EQ(round_trip(json + random + json), json + random + json);
+}
+
+TEST(Lz4Codec, CompressesRepetitiveData) {
+  cpp_redis::lz4_codec codec;
+  std::string compressed;
+
+  codec.compress(std::string(100000, 'x'), compressed);
+  EXPECT_LT(compressed.size(), 1000U);
+}
+
+TEST(Lz4Codec, CorruptedData) {
+  cpp_redis::lz4_codec codec;
+  std::string compressed;
+  std::string decompressed;
+
+  codec.compress(std::string(1000, 'x') + "tail", compressed);
+
+  //! truncated
+  EXPECT_THROW(codec.decompress(compressed.data(), compressed.size() - 1, decompressed), cpp_redis::redis_error);
+
+  //! size larger than the data can hold
+  std::string wrong_size = "\xff\xff\xff\xff\x0f" + compressed.substr(2);
+  EXPECT_THROW(codec.decompress(wrong_size.data(), wrong_size.size(), decompressed), cpp_redis::redis_error);
+}
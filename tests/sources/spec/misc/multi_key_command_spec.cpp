@@ -0,0 +1,157 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string>
+#include <vector>
+
+#include <cpp_redis/misc/multi_key_command.hpp>
+#include <gtest/gtest.h>
+
+//!
+//! fake node function: keys starting with 'a' go to node 0, the others to node 1
+//!
+static std::size_t
+first_letter_node(const std::string& key) {
+  return key[0] == 'a' ? 0 : 1;
+}
+
+static cpp_redis::reply
+bulk(const std::string& value) {
+  return {value, cpp_redis::reply::string_type::bulk_string};
+}
+
+TEST(MultiKeyCommand, SplitByGroup) {
+  auto parts = cpp_redis::split_multi_key_command({"MGET", "a1", "b1", "a2", "b2", "b3"}, first_letter_node);
+
+  ASSERT_EQ(parts.size(), 2U);
+  EXPECT_EQ(parts[0].command, std::vector<std::string>({"MGET", "a1", "a2"}));
+  EXPECT_EQ(parts[0].indexes, std::vector<std::size_t>({0, 2}));
+  EXPECT_EQ(parts[1].command, std::vector<std::string>({"MGET", "b1", "b2", "b3"}));
+  EXPECT_EQ(parts[1].indexes, std::vector<std::size_t>({1, 3, 4}));
+}
+
+TEST(MultiKeyCommand, SplitMsetKeepsPairs) {
+  auto parts = cpp_redis::split_multi_key_command({"mset", "a1", "v1", "b1", "v2", "a2", "v3"}, first_letter_node);
+
+  ASSERT_EQ(parts.size(), 2U);
+  EXPECT_EQ(parts[0].command, std::vector<std::string>({"mset", "a1", "v1", "a2", "v3"}));
+  EXPECT_EQ(parts[1].command, std::vector<std::string>({"mset", "b1", "v2"}));
+}
+
+TEST(MultiKeyCommand, SplitUnsupportedCommands) {
+  EXPECT_TRUE(cpp_redis::split_multi_key_command({"GET", "a1"}, first_letter_node).empty());
+  EXPECT_TRUE(cpp_redis::split_multi_key_command({"MGET"}, first_letter_node).empty());
+  //! MSET without the value of its last key
+  EXPECT_TRUE(cpp_redis::split_multi_key_command({"MSET", "a1", "v1", "b1"}, first_letter_node).empty());
+}
+
+TEST(MultiKeyCommand, MergeMgetOutOfOrder) {
+  std::vector<std::string> redis_cmd = {"MGET", "a1", "b1", "a2", "b2"};
+  auto parts                         = cpp_redis::split_multi_key_command(redis_cmd, first_letter_node);
+
+  cpp_redis::reply merged;
+  int nb_calls = 0;
+  cpp_redis::multi_key_reply_merger merger(redis_cmd, parts.size(), [&](cpp_redis::reply& r) {
+    merged = r;
+    ++nb_calls;
+  });
+
+  cpp_redis::reply part_1({bulk("vb1"), cpp_redis::reply()});
+  cpp_redis::reply part_0({bulk("va1"), bulk("va2")});
+
+  merger.add_reply(parts[1], part_1);
+  EXPECT_EQ(nb_calls, 0);
+  merger.add_reply(parts[0], part_0);
+  ASSERT_EQ(nb_calls, 1);
+
+  ASSERT_TRUE(merged.is_array());
+  ASSERT_EQ(merged.as_array().size(), 4U);
+  EXPECT_EQ(merged.as_array()[0].as_string(), "va1");
+  EXPECT_EQ(merged.as_array()[1].as_string(), "vb1");
+  EXPECT_EQ(merged.as_array()[2].as_string(), "va2");
+  EXPECT_TRUE(merged.as_array()[3].is_null());
+}
+
+TEST(MultiKeyCommand, MergeCountsAreSummed) {
+  for (const char* name : {"DEL", "EXISTS", "TOUCH", "UNLINK"}) {
+    std::vector<std::string> redis_cmd = {name, "a1", "b1", "b2"};
+    auto parts                         = cpp_redis::split_multi_key_command(redis_cmd, first_letter_node);
+
+    cpp_redis::reply merged;
+    cpp_redis::multi_key_reply_merger merger(redis_cmd, parts.size(), [&](cpp_redis::reply& r) { merged = r; });
+
+    cpp_redis::reply part_1(int64_t(2));
+    cpp_redis::reply part_0(int64_t(1));
+    merger.add_reply(parts[1], part_1);
+    merger.add_reply(parts[0], part_0);
+
+    ASSERT_TRUE(merged.is_integer()) << name;
+    EXPECT_EQ(merged.as_integer(), 3) << name;
+  }
+}
+
+TEST(MultiKeyCommand, MergeMset) {
+  std::vector<std::string> redis_cmd = {"MSET", "a1", "v1", "b1", "v2"};
+  auto parts                         = cpp_redis::split_multi_key_command(redis_cmd, first_letter_node);
+
+  cpp_redis::reply merged;
+  cpp_redis::multi_key_reply_merger merger(redis_cmd, parts.size(), [&](cpp_redis::reply& r) { merged = r; });
+
+  cpp_redis::reply ok("OK", cpp_redis::reply::string_type::simple_string);
+  merger.add_reply(parts[0], ok);
+  merger.add_reply(parts[1], ok);
+
+  ASSERT_TRUE(merged.is_simple_string());
+  EXPECT_EQ(merged.as_string(), "OK");
+}
+
+TEST(MultiKeyCommand, MergeKeepsFirstError) {
+  std::vector<std::string> redis_cmd = {"MGET", "a1", "b1"};
+  auto parts                         = cpp_redis::split_multi_key_command(redis_cmd, first_letter_node);
+
+  cpp_redis::reply merged;
+  cpp_redis::multi_key_reply_merger merger(redis_cmd, parts.size(), [&](cpp_redis::reply& r) { merged = r; });
+
+  cpp_redis::reply first_error("ERR first", cpp_redis::reply::string_type::error);
+  cpp_redis::reply second_error("ERR second", cpp_redis::reply::string_type::error);
+  merger.add_reply(parts[1], first_error);
+  merger.add_reply(parts[0], second_error);
+
+  ASSERT_TRUE(merged.is_error());
+  EXPECT_EQ(merged.error(), "ERR first");
+}
+
+TEST(MultiKeyCommand, MergeErrorAndSuccess) {
+  std::vector<std::string> redis_cmd = {"DEL", "a1", "b1"};
+  auto parts                         = cpp_redis::split_multi_key_command(redis_cmd, first_letter_node);
+
+  cpp_redis::reply merged;
+  cpp_redis::multi_key_reply_merger merger(redis_cmd, parts.size(), [&](cpp_redis::reply& r) { merged = r; });
+
+  cpp_redis::reply count(int64_t(1));
+  cpp_redis::reply error("ERR node failure", cpp_redis::reply::string_type::error);
+  merger.add_reply(parts[0], count);
+  merger.add_reply(parts[1], error);
+
+  ASSERT_TRUE(merged.is_error());
+  EXPECT_EQ(merged.error(), "ERR node failure");
+}
@@ -0,0 +1,161 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <cpp_redis/misc/near_cache.hpp>
+
+#include <gtest/gtest.h>
+
+static cpp_redis::reply
+bulk(const std::string& value) {
+  return {value, cpp_redis::reply::string_type::bulk_string};
+}
+
+TEST(NearCache, MissThenHit) {
+  cpp_redis::near_cache cache(1024 * 1024, std::chrono::seconds(60));
+  cpp_redis::reply value;
+  std::uint64_t ticket;
+
+  EXPECT_FALSE(cache.lookup("key", "GET", value, ticket));
+  cache.fill("key", "GET", ticket, bulk("value"));
+
+  EXPECT_TRUE(cache.lookup("key", "GET", value, ticket));
+  EXPECT_EQ(value.as_string(), "value");
+
+  //! other reads of the same key are cached separately
+  EXPECT_FALSE(cache.lookup("key", "HGET field", value, ticket));
+
+  auto stats = cache.get_stats();
+  EXPECT_EQ(stats.hits, 1U);
+  EXPECT_EQ(stats.misses, 2U);
+  EXPECT_EQ(stats.keys, 1U);
+}
+
+TEST(NearCache, ErrorsNotCached) {
+  cpp_redis::near_cache cache(1024 * 1024, std::chrono::seconds(60));
+  cpp_redis::reply value;
+  std::uint64_t ticket;
+
+  cache.lookup("key", "GET", value, ticket);
+  cache.fill("key", "GET", ticket, {"WRONGTYPE", cpp_redis::reply::string_type::error});
+
+  EXPECT_FALSE(cache.lookup("key", "GET", value, ticket));
+}
+
+TEST(NearCache, InvalidationDuringReadDropsReply) {
+  cpp_redis::near_cache cache(1024 * 1024, std::chrono::seconds(60));
+  cpp_redis::reply value;
+  std::uint64_t ticket;
+
+  cache.lookup("key", "GET", value, ticket);
+  cache.invalidate("key");
+  cache.fill("key", "GET", ticket, bulk("stale"));
+
+  EXPECT_FALSE(cache.lookup("key", "GET", value, ticket));
+  EXPECT_EQ(cache.get_stats().invalidations, 1U);
+}
+
+TEST(NearCache, OnlyLatestReadFills) {
+  cpp_redis::near_cache cache(1024 * 1024, std::chrono::seconds(60));
+  cpp_redis::reply value;
+  std::uint64_t first_ticket;
+  std::uint64_t second_ticket;
+
+  cache.lookup("key", "GET", value, first_ticket);
+  cache.lookup("key", "GET", value, second_ticket);
+  cache.fill("key", "GET", first_ticket, bulk("old"));
+  cache.fill("key", "GET", second_ticket, bulk("new"));
+
+  EXPECT_TRUE(cache.lookup("key", "GET", value, first_ticket));
+  EXPECT_EQ(value.as_string(), "new");
+}
+
+TEST(NearCache, Expiration) {
+  cpp_redis::near_cache cache(1024 * 1024, std::chrono::seconds(60), 4, [](const std::string& key) {
+    return key == "short" ? std::chrono::milliseconds(10) : std::chrono::milliseconds(60000);
+  });
+  cpp_redis::reply value;
+  std::uint64_t ticket;
+
+  cache.lookup("short", "GET", value, ticket);
+  cache.fill("short", "GET", ticket, bulk("value"));
+  cache.lookup("long", "GET", value, ticket);
+  cache.fill("long", "GET", ticket, bulk("value"));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  EXPECT_FALSE(cache.lookup("short", "GET", value, ticket));
+  EXPECT_TRUE(cache.lookup("long", "GET", value, ticket));
+  EXPECT_EQ(cache.get_stats().expirations, 1U);
+}
+
+TEST(NearCache, MemoryBound) {
+  cpp_redis::near_cache cache(64 * 1024, std::chrono::seconds(60), 4);
+  cpp_redis::reply value;
+  std::uint64_t ticket;
+
+  for (int i = 0; i < 10000; ++i) {
+    std::string key = "key" + std::to_string(i);
+
+    cache.lookup(key, "GET", value, ticket);
+    cache.fill(key, "GET", ticket, bulk(std::string(100, 'x')));
+  }
+
+  auto stats = cache.get_stats();
+  EXPECT_LE(stats.bytes, 64U * 1024U);
+  EXPECT_GT(stats.evictions, 0U);
+  EXPECT_GT(stats.keys, 0U);
+}
+
+TEST(NearCache, ManyKeysAndClear) {
+  cpp_redis::near_cache cache(64 * 1024 * 1024, std::chrono::seconds(60), 2);
+  cpp_redis::reply value;
+  std::uint64_t ticket;
+
+  for (int i = 0; i < 5000; ++i) {
+    std::string key = "key" + std::to_string(i);
+
+    cache.lookup(key, "GET", value, ticket);
+    cache.fill(key, "GET", ticket, bulk(key));
+  }
+
+  //! deleted slots must not break the probe sequences of the remaining keys
+  for (int i = 0; i < 5000; i += 2) {
+    cache.invalidate("key" + std::to_string(i));
+  }
+
+  for (int i = 1; i < 5000; i += 2) {
+    std::string key = "key" + std::to_string(i);
+
+    ASSERT_TRUE(cache.lookup(key, "GET", value, ticket));
+    EXPECT_EQ(value.as_string(), key);
+  }
+
+  EXPECT_EQ(cache.get_stats().keys, 2500U);
+
+  cache.clear();
+  EXPECT_EQ(cache.get_stats().keys, 0U);
+  EXPECT_EQ(cache.get_stats().bytes, 0U);
+}
@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cpp_redis/misc/replica_routing.hpp>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+TEST(LatencyEwma, FirstSampleTakenAsIs) {
+  cpp_redis::latency_ewma ewma(0.5);
+
+  EXPECT_EQ(ewma.get(), 0);
+  ewma.add_sample(100);
+  EXPECT_EQ(ewma.get(), 100);
+  ewma.add_sample(300);
+  EXPECT_EQ(ewma.get(), 200);
+}
+
+TEST(LatencyEwma, SeedIgnoredOnceMeasured) {
+  cpp_redis::latency_ewma ewma;
+
+  ewma.seed(std::chrono::microseconds(500));
+  EXPECT_EQ(ewma.get(), 500);
+
+  //! a seed never overrides an estimate
+  ewma.seed(std::chrono::microseconds(10));
+  EXPECT_EQ(ewma.get(), 500);
+}
+
+TEST(LatencyEwma, InvalidWeightIgnored) {
+  cpp_redis::latency_ewma ewma(0.5);
+
+  ewma.set_weight(0);
+  ewma.set_weight(2);
+  ewma.add_sample(100);
+  ewma.add_sample(300);
+  EXPECT_EQ(ewma.get(), 200);
+}
+
+TEST(ReplicaRouting, FastestReplicaPicked) {
+  cpp_redis::latency_ewma fast;
+  cpp_redis::latency_ewma slow;
+
+  fast.seed(std::chrono::microseconds(1000));
+  slow.seed(std::chrono::microseconds(1000));
+
+  for (int i = 0; i < 20; ++i) {
+    fast.add_sample(100);
+    slow.add_sample(2000);
+  }
+
+  std::vector<double> scores = {cpp_redis::routing_score(slow.get(), 0), cpp_redis::routing_score(fast.get(), 0)};
+
+  for (std::size_t decision = 0; decision < 10; ++decision) {
+    EXPECT_EQ(cpp_redis::select_by_routing_score(scores, decision, 0), 1U);
+  }
+}
+
+TEST(ReplicaRouting, CommandsInFlightWeighTheScore) {
+  //! a node twice as fast but with 3 commands in flight loses against an idle one
+  std::vector<double> scores = {cpp_redis::routing_score(100, 3), cpp_redis::routing_score(200, 0)};
+
+  EXPECT_EQ(cpp_redis::select_by_routing_score(scores, 1, 0), 1U);
+
+  scores = {cpp_redis::routing_score(100, 0), cpp_redis::routing_score(200, 0)};
+  EXPECT_EQ(cpp_redis::select_by_routing_score(scores, 1, 0), 0U);
+}
+
+TEST(ReplicaRouting, TiesAreSpread) {
+  std::vector<double> scores = {100, 100, 100};
+  std::vector<std::size_t> counts(scores.size(), 0);
+
+  for (std::size_t decision = 0; decision < 30; ++decision) {
+    ++counts[cpp_redis::select_by_routing_score(scores, decision, 0)];
+  }
+
+  EXPECT_EQ(counts, std::vector<std::size_t>({10, 10, 10}));
+}
+
+TEST(ReplicaRouting, ProbesReachSlowReplica) {
+  std::vector<double> scores = {100, 5000};
+  std::size_t nb_slow        = 0;
+
+  for (std::size_t decision = 0; decision < 100; ++decision) {
+    nb_slow += cpp_redis::select_by_routing_score(scores, decision, 0.1) == 1;
+  }
+
+  //! 10 probes alternating between the 2 replicas
+  EXPECT_EQ(nb_slow, 5U);
+}
+
+TEST(ReplicaRouting, RecoveredReplicaWinsBack) {
+  cpp_redis::latency_ewma a;
+  cpp_redis::latency_ewma b;
+
+  a.add_sample(100);
+  b.add_sample(5000);
+  EXPECT_EQ(cpp_redis::select_by_routing_score({a.get(), b.get()}, 1, 0), 0U);
+
+  //! b recovers while a slows down
+  for (int i = 0; i < 50; ++i) {
+    a.add_sample(3000);
+    b.add_sample(50);
+  }
+
+  EXPECT_EQ(cpp_redis::select_by_routing_score({a.get(), b.get()}, 1, 0), 1U);
+}
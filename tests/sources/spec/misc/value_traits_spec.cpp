@@ -0,0 +1,133 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/misc/value_traits.hpp>
+
+#include <gtest/gtest.h>
+
+struct point {
+  int x;
+  int y;
+};
+
+namespace cpp_redis {
+
+template <>
+struct to_redis<point> {
+  static std::string
+  convert(const point& p) {
+    return to_redis_string(p.x) + "," + to_redis_string(p.y);
+  }
+};
+
+template <>
+struct from_redis<point> {
+  static point
+  convert(const reply& r) {
+    const std::string& value = from_redis<std::string>::convert(r);
+    std::size_t comma        = value.find(',');
+    int64_t x;
+    int64_t y;
+
+    if (comma == std::string::npos || !parse_number(value.data(), value.data() + comma, x) || !parse_number(value.data() + comma + 1, value.data() + value.size(), y)) {
+      throw redis_error("invalid point");
+    }
+
+    return {static_cast<int>(x), static_cast<int>(y)};
+  }
+};
+
+} // namespace cpp_redis
+
+static cpp_redis::reply
+bulk(const std::string& value) {
+  return {value, cpp_redis::reply::string_type::bulk_string};
+}
+
+TEST(ValueTraits, FormatsShortestRoundTrip) {
+  EXPECT_EQ(cpp_redis::to_redis_string(0.1), "0.1");
+  EXPECT_EQ(cpp_redis::to_redis_string(0.1f), "0.1");
+  EXPECT_EQ(cpp_redis::to_redis_string(1.5), "1.5");
+  EXPECT_EQ(cpp_redis::to_redis_string(100.0), "100");
+  EXPECT_EQ(cpp_redis::to_redis_string(1e300), "1e+300");
+  EXPECT_EQ(cpp_redis::to_redis_string(-std::numeric_limits<double>::infinity()), "-inf");
+
+  for (double value : {1.0 / 3, 0.1 + 0.2, 123456.789e-200, std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min()}) {
+    std::string formatted = cpp_redis::to_redis_string(value);
+    EXPECT_EQ(cpp_redis::from_redis_reply<double>(bulk(formatted)), value) << formatted;
+    EXPECT_LE(formatted.size(), 24U);
+  }
+
+  EXPECT_EQ(cpp_redis::to_redis_string(0.1 + 0.2), "0.30000000000000004");
+}
+
+TEST(ValueTraits, FormatsIntegers) {
+  EXPECT_EQ(cpp_redis::to_redis_string(0), "0");
+  EXPECT_EQ(cpp_redis::to_redis_string(-42), "-42");
+  EXPECT_EQ(cpp_redis::to_redis_string(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+  EXPECT_EQ(cpp_redis::to_redis_string(std::numeric_limits<uint64_t>::max()), "18446744073709551615");
+  EXPECT_EQ(cpp_redis::to_redis_string(true), "1");
+  EXPECT_EQ(cpp_redis::to_redis_string("literal"), "literal");
+}
+
+TEST(ValueTraits, ParsesReplies) {
+  EXPECT_EQ(cpp_redis::from_redis_reply<int>(cpp_redis::reply(int64_t(-7))), -7);
+  EXPECT_EQ(cpp_redis::from_redis_reply<int64_t>(bulk("-9223372036854775808")), std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(cpp_redis::from_redis_reply<uint64_t>(bulk("18446744073709551615")), std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(cpp_redis::from_redis_reply<double>(bulk("3.5")), 3.5);
+  EXPECT_EQ(cpp_redis::from_redis_reply<double>(cpp_redis::reply(int64_t(3))), 3.0);
+  EXPECT_EQ(cpp_redis::from_redis_reply<std::string>(cpp_redis::reply(int64_t(12))), "12");
+  EXPECT_TRUE(cpp_redis::from_redis_reply<bool>(cpp_redis::reply(int64_t(1))));
+
+  std::vector<int> values = cpp_redis::from_redis_reply<std::vector<int>>(cpp_redis::reply(std::vector<cpp_redis::reply>{bulk("1"), bulk("2")}));
+  EXPECT_EQ(values, std::vector<int>({1, 2}));
+}
+
+TEST(ValueTraits, RejectsInvalidReplies) {
+  EXPECT_THROW(cpp_redis::from_redis_reply<int>(bulk("12a")), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<int>(bulk("")), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<int>(bulk("4294967296")), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<unsigned int>(cpp_redis::reply(int64_t(-1))), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<int64_t>(bulk("9223372036854775808")), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<double>(bulk(" 1.5")), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<double>(bulk("0x10")), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<double>(cpp_redis::reply()), cpp_redis::redis_error);
+  EXPECT_THROW(cpp_redis::from_redis_reply<std::string>(cpp_redis::reply("ERR wrong type", cpp_redis::reply::string_type::error)), cpp_redis::redis_error);
+}
+
+TEST(ValueTraits, UserDefinedTypes) {
+  point p = {3, -4};
+
+  std::vector<std::string> redis_cmd = cpp_redis::make_command("SET", "key", p);
+  EXPECT_EQ(redis_cmd, std::vector<std::string>({"SET", "key", "3,-4"}));
+
+  point parsed = cpp_redis::from_redis_reply<point>(bulk(redis_cmd[2]));
+  EXPECT_EQ(parsed.x, 3);
+  EXPECT_EQ(parsed.y, -4);
+
+  EXPECT_EQ(cpp_redis::make_command("ZADD", "key", 2.5, "member"), std::vector<std::string>({"ZADD", "key", "2.5", "member"}));
+}
@@ -0,0 +1,116 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <cpp_redis/core/client_pool.hpp>
+#include <cpp_redis/misc/error.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(RedisClientPool, NoConnection) {
+  EXPECT_THROW(cpp_redis::client_pool pool(0), cpp_redis::redis_error);
+}
+
+TEST(RedisClientPool, ValidConnection) {
+  cpp_redis::client_pool pool(4);
+
+  EXPECT_FALSE(pool.is_connected());
+  EXPECT_NO_THROW(pool.connect());
+  EXPECT_TRUE(pool.is_connected());
+  EXPECT_EQ(pool.size(), 4U);
+}
+
+TEST(RedisClientPool, CommitNotConnected) {
+  cpp_redis::client_pool pool(2);
+
+  pool.send({"PING"}, nullptr);
+  EXPECT_THROW(pool.commit(), cpp_redis::redis_error);
+}
+
+TEST(RedisClientPool, SendRoundRobin) {
+  cpp_redis::client_pool pool(4, cpp_redis::client_pool::routing_policy::round_robin);
+  std::atomic<int> nb_replies(0);
+
+  pool.connect();
+  for (int i = 0; i < 100; ++i) {
+    pool.send({"PING"}, [&](cpp_redis::reply& reply) {
+      EXPECT_TRUE(reply.is_string());
+      EXPECT_TRUE(reply.as_string() == "PONG");
+      ++nb_replies;
+    });
+  }
+  pool.sync_commit();
+
+  EXPECT_EQ(nb_replies, 100);
+}
+
+TEST(RedisClientPool, SendLeastInflight) {
+  cpp_redis::client_pool pool(4, cpp_redis::client_pool::routing_policy::least_inflight);
+  std::atomic<int> nb_replies(0);
+
+  pool.connect();
+  for (int i = 0; i < 100; ++i) {
+    pool.send({"PING"}, [&](cpp_redis::reply&) { ++nb_replies; });
+  }
+  pool.sync_commit();
+
+  EXPECT_EQ(nb_replies, 100);
+}
+
+TEST(RedisClientPool, FutureSend) {
+  cpp_redis::client_pool pool(2);
+
+  pool.connect();
+  auto set = pool.get_client().set("HELLO", "RedisClientPool");
+  pool.sync_commit();
+
+  auto get = pool.send({"GET", "HELLO"});
+  pool.commit();
+
+  EXPECT_TRUE(set.get().as_string() == "OK");
+  EXPECT_TRUE(get.get().as_string() == "RedisClientPool");
+}
+
+TEST(RedisClientPool, HedgedReadsReplyOnce) {
+  cpp_redis::client_pool pool(4);
+  std::atomic<int> nb_replies(0);
+
+  //! a tiny hedge delay so that hedges are actually sent
+  pool.set_hedging(50, std::chrono::microseconds(1));
+  pool.connect();
+
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      pool.send({"GET", "cpp_redis_hedged_read"}, [&](cpp_redis::reply&) { ++nb_replies; });
+    }
+    pool.sync_commit();
+  }
+
+  //! let any loser reply come back
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  pool.sync_commit();
+
+  EXPECT_EQ(nb_replies, 1000);
+}
@@ -20,10 +20,19 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <cpp_redis/core/client.hpp>
 #include <cpp_redis/misc/error.hpp>
+#include <cpp_redis/misc/lz4_codec.hpp>
+#include <cpp_redis/network/tcp_client.hpp>
 
 #include <gtest/gtest.h>
 
@@ -258,6 +267,70 @@ TEST(RedisClient, MultipleSendPipeline) {
   client.sync_commit();
 }
 
+TEST(RedisClient, ThrowingCallbackDoesNotBlockSyncCommit) {
+  for (bool use_executor : {false, true}) {
+    cpp_redis::client client;
+
+    if (use_executor) {
+      client.set_executor(std::make_shared<cpp_redis::thread_pool_executor>(2));
+    }
+
+    client.connect();
+
+    bool next_callback_called = false;
+    client.send({"PING"}, [](cpp_redis::reply&) { throw std::runtime_error("callback failure"); });
+    client.send({"PING"}, [&](cpp_redis::reply&) { next_callback_called = true; });
+    client.sync_commit();
+
+    EXPECT_TRUE(next_callback_called);
+  }
+}
+
+TEST(RedisClient, IoShardsLeaveDefaultIoServiceUntouched) {
+  std::shared_ptr<tacopie::io_service> default_io_service = tacopie::get_default_io_service();
+  cpp_redis::network::set_io_shards(2);
+
+  {
+    std::vector<std::unique_ptr<cpp_redis::client>> clients;
+
+    for (int i = 0; i < 4; ++i) {
+      clients.push_back(std::unique_ptr<cpp_redis::client>(new cpp_redis::client));
+      EXPECT_EQ(tacopie::get_default_io_service(), default_io_service);
+    }
+
+    for (auto& client : clients) {
+      client->connect();
+      std::future<cpp_redis::reply> ping = client->ping();
+      client->sync_commit();
+      EXPECT_EQ(ping.get().as_string(), "PONG");
+    }
+  }
+
+  cpp_redis::network::set_io_shards(0);
+}
+
+TEST(RedisClient, PendingCommandsFailedBeforeDestruction) {
+  std::atomic<int> nb_failures = ATOMIC_VAR_INIT(0);
+
+  {
+    cpp_redis::client client;
+    client.connect();
+
+    for (int i = 0; i < 10; ++i) {
+      client.send({"PING"}, [&](cpp_redis::reply& reply) {
+        if (reply.is_error()) {
+          ++nb_failures;
+        }
+      });
+    }
+
+    //! the failure callbacks run on the failure thread of the client, joined by the dtor
+    client.disconnect(true);
+  }
+
+  EXPECT_EQ(nb_failures, 10);
+}
+
 TEST(RedisClient, DisconnectionHandlerWithQuit) {
   cpp_redis::client client;
   std::condition_variable cv;
@@ -344,3 +417,328 @@ TEST(RedisClient, ClearBufferOnUserDisconnect) {
   });
   client.sync_commit();
 }
+
+TEST(RedisClient, BlockingCommandsDoNotBlockPipeline) {
+  cpp_redis::client client;
+
+  client.set_blocking_connections(1);
+  client.connect();
+  client.del({"cpp_redis_blocking_lane"});
+  client.sync_commit();
+
+  std::future<cpp_redis::reply> blpop = client.blpop({"cpp_redis_blocking_lane"}, 2);
+  std::future<cpp_redis::reply> ping  = client.ping();
+  client.commit();
+
+  //! the PING does not wait for the BLPOP timeout
+  EXPECT_EQ(ping.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+  client.rpush("cpp_redis_blocking_lane", {"value"});
+  client.sync_commit();
+
+  cpp_redis::reply reply = blpop.get();
+  ASSERT_TRUE(reply.is_array());
+  EXPECT_EQ(reply.as_array()[1].as_string(), "value");
+}
+
+TEST(RedisClient, KeyFilterAnswersMissingKeys) {
+  cpp_redis::client client;
+  auto filter = std::make_shared<cpp_redis::key_filter>(4096);
+
+  client.set_key_filter(filter);
+
+  //! not populated yet: every key may exist
+  client.get("cpp_redis_key_filter", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 1U);
+
+  filter->set_ready(true);
+
+  bool replied = false;
+  client.get("cpp_redis_key_filter", [&](cpp_redis::reply& reply) {
+    replied = true;
+    EXPECT_TRUE(reply.is_null());
+  });
+  EXPECT_TRUE(replied);
+  EXPECT_EQ(client.get_pending_commands_count(), 1U);
+
+  //! keys written through the client may exist
+  client.set("cpp_redis_key_filter", "value", nullptr);
+  client.get("cpp_redis_key_filter", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 3U);
+
+  //! another database
+  client.select(1, nullptr);
+  EXPECT_FALSE(filter->is_ready());
+}
+
+TEST(RedisClient, KeyFilterBootstrap) {
+  cpp_redis::client client;
+  auto filter = std::make_shared<cpp_redis::key_filter>(64 * 1024);
+
+  client.connect();
+  client.set("cpp_redis_key_filter", "value");
+  client.sync_commit();
+
+  client.set_key_filter(filter);
+  client.bootstrap_key_filter();
+
+  EXPECT_TRUE(filter->is_ready());
+  EXPECT_TRUE(filter->may_exist("cpp_redis_key_filter"));
+
+  std::future<cpp_redis::reply> get = client.get("cpp_redis_key_filter");
+  client.sync_commit();
+  EXPECT_EQ(get.get().as_string(), "value");
+}
+
+TEST(RedisClient, CodecCompressesLargeValues) {
+  cpp_redis::client client;
+  cpp_redis::client plain_client;
+  auto codec = std::make_shared<cpp_redis::lz4_codec>();
+
+  client.set_codec(codec, 1024);
+  client.connect();
+  plain_client.connect();
+
+  std::string large_value(100000, 'x');
+  client.set("cpp_redis_codec_large", large_value);
+  client.set("cpp_redis_codec_small", "small");
+  client.hset("cpp_redis_codec_hash", "field", large_value);
+  client.sync_commit();
+
+  std::future<cpp_redis::reply> get_large = client.get("cpp_redis_codec_large");
+  std::future<cpp_redis::reply> mget      = client.mget({"cpp_redis_codec_small", "cpp_redis_codec_large"});
+  std::future<cpp_redis::reply> hgetall   = client.hgetall("cpp_redis_codec_hash");
+  std::future<cpp_redis::reply> raw_large = plain_client.get("cpp_redis_codec_large");
+  std::future<cpp_redis::reply> raw_small = plain_client.get("cpp_redis_codec_small");
+  client.sync_commit();
+  plain_client.sync_commit();
+
+  EXPECT_EQ(get_large.get().as_string(), large_value);
+
+  cpp_redis::reply mget_reply = mget.get();
+  EXPECT_EQ(mget_reply.as_array()[0].as_string(), "small");
+  EXPECT_EQ(mget_reply.as_array()[1].as_string(), large_value);
+
+  cpp_redis::reply hgetall_reply = hgetall.get();
+  EXPECT_EQ(hgetall_reply.as_array()[0].as_string(), "field");
+  EXPECT_EQ(hgetall_reply.as_array()[1].as_string(), large_value);
+
+  //! stored compressed and tagged, small values are stored as is
+  std::string raw = raw_large.get().as_string();
+  EXPECT_EQ(raw.compare(0, codec->get_magic().size(), codec->get_magic()), 0);
+  EXPECT_LT(raw.size(), 1000U);
+  EXPECT_EQ(raw_small.get().as_string(), "small");
+}
+
+TEST(RedisClient, TypedValuesRoundTrip) {
+  cpp_redis::client client;
+
+  client.connect();
+  client.del({"cpp_redis_typed_list"});
+  client.set("cpp_redis_typed_double", 0.1);
+  client.set("cpp_redis_typed_float", 1.1f);
+  client.rpush("cpp_redis_typed_list", std::vector<int>{1, -2, 3});
+  std::future<cpp_redis::reply> incr   = client.incrbyfloat("cpp_redis_typed_double", 1e-10);
+  std::future<cpp_redis::reply> flt    = client.get("cpp_redis_typed_float");
+  std::future<cpp_redis::reply> values = client.lrange("cpp_redis_typed_list", 0, -1);
+  client.sync_commit();
+
+  //! a float increment would have been sent as 0.000000
+  EXPECT_EQ(cpp_redis::from_redis_reply<double>(incr.get()), 0.1000000001);
+  EXPECT_EQ(cpp_redis::from_redis_reply<float>(flt.get()), 1.1f);
+  EXPECT_EQ(cpp_redis::from_redis_reply<std::vector<int>>(values.get()), std::vector<int>({1, -2, 3}));
+}
+
+TEST(RedisClient, TypedNumericArguments) {
+  cpp_redis::client client;
+
+  client.connect();
+  client.del({"cpp_redis_typed_counter", "cpp_redis_typed_hash", "cpp_redis_typed_zset"});
+  //! beyond the range of int: would be truncated by the int overloads
+  std::int64_t big = 5000000000LL;
+  client.incrby("cpp_redis_typed_counter", big);
+  client.decrby("cpp_redis_typed_counter", std::int64_t(1));
+  client.hincrby("cpp_redis_typed_hash", "field", big);
+  client.pexpire("cpp_redis_typed_counter", std::int64_t(30) * 24 * 3600 * 1000);
+  client.zadd("cpp_redis_typed_zset", {}, std::multimap<double, std::string>{{0.1, "member"}});
+  std::future<cpp_redis::reply> counter = client.get("cpp_redis_typed_counter");
+  std::future<cpp_redis::reply> field   = client.hget("cpp_redis_typed_hash", "field");
+  std::future<cpp_redis::reply> score   = client.zscore("cpp_redis_typed_zset", "member");
+  client.sync_commit();
+
+  EXPECT_EQ(cpp_redis::from_redis_reply<std::int64_t>(counter.get()), big - 1);
+  EXPECT_EQ(cpp_redis::from_redis_reply<std::int64_t>(field.get()), big);
+  EXPECT_EQ(cpp_redis::from_redis_reply<double>(score.get()), 0.1);
+}
+
+TEST(RedisClient, NearCacheServesReadsAndInvalidatesOnWrite) {
+  cpp_redis::client client;
+  auto cache = std::make_shared<cpp_redis::near_cache>(1024 * 1024, std::chrono::seconds(60));
+
+  client.set_near_cache(cache);
+  client.connect();
+  client.set("cpp_redis_near_cache", "before");
+  client.get("cpp_redis_near_cache");
+  client.sync_commit();
+
+  //! served without reaching the connection: ready before any commit
+  std::future<cpp_redis::reply> hit = client.get("cpp_redis_near_cache");
+  ASSERT_EQ(hit.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  EXPECT_EQ(hit.get().as_string(), "before");
+
+  std::future<cpp_redis::reply> mget = client.mget({"cpp_redis_near_cache"});
+  ASSERT_EQ(mget.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  EXPECT_EQ(mget.get().as_array()[0].as_string(), "before");
+
+  client.set("cpp_redis_near_cache", "after");
+  std::future<cpp_redis::reply> miss = client.get("cpp_redis_near_cache");
+  client.sync_commit();
+
+  EXPECT_EQ(miss.get().as_string(), "after");
+  EXPECT_EQ(cache->get_stats().hits, 2U);
+}
+
+TEST(RedisClient, ReadCoalescingSendsIdenticalReadsOnce) {
+  cpp_redis::client client;
+
+  client.set_read_coalescing(true);
+
+  for (int i = 0; i < 10; ++i) {
+    client.get("cpp_redis_coalescing", nullptr);
+  }
+  EXPECT_EQ(client.get_pending_commands_count(), 1U);
+
+  client.get("cpp_redis_coalescing_other", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 2U);
+
+  //! reads sent after a write are not attached to the reads sent before it
+  client.set("cpp_redis_coalescing", "value", nullptr);
+  client.get("cpp_redis_coalescing", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 4U);
+}
+
+TEST(RedisClient, ReadCoalescingRepliesToAllReads) {
+  cpp_redis::client client;
+
+  client.set_read_coalescing(true);
+  client.connect();
+  client.set("cpp_redis_coalescing", "value");
+
+  std::vector<std::future<cpp_redis::reply>> gets;
+  for (int i = 0; i < 10; ++i) {
+    gets.push_back(client.get("cpp_redis_coalescing"));
+  }
+  client.sync_commit();
+
+  for (auto& get : gets) {
+    EXPECT_EQ(get.get().as_string(), "value");
+  }
+}
+
+TEST(RedisClient, GetBatchingSendsOneMget) {
+  cpp_redis::client client;
+
+  client.set_get_batching(3);
+
+  client.get("cpp_redis_batch_1", nullptr);
+  client.get("cpp_redis_batch_2", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 0U);
+
+  client.get("cpp_redis_batch_3", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 1U);
+
+  //! other commands send the waiting GETs first
+  client.get("cpp_redis_batch_1", nullptr);
+  client.set("cpp_redis_batch_1", "value", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 3U);
+}
+
+TEST(RedisClient, GetBatchingSplitsReplies) {
+  cpp_redis::client client;
+
+  client.set_get_batching(64, std::chrono::microseconds(500));
+  client.connect();
+  client.set("cpp_redis_batch_1", "value_1");
+  client.set("cpp_redis_batch_2", "value_2");
+  client.sync_commit();
+
+  std::future<cpp_redis::reply> get_1 = client.get("cpp_redis_batch_1");
+  std::future<cpp_redis::reply> get_2 = client.get("cpp_redis_batch_2");
+  std::future<cpp_redis::reply> get_3 = client.get("cpp_redis_batch_missing");
+  client.commit();
+
+  EXPECT_EQ(get_1.get().as_string(), "value_1");
+  EXPECT_EQ(get_2.get().as_string(), "value_2");
+  EXPECT_TRUE(get_3.get().is_null());
+}
+
+TEST(RedisClient, WriteCombiningSendsOneCommandPerKey) {
+  cpp_redis::client client;
+
+  client.set_write_combining(3);
+
+  client.sadd("cpp_redis_combined_1", {"a"}, nullptr);
+  client.rpush("cpp_redis_combined_2", {"a"}, nullptr);
+  client.sadd("cpp_redis_combined_1", {"b"}, nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 0U);
+
+  client.sadd("cpp_redis_combined_1", {"c"}, nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 1U);
+
+  //! other commands send the waiting writes first
+  client.get("cpp_redis_combined_1", nullptr);
+  EXPECT_EQ(client.get_pending_commands_count(), 3U);
+}
+
+TEST(RedisClient, WriteCombiningSplitsReplies) {
+  cpp_redis::client client;
+
+  client.set_write_combining(64, std::chrono::microseconds(500));
+  client.connect();
+  client.del({"cpp_redis_combined_set", "cpp_redis_combined_list"});
+  client.sadd("cpp_redis_combined_set", {"a"});
+  client.sync_commit();
+
+  std::future<cpp_redis::reply> sadd_1  = client.sadd("cpp_redis_combined_set", {"b", "c"});
+  std::future<cpp_redis::reply> rpush_1 = client.rpush("cpp_redis_combined_list", {"a"});
+  std::future<cpp_redis::reply> sadd_2  = client.sadd("cpp_redis_combined_set", {"a"});
+  std::future<cpp_redis::reply> rpush_2 = client.rpush("cpp_redis_combined_list", {"b", "c"});
+  client.commit();
+
+  EXPECT_EQ(sadd_1.get().as_integer(), 2);
+  EXPECT_EQ(sadd_2.get().as_integer(), 0);
+  EXPECT_EQ(rpush_1.get().as_integer(), 1);
+  EXPECT_EQ(rpush_2.get().as_integer(), 3);
+}
+
+TEST(RedisClient, UnacknowledgedWritesExpectNoReply) {
+  cpp_redis::client client;
+
+  client.send_unacknowledged({"INCR", "cpp_redis_unacknowledged"});
+  EXPECT_EQ(client.get_pending_commands_count(), 0U);
+
+  //! only CLIENT REPLY ON replies
+  client.send_all_unacknowledged({{"INCR", "cpp_redis_unacknowledged"}, {"PUBLISH", "cpp_redis_channel", "message"}});
+  EXPECT_EQ(client.get_pending_commands_count(), 1U);
+
+  EXPECT_THROW(client.send_unacknowledged({"GET", "cpp_redis_unacknowledged"}), cpp_redis::redis_error);
+  EXPECT_THROW(client.send_unacknowledged({"MULTI"}), cpp_redis::redis_error);
+}
+
+TEST(RedisClient, UnacknowledgedWritesKeepOrdering) {
+  cpp_redis::client client;
+
+  client.connect();
+  client.del({"cpp_redis_unacknowledged"});
+  client.sync_commit();
+
+  client.send_unacknowledged({"INCR", "cpp_redis_unacknowledged"});
+  std::future<cpp_redis::reply> get_1 = client.get("cpp_redis_unacknowledged");
+  client.send_all_unacknowledged({{"INCR", "cpp_redis_unacknowledged"}, {"INCR", "cpp_redis_unacknowledged"}});
+  std::future<cpp_redis::reply> get_2 = client.get("cpp_redis_unacknowledged");
+  client.sync_commit();
+
+  EXPECT_EQ(get_1.get().as_string(), "1");
+  EXPECT_EQ(get_2.get().as_string(), "3");
+  EXPECT_EQ(client.get_pending_commands_count(), 0U);
+}
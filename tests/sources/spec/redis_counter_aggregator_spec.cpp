@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <cpp_redis/core/counter_aggregator.hpp>
+#include <cpp_redis/misc/error.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(RedisCounterAggregator, NoConnection) {
+  EXPECT_THROW(cpp_redis::counter_aggregator aggregator(nullptr), cpp_redis::redis_error);
+}
+
+TEST(RedisCounterAggregator, MergesIncrements) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  cpp_redis::counter_aggregator aggregator(connection, std::chrono::hours(1));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (int n = 0; n < 1000; ++n) {
+        aggregator.incr("cpp_redis_counter");
+        aggregator.hincrby("cpp_redis_counters", "field", 2);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = aggregator.get_stats();
+  EXPECT_EQ(stats.increments, 8000U);
+  EXPECT_LE(stats.pending_keys, 8U);
+
+  //! not connected: the increments are dropped, one command per counter
+  aggregator.flush();
+
+  stats = aggregator.get_stats();
+  EXPECT_EQ(stats.pending_keys, 0U);
+  EXPECT_EQ(stats.flushed_commands, 2U);
+}
+
+TEST(RedisCounterAggregator, FlushesPeriodically) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  connection->connect();
+  connection->del({"cpp_redis_counter"});
+  connection->sync_commit();
+
+  cpp_redis::counter_aggregator aggregator(connection, std::chrono::milliseconds(10));
+
+  for (int n = 0; n < 100; ++n) {
+    aggregator.incrby("cpp_redis_counter", 3);
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  auto get = connection->get("cpp_redis_counter");
+  connection->sync_commit();
+
+  EXPECT_EQ(get.get().as_string(), "300");
+  EXPECT_EQ(aggregator.get_stats().flushed_commands, 1U);
+}
+
+TEST(RedisCounterAggregator, FlushesOnSizeLimit) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  connection->connect();
+  connection->del({"cpp_redis_counter_1", "cpp_redis_counter_2"});
+  connection->sync_commit();
+
+  cpp_redis::counter_aggregator aggregator(connection, std::chrono::hours(1), 2);
+
+  aggregator.incr("cpp_redis_counter_1");
+  aggregator.incr("cpp_redis_counter_2");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  EXPECT_EQ(aggregator.get_stats().pending_keys, 0U);
+  EXPECT_EQ(aggregator.get_stats().flushed_commands, 2U);
+}
@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <cpp_redis/core/logical_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(RedisLogicalClient, NoConnection) {
+  EXPECT_THROW(cpp_redis::logical_client handle(nullptr), cpp_redis::redis_error);
+}
+
+TEST(RedisLogicalClient, RejectsConnectionStateCommands) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  cpp_redis::logical_client handle(connection);
+
+  EXPECT_THROW(handle.send({"SELECT", "1"}, nullptr), cpp_redis::redis_error);
+  EXPECT_THROW(handle.send({"MULTI"}, nullptr), cpp_redis::redis_error);
+  EXPECT_EQ(handle.get_pending_commands_count(), 0U);
+}
+
+TEST(RedisLogicalClient, HandlesShareConnection) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  connection->connect();
+
+  cpp_redis::logical_client handle1(connection);
+  cpp_redis::logical_client handle2(connection);
+
+  handle1.send({"SET", "cpp_redis_logical_client", "value"}, nullptr);
+  handle1.sync_commit();
+
+  auto get = handle2.send({"GET", "cpp_redis_logical_client"});
+  handle2.sync_commit();
+
+  EXPECT_EQ(get.get().as_string(), "value");
+}
+
+TEST(RedisLogicalClient, CallbacksInOrderPerHandle) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  connection->connect();
+
+  std::vector<std::unique_ptr<cpp_redis::logical_client>> handles;
+  std::vector<std::vector<int>> orders(10);
+  auto executor = std::make_shared<cpp_redis::thread_pool_executor>(4);
+
+  for (int i = 0; i < 10; ++i) {
+    handles.push_back(std::unique_ptr<cpp_redis::logical_client>(new cpp_redis::logical_client(connection)));
+    handles.back()->set_executor(executor);
+  }
+
+  for (int n = 0; n < 100; ++n) {
+    for (int i = 0; i < 10; ++i) {
+      std::vector<int>& order = orders[i];
+      handles[i]->send({"PING"}, [&order, n](cpp_redis::reply&) { order.push_back(n); });
+    }
+  }
+
+  for (auto& handle : handles) {
+    handle->sync_commit();
+  }
+
+  for (const auto& order : orders) {
+    ASSERT_EQ(order.size(), 100U);
+    for (int n = 0; n < 100; ++n)
+      EXPECT_EQ(order[n], n);
+  }
+}
+
+TEST(RedisLogicalClient, ThrowingCallbackDoesNotBlockSyncCommit) {
+  auto connection = std::make_shared<cpp_redis::client>();
+  connection->connect();
+
+  for (bool use_executor : {false, true}) {
+    cpp_redis::logical_client handle(connection);
+
+    if (use_executor) {
+      handle.set_executor(std::make_shared<cpp_redis::thread_pool_executor>(2));
+    }
+
+    bool next_callback_called = false;
+    handle.send({"PING"}, [](cpp_redis::reply&) { throw std::runtime_error("callback failure"); });
+    handle.send({"PING"}, [&](cpp_redis::reply&) { next_callback_called = true; });
+    handle.sync_commit();
+
+    EXPECT_TRUE(next_callback_called);
+    EXPECT_EQ(handle.get_pending_commands_count(), 0U);
+  }
+}
@@ -0,0 +1,73 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+
+#include <cpp_redis/core/priority_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+
+#include <gtest/gtest.h>
+
+TEST(RedisPriorityClient, ValidConnection) {
+  cpp_redis::priority_client client;
+
+  EXPECT_FALSE(client.is_connected());
+  EXPECT_NO_THROW(client.connect());
+  EXPECT_TRUE(client.is_connected());
+}
+
+TEST(RedisPriorityClient, CommitNotConnected) {
+  cpp_redis::priority_client client;
+
+  client.send({"PING"}, nullptr, cpp_redis::priority_client::priority::bulk);
+  EXPECT_THROW(client.commit(), cpp_redis::redis_error);
+}
+
+TEST(RedisPriorityClient, SendAllPriorities) {
+  cpp_redis::priority_client client;
+  std::atomic<int> nb_replies(0);
+
+  client.connect();
+  for (int i = 0; i < 100; ++i) {
+    client.send({"PING"}, [&](cpp_redis::reply&) { ++nb_replies; }, cpp_redis::priority_client::priority::interactive);
+    client.send({"PING"}, [&](cpp_redis::reply&) { ++nb_replies; });
+    client.send({"PING"}, [&](cpp_redis::reply&) { ++nb_replies; }, cpp_redis::priority_client::priority::bulk);
+  }
+  client.sync_commit();
+
+  EXPECT_EQ(nb_replies, 300);
+}
+
+TEST(RedisPriorityClient, SyncCommitLane) {
+  cpp_redis::priority_client client;
+
+  client.connect();
+  client.send({"DEBUG", "SLEEP", "0.5"}, nullptr, cpp_redis::priority_client::priority::bulk);
+  client.commit();
+
+  //! the interactive lane does not wait for the bulk one
+  auto get = client.send({"GET", "HELLO"}, cpp_redis::priority_client::priority::interactive);
+  client.sync_commit(cpp_redis::priority_client::priority::interactive);
+  EXPECT_EQ(get.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+
+  client.sync_commit();
+}
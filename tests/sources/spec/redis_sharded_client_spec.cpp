@@ -0,0 +1,174 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cpp_redis/core/sharded_client.hpp>
+#include <cpp_redis/misc/error.hpp>
+
+#include <gtest/gtest.h>
+
+//!
+//! both nodes are the same local server reached through two addresses: keys are spread over two connections while staying readable from either
+//!
+static void
+add_two_nodes(cpp_redis::sharded_client& client) {
+  client.add_node("127.0.0.1", 6379);
+  client.add_node("localhost", 6379);
+}
+
+static std::vector<std::string>
+make_keys(const std::string& prefix, std::size_t nb_keys) {
+  std::vector<std::string> keys;
+
+  for (std::size_t i = 0; i < nb_keys; ++i) {
+    keys.push_back(prefix + std::to_string(i));
+  }
+
+  return keys;
+}
+
+TEST(RedisShardedClient, NoNode) {
+  cpp_redis::sharded_client client;
+
+  EXPECT_FALSE(client.is_connected());
+  EXPECT_THROW(client.send({"GET", "key"}, nullptr), cpp_redis::redis_error);
+}
+
+TEST(RedisShardedClient, KeysAreSpreadOverNodes) {
+  cpp_redis::sharded_client client;
+  add_two_nodes(client);
+
+  EXPECT_TRUE(client.is_connected());
+  EXPECT_EQ(client.get_nodes().size(), 2U);
+
+  std::size_t nb_keys_on_first_node = 0;
+  for (const auto& key : make_keys("cpp_redis_sharded_", 100)) {
+    nb_keys_on_first_node += client.get_node_for_key(key) == "127.0.0.1:6379";
+  }
+
+  EXPECT_GT(nb_keys_on_first_node, 0U);
+  EXPECT_LT(nb_keys_on_first_node, 100U);
+}
+
+TEST(RedisShardedClient, MultiKeyCommandsAcrossNodes) {
+  cpp_redis::sharded_client client;
+  add_two_nodes(client);
+
+  std::vector<std::string> keys = make_keys("cpp_redis_sharded_multi_", 20);
+  std::vector<std::pair<std::string, std::string>> key_vals;
+
+  for (const auto& key : keys) {
+    key_vals.push_back({key, "value_" + key});
+  }
+
+  client.del(keys);
+  std::future<cpp_redis::reply> mset   = client.mset(key_vals);
+  std::future<cpp_redis::reply> mget   = client.mget(keys);
+  std::future<cpp_redis::reply> exists = client.exists(keys);
+  client.sync_commit();
+
+  cpp_redis::reply mset_reply = mset.get();
+  ASSERT_TRUE(mset_reply.is_string());
+  EXPECT_EQ(mset_reply.as_string(), "OK");
+
+  //! values come back in the order of the keys, whatever the node they were read from
+  cpp_redis::reply mget_reply = mget.get();
+  ASSERT_TRUE(mget_reply.is_array());
+  ASSERT_EQ(mget_reply.as_array().size(), keys.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(mget_reply.as_array()[i].as_string(), "value_" + keys[i]);
+  }
+
+  EXPECT_EQ(exists.get().as_integer(), 20);
+
+  std::future<cpp_redis::reply> del = client.del(keys);
+  client.sync_commit();
+  EXPECT_EQ(del.get().as_integer(), 20);
+}
+
+TEST(RedisShardedClient, SyncCommitWaitsForAllParts) {
+  cpp_redis::sharded_client client;
+  add_two_nodes(client);
+
+  std::vector<std::string> keys = make_keys("cpp_redis_sharded_parts_", 10);
+  std::atomic<int> nb_replies(0);
+
+  for (int i = 0; i < 50; ++i) {
+    client.mget(keys, [&](cpp_redis::reply& reply) {
+      EXPECT_TRUE(reply.is_array());
+      ++nb_replies;
+    });
+  }
+  client.sync_commit();
+
+  //! one callback per command, once all its parts replied
+  EXPECT_EQ(nb_replies, 50);
+}
+
+TEST(RedisShardedClient, ThrowingCallbackDoesNotBlockSyncCommit) {
+  cpp_redis::sharded_client client;
+  add_two_nodes(client);
+
+  std::vector<std::string> keys = make_keys("cpp_redis_sharded_throw_", 10);
+  bool next_callback_called     = false;
+
+  client.send({"GET", keys[0]}, [](cpp_redis::reply&) { throw std::runtime_error("callback failure"); });
+  client.mget(keys, [](cpp_redis::reply&) { throw std::runtime_error("callback failure"); });
+  client.mget(keys, [&](cpp_redis::reply&) { next_callback_called = true; });
+  client.sync_commit();
+
+  EXPECT_TRUE(next_callback_called);
+}
+
+TEST(RedisShardedClient, RemoveNodeDrainsPendingCommands) {
+  cpp_redis::sharded_client client;
+  add_two_nodes(client);
+
+  std::string key;
+  for (const auto& candidate : make_keys("cpp_redis_sharded_remove_", 100)) {
+    if (client.get_node_for_key(candidate) == "localhost:6379") {
+      key = candidate;
+      break;
+    }
+  }
+  ASSERT_FALSE(key.empty());
+
+  //! queued but not committed when the node is removed
+  std::atomic<int> nb_replies(0);
+  client.send({"SET", key, "value"}, [&](cpp_redis::reply& reply) {
+    EXPECT_TRUE(reply.is_string());
+    ++nb_replies;
+  });
+
+  client.remove_node("localhost", 6379);
+  EXPECT_EQ(nb_replies, 1);
+  EXPECT_EQ(client.get_nodes(), std::vector<std::string>({"127.0.0.1:6379"}));
+  EXPECT_EQ(client.get_node_for_key(key), "127.0.0.1:6379");
+
+  std::future<cpp_redis::reply> get = client.send({"GET", key});
+  client.sync_commit();
+  EXPECT_EQ(get.get().as_string(), "value");
+}
@@ -591,3 +591,76 @@ TEST(RedisSubscriber, PUnsubscribe) {
   EXPECT_FALSE(callback_1_run);
   EXPECT_TRUE(callback_2_run);
 }
+
+TEST(RedisSubscriber, InvalidationsRedirected) {
+  cpp_redis::subscriber sub;
+  cpp_redis::client client;
+  std::condition_variable cv;
+
+  sub.connect();
+  client.connect();
+
+  std::atomic<int64_t> id        = ATOMIC_VAR_INIT(-1);
+  std::atomic<bool> callback_run = ATOMIC_VAR_INIT(false);
+  sub.client_id([&](int64_t client_id) { id = client_id; });
+  sub.subscribe_invalidations(
+    [&](const std::vector<std::string>& keys) {
+      EXPECT_EQ(keys.size(), 1U);
+      EXPECT_TRUE(keys.front() == "/invalidated");
+      callback_run = true;
+      cv.notify_all();
+    },
+    [&](int64_t) {
+      client.send({"CLIENT", "TRACKING", "ON", "REDIRECT", std::to_string(id)}, nullptr);
+      client.get("/invalidated", nullptr);
+      client.set("/invalidated", "hello");
+      client.commit();
+    });
+
+  sub.commit();
+
+  std::mutex mutex;
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait_for(lock, std::chrono::seconds(10), [&]() -> bool { return callback_run; });
+
+  EXPECT_NE(id, -1);
+  EXPECT_TRUE(callback_run);
+}
+
+TEST(RedisSubscriber, KeyEventsFillKeyFilter) {
+  cpp_redis::subscriber sub;
+  cpp_redis::client client;
+  auto filter = std::make_shared<cpp_redis::key_filter>(4096);
+  std::condition_variable cv;
+
+  EXPECT_THROW(sub.subscribe_key_events(nullptr), cpp_redis::redis_error);
+
+  sub.connect();
+  client.connect();
+  client.config_set("notify-keyspace-events", "EA");
+  client.del({"/key_event"});
+  client.sync_commit();
+
+  filter->set_ready(true);
+
+  std::atomic<bool> subscribed = ATOMIC_VAR_INIT(false);
+  sub.subscribe_key_events(filter, 0, [&](int64_t) {
+    subscribed = true;
+    cv.notify_all();
+  });
+  sub.commit();
+
+  std::mutex mutex;
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait_for(lock, std::chrono::seconds(10), [&]() -> bool { return subscribed; });
+
+  //! keys created by another client are added once their event is received
+  client.set("/key_event", "value");
+  client.sync_commit();
+
+  for (int i = 0; i < 100 && !filter->may_exist("/key_event"); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  EXPECT_TRUE(filter->may_exist("/key_event"));
+}
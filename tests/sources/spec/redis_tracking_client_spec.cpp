@@ -0,0 +1,135 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <cpp_redis/core/client.hpp>
+#include <cpp_redis/core/tracking_client.hpp>
+
+#include <gtest/gtest.h>
+
+//!
+//! invalidations are subscribed asynchronously: read the key until it is served from the cache
+//!
+static bool
+wait_for_cache_hit(cpp_redis::tracking_client& client, const std::string& key) {
+  for (int i = 0; i < 100; ++i) {
+    client.get(key, nullptr);
+    client.sync_commit();
+
+    if (client.get_stats().hits) {
+      return true;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  return false;
+}
+
+TEST(RedisTrackingClient, NotConnectedBypassesCache) {
+  cpp_redis::tracking_client client;
+
+  client.get("cpp_redis_tracking", nullptr);
+  client.hgetall("cpp_redis_tracking", nullptr);
+
+  auto stats = client.get_stats();
+  EXPECT_EQ(stats.hits, 0U);
+  EXPECT_EQ(stats.misses, 0U);
+  EXPECT_EQ(stats.keys, 0U);
+}
+
+TEST(RedisTrackingClient, ServesRepeatedReadsFromCache) {
+  cpp_redis::tracking_client client;
+  client.connect();
+
+  client.send({"SET", "cpp_redis_tracking", "value"}, nullptr);
+  client.sync_commit();
+
+  ASSERT_TRUE(wait_for_cache_hit(client, "cpp_redis_tracking"));
+
+  auto get = client.get("cpp_redis_tracking");
+  EXPECT_EQ(get.get().as_string(), "value");
+  EXPECT_EQ(client.get_stats().keys, 1U);
+}
+
+TEST(RedisTrackingClient, LocalWriteEvicts) {
+  cpp_redis::tracking_client client;
+  client.connect();
+
+  client.send({"SET", "cpp_redis_tracking", "old"}, nullptr);
+  client.sync_commit();
+  ASSERT_TRUE(wait_for_cache_hit(client, "cpp_redis_tracking"));
+
+  client.send({"SET", "cpp_redis_tracking", "new"}, nullptr);
+  auto get = client.get("cpp_redis_tracking");
+  client.sync_commit();
+
+  EXPECT_EQ(get.get().as_string(), "new");
+}
+
+TEST(RedisTrackingClient, RemoteWriteInvalidates) {
+  cpp_redis::tracking_client client;
+  client.connect();
+
+  cpp_redis::client writer;
+  writer.connect();
+
+  client.send({"SET", "cpp_redis_tracking", "old"}, nullptr);
+  client.sync_commit();
+  ASSERT_TRUE(wait_for_cache_hit(client, "cpp_redis_tracking"));
+
+  writer.set("cpp_redis_tracking", "new");
+  writer.sync_commit();
+
+  std::string value;
+  for (int i = 0; i < 100 && value != "new"; ++i) {
+    auto get = client.get("cpp_redis_tracking");
+    client.sync_commit();
+    value = get.get().as_string();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  EXPECT_EQ(value, "new");
+  EXPECT_GE(client.get_stats().invalidations, 1U);
+}
+
+TEST(RedisTrackingClient, MemoryBound) {
+  cpp_redis::tracking_client client(4096);
+  client.connect();
+
+  client.send({"SET", "cpp_redis_tracking", "value"}, nullptr);
+  client.sync_commit();
+  ASSERT_TRUE(wait_for_cache_hit(client, "cpp_redis_tracking"));
+
+  for (int i = 0; i < 100; ++i) {
+    client.get("cpp_redis_tracking_" + std::to_string(i), nullptr);
+  }
+  client.sync_commit();
+
+  auto stats = client.get_stats();
+  EXPECT_LE(stats.bytes, 4096U);
+  EXPECT_GT(stats.evictions, 0U);
+}